@@ -32,7 +32,6 @@
 template <typename PrefixType = uint32_t>
 class AS : public BaseAS<Announcement<PrefixType>, PrefixType> {
 public:
-    AS(uint32_t asn, uint32_t max_block_prefix_id, bool store_depref_results, std::map<std::pair<Prefix<PrefixType>, uint32_t>, std::set<uint32_t>*> *inverse_results);
     AS(uint32_t asn, uint32_t max_block_prefix_id, bool store_depref_results);
     AS(uint32_t asn, uint32_t max_block_prefix_id = 20);
     AS();
@@ -50,6 +50,23 @@
 #include "Announcements/ROVppAnnouncement.h"
 #include "Announcements/ROVAnnouncement.h"
 
+/** A row of one of the graph's compressed sparse row neighbor tables: the indices of
+ *  an AS's neighbors of one relationship, sorted.
+ */
+struct IndexRange {
+    const uint32_t *first;
+    const uint32_t *last;
+
+    IndexRange() : first(NULL), last(NULL) { }
+    IndexRange(const uint32_t *first, const uint32_t *last) : first(first), last(last) { }
+
+    const uint32_t* begin() const { return first; }
+    const uint32_t* end() const { return last; }
+    size_t size() const { return last - first; }
+    bool empty() const { return first == last; }
+    bool contains(uint32_t index) const { return std::binary_search(first, last, index); }
+};
+
 template <class AnnouncementType, typename PrefixType = uint32_t>
 class BaseAS {
 
@@ -65,13 +82,21 @@ public:
     // Maps of all announcements stored
     PrefixAnnouncementMap<AnnouncementType, PrefixType> *all_anns;
     PrefixAnnouncementMap<AnnouncementType, PrefixType> *depref_anns;
+    // Announcements of the last block, read by the threads saving results. The same maps as 
+    // all_anns and depref_anns unless a second generation is added with add_generation
+    PrefixAnnouncementMap<AnnouncementType, PrefixType> *saved_anns;
+    PrefixAnnouncementMap<AnnouncementType, PrefixType> *saved_depref_anns;
 
-    // Stores AS Relationships
+    // Stores AS Relationships, used while the graph is built
     std::set<uint32_t> *providers; 
     std::set<uint32_t> *peers; 
     std::set<uint32_t> *customers; 
-    // Pointer to inverted results map for efficiency
-    std::map<std::pair<Prefix<PrefixType>, uint32_t>,std::set<uint32_t>*> *inverse_results; 
+    // Position in the graph's ases_by_index, assigned by BaseGraph::index_ases
+    uint32_t graph_index;
+    // Neighbors as positions in the graph's ases_by_index, frozen by BaseGraph::index_ases
+    IndexRange provider_indices;
+    IndexRange peer_indices;
+    IndexRange customer_indices;
     // If this AS represents multiple ASes, it's "members" are listed here (Supernodes)
     std::vector<uint32_t> *member_ases;
     // Assigned and used in Tarjan's algorithm
@@ -80,7 +105,7 @@ public:
     bool onStack;
     
     // Constructor. Must be in header file.... We like C++ class templates. We like C++ class templates....
-    BaseAS(uint32_t asn, uint32_t max_block_prefix_id, bool store_depref_results, std::map<std::pair<Prefix<PrefixType>, uint32_t>, std::set<uint32_t>*> *inverse_results) {
+    BaseAS(uint32_t asn, uint32_t max_block_prefix_id, bool store_depref_results) {
 
         // Set ASN
         this->asn = asn;
@@ -91,8 +116,8 @@ public:
         providers = new std::set<uint32_t>();
         peers = new std::set<uint32_t>();
         customers = new std::set<uint32_t>();
+        graph_index = 0;
 
-        this->inverse_results = inverse_results;    // Inverted results map
         member_ases = new std::vector<uint32_t>();    // Supernode members
         incoming_announcements = new std::vector<AnnouncementType>();
 
@@ -102,15 +127,16 @@ public:
             depref_anns = new PrefixAnnouncementMap<AnnouncementType, PrefixType>(max_block_prefix_id);
         else
             depref_anns = NULL;
+        saved_anns = all_anns;
+        saved_depref_anns = depref_anns;
 
         // Tarjan variables
         index = -1;
         onStack = false;
     }
 
-    BaseAS(uint32_t asn, uint32_t max_block_prefix_id, bool store_depref_results) : BaseAS(asn, max_block_prefix_id, store_depref_results, NULL) { }
-    BaseAS(uint32_t asn, uint32_t max_block_prefix_id) : BaseAS(asn, max_block_prefix_id, false, NULL) { }
-    BaseAS() : BaseAS(0, 20, false, NULL) { }
+    BaseAS(uint32_t asn, uint32_t max_block_prefix_id) : BaseAS(asn, max_block_prefix_id, false) { }
+    BaseAS() : BaseAS(0, 20, false) { }
 
     virtual ~BaseAS();
     
@@ -138,15 +164,19 @@ public:
      */
     virtual void remove_neighbor(uint32_t asn, int relationship);
 
-    //****************** Announcement Handling ******************//
-
-    /** Swap a pair of prefix/origins for this AS in the inverse results.
+    /** Neighbors of one relationship as positions in the graph's ases_by_index.
      *
-     * @param old The prefix/origin to be inserted
-     * @param current The prefix/origin to be removed
+     * @param relationship AS_REL_PROVIDER, AS_REL_PEER, or AS_REL_CUSTOMER.
      */
-    virtual void swap_inverse_result(std::pair<Prefix<PrefixType>, uint32_t> old, 
-                                        std::pair<Prefix<PrefixType>, uint32_t> current);
+    IndexRange neighbor_indices(int relationship) {
+        if (relationship == AS_REL_PROVIDER)
+            return provider_indices;
+        if (relationship == AS_REL_PEER)
+            return peer_indices;
+        return customer_indices;
+    }
+
+    //****************** Announcement Handling ******************//
 
     /** Push the incoming propagated announcements to the incoming_announcements vector.
      *
@@ -173,6 +203,18 @@ public:
     */
     virtual void clear_announcements();
 
+    /** Give this AS a second generation of announcement maps, so the results of one block can be 
+     *  saved while the next is propagated. The new maps are the size of the current ones.
+     *
+     * @param prefixes Prefix table shared by the second generation of every AS
+     */
+    virtual void add_generation(std::vector<Prefix<PrefixType>> *prefixes);
+
+    /** Make the announcements of the block just propagated the saved generation, and clear the 
+     *  other generation for the next block. Without a second generation this only clears them.
+     */
+    virtual void swap_generations();
+
     /** Check if a monitor announcement is already recv'd by this AS. 
      *
      * @param ann Announcement to check for. 
@@ -0,0 +1,71 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#ifndef BENCHMARKS_H
+#define BENCHMARKS_H
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+
+/** Time a function, taking the best of several runs.
+ *
+ * @param runs Number of times to run the function
+ * @param f Function to time
+ * @return Seconds taken by the fastest run
+ */
+template <typename Function>
+double time_best_of(int runs, Function f) {
+    double best = -1;
+    for (int i = 0; i < runs; i++) {
+        auto start = std::chrono::high_resolution_clock::now();
+        f();
+        auto finish = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> elapsed = finish - start;
+        if (best < 0 || elapsed.count() < best) {
+            best = elapsed.count();
+        }
+    }
+    return best;
+}
+
+//PrefixAnnouncementMap
+void benchmark_prefix_announcement_map();
+
+//Rank order
+void benchmark_rank_order();
+
+//Graph preprocessing
+void benchmark_graph_preprocessing();
+
+//Path decoding
+void benchmark_path_decoding();
+
+//Result sinks
+void benchmark_result_sinks();
+
+//Result formatter
+void benchmark_result_formatter();
+
+#endif
@@ -34,6 +34,9 @@
 
 #define DEFAULT_MAX_THREADS 0
 #define DEFAULT_SELECT_BLOCK_ID false
+#define DEFAULT_STREAM_RESULTS false
+#define DEFAULT_RESULTS_FORMAT "csv"
+#define DEFAULT_COMPRESS_RESULTS false
 
 #include <vector>
 #include <bits/stdc++.h>
@@ -52,6 +55,10 @@
 #include "Graphs/ASGraph.h"
 #include "Announcements/Announcement.h"
 #include "Prefix.h"
+#include "PathDecoder.h"
+#include "WriterPool.h"
+#include "InputSources/InputSource.h"
+#include "ResultSinks/ResultSink.h"
 #include "SQLQueriers/SQLQuerier.h"
 #include "TableNames.h"
 
@@ -123,6 +130,8 @@
 template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
 class BaseExtrapolator {
 public:
+    typedef decltype(std::declval<AnnouncementType>().prefix.addr) ResultPrefixType;
+
     GraphType *graph;
     SQLQuerierType *querier;
 
@@ -135,6 +144,19 @@ public:
     int max_workers;           // Max number of worker threads that can run concurrently
     sem_t csvs_written;        // Semaphore to delay saving to the database
     bool origin_only;          // Only seed at the origin AS
+    std::string results_dir;   // Directory results csvs are kept in, empty to copy them to the database
+    std::string results_format; // Format of the files in results_dir, csv or binary
+    bool compress_results;     // Gzip the files in results_dir
+    ResultSink<ResultPrefixType> *result_sink; // Where save_results puts the rows, NULL to copy csvs from /dev/shm
+    WriterPool *writer_pool;   // Threads saving results, started by the first save_results
+    std::vector<SQLQuerierType*> writer_queriers; // Connection of each thread saving results, see open_writer_connections
+
+    // Shares of the block being saved, see partition_results. Thread i saves the 
+    // entries from bounds[i] up to bounds[i + 1] of each output.
+    std::vector<ASType*> save_ases;
+    std::vector<size_t> save_as_bounds;
+    std::vector<size_t> save_inverse_bounds;     // Into the pairs of graph->saved_inverse_results
+    std::vector<size_t> save_full_path_bounds;   // Into full_path_asns
 
     BaseExtrapolator(bool random_tiebraking,
                         bool store_results, 
@@ -174,6 +196,10 @@ public:
         // That way they can give the variable a proper type
         graph = NULL;
         querier = NULL;
+        result_sink = NULL;
+        writer_pool = NULL;
+        results_format = DEFAULT_RESULTS_FORMAT;
+        compress_results = DEFAULT_COMPRESS_RESULTS;
     }
 
     /**
@@ -227,25 +253,54 @@ public:
                                         bool to_customers = false) = 0;
 
     /** Save the results of a single iteration to a in-memory
+     *
+     * The inverse results are first computed from the saved RIBs by writer_pool, 
+     * then the results are split by partition_results and saved by writer_pool.
      *
      * @param iteration The current iteration of the propagation
      */
     virtual void save_results(int iteration);
 
+    /** Give each thread saving results its own database connection, kept for the whole run.
+     *
+     * Called by init, or by the first save_results. Does nothing if the results are kept in 
+     * results_dir, or if the connections are already open.
+     */
+    virtual void open_writer_connections();
+
+    /** Split the saved RIBs into a contiguous share for each thread saving results.
+     *
+     * ASes are weighted by the announcements they hold and inverse results by the ASes 
+     * in them, so each thread writes about as many rows. 
+     *
+     * @param num_threads Number of shares
+     */
+    virtual void partition_results(int num_threads);
+
     /** Thread function to save results
      *
      * @param iteration The current iteration of the propagation
+     * @param thread_num Share of the results to save, see partition_results
+     * @param num_threads Number of threads saving results
      */
     virtual void save_results_thread(int iteration, int thread_num, int num_threads);
 
+    /** Thread function to save results to result_sink rather than through CSVs
+     *
+     * Used by save_results_thread when result_sink is set. Each thread writes its own shards.
+     */
+    virtual void sink_results_thread(int iteration, int thread_num, int num_threads);
+
     /** Save results only at a particular AS
      *
      * These results will also contain the full AS_PATH computed by tracing back
      * the announcements to their origin. These results are not inverted.
      *
      * @param asn AS to save results for
+     * @param writer_querier Connection of the thread saving results, NULL to use querier
+     * @param iteration Block the results are from, names the file they are written to
      */
-    virtual void save_results_at_asn(uint32_t asn);
+    virtual void save_results_at_asn(uint32_t asn, SQLQuerierType *writer_querier = NULL, int iteration = 0);
 
     /** Return the AS_PATH of an Announcement.
      *
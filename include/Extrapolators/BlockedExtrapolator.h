@@ -3,8 +3,71 @@
 
 #define DEFAULT_ITERATION_SIZE 50000
 #define DEFAULT_MH_MODE 1
+#define DEFAULT_PARALLEL_PROPAGATION false
+#define DEFAULT_PULL_PROPAGATION false
+#define DEFAULT_CONCURRENT_BLOCKS 1
+#define DEFAULT_BFS_RANK_ORDER false
+#define DEFAULT_TOPOLOGY_SNAPSHOT_DIR ""
+#define DEFAULT_PREFETCH_BLOCKS 0
+#define DEFAULT_BLOCK_PLAN_DIR ""
+#define DEFAULT_DOUBLE_BUFFER_RIBS false
+
+#define BLOCK_PLAN_MAGIC "BGPPLAN"
+#define BLOCK_PLAN_VERSION 3
 
 #include "Extrapolators/BaseExtrapolator.h"
+#include "InputSources/AnnouncementStore.h"
+
+/** A block of announcements, selected either by prefix/subnet or by block_id.
+ */
+template <typename PrefixType = uint32_t>
+struct ExtrapolationBlock {
+    Prefix<PrefixType> *prefix; // Prefix or subnet of the block, NULL if selected by block_id
+    bool subnet;                // Select all announcements within prefix rather than for it
+    uint32_t block_id;          // Used if prefix is NULL
+    uint32_t size;              // Number of announcements in the block
+};
+
+/** The announcements of a block decoded from their rows, ready to be seeded without the database.
+ */
+template <typename PrefixType = uint32_t>
+struct DecodedBlock {
+    struct Row {
+        Prefix<PrefixType> prefix;
+        uint32_t origin;
+        int64_t timestamp;
+        uint32_t path_start;    // Position of the AS path in asns
+        uint32_t path_length;
+    };
+
+    ExtrapolationBlock<PrefixType> block;
+    std::vector<Row> anns;
+    std::vector<uint32_t> asns;     // AS paths of all announcements, back to back
+    std::vector<uint32_t> indices;  // Graph index of each ASN in asns
+    size_t rows;                    // Rows selected, including announcements dropped for loops
+
+    DecodedBlock() : rows(0) { }
+
+    void clear() {
+        anns.clear();
+        asns.clear();
+        indices.clear();
+        rows = 0;
+    }
+};
+
+/** Header of a cached block plan file, followed by the address, netmask and number of 
+ *  announcements of each prefix block and then of each subnet block.
+ */
+struct BlockPlanHeader {
+    char magic[8];
+    uint32_t version;
+    char key[68];               // Identifies the announcements and settings the plan was made for
+    uint32_t prefix_bytes;      // sizeof the PrefixType of the addresses
+    uint32_t num_prefix_blocks;
+    uint32_t num_subnet_blocks;
+    uint32_t max_block_prefixes;    // Most distinct prefixes in any one block of the plan
+};
 
 template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType = uint32_t>
 class BlockedExtrapolator : public BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>  {
@@ -13,18 +76,51 @@ protected:
     uint32_t mh_mode;
     bool select_block_id;
     uint32_t max_block_id;
+    bool parallel_propagation;  // Process each rank across max_workers threads
+    bool pull_propagation;      // ASes pull routes from their neighbors instead of being sent them
+    uint32_t concurrent_blocks; // Number of blocks extrapolated at once
+    uint32_t prefetch_blocks;   // Number of blocks fetched and decoded ahead of propagation, 0 to disable
+    std::string block_plan_dir; // Directory block plans are cached in, empty to disable
+    bool double_buffer_ribs;    // Save the results of a block from a second generation of RIBs while the next is propagated
+    InputSource<PrefixType> *input; // Owned source of the relationships and announcements, NULL to use the database
+    AnnouncementStore<PrefixType> *announcement_store; // Owned compiled announcements, seeded instead of those of the input or database
 
     /**
      *  Overrwritable function that is first called in the preform_propagation function.
      *  Purely here for inheritance reasons 
+     *
+     *  @throws std::runtime_error if the announcement store cannot be opened
      */
     virtual void init();
 
+    /**
+     *  Drop and create the results, stubs, non_stubs, and supernodes tables.
+     *  Called by init unless results are kept in results_dir.
+     */
+    void init_tables();
+
     /**
      *  Overrwritable function that is called after populate_blocks in the preform_propagation function.
      *  Purely here for inheritance reasons.
+     *
+     *  @param block_sizes Announcements in each prefix block and then each subnet block, as planned by 
+     *                     plan_blocks. Used to schedule concurrent blocks, selected if NULL.
+     */
+    virtual void extrapolate(std::vector<Prefix<PrefixType>*> *prefix_blocks, std::vector<Prefix<PrefixType>*> *subnet_blocks,
+                                const std::vector<uint32_t> *block_sizes = NULL);
+
+    /**
+     *  Create an extrapolator that works on blocks alongside this one. It must share the
+     *  topology of this extrapolator's graph, and have its own RIBs and database connection.
+     *  Returns NULL by default, meaning blocks can only be extrapolated one at a time.
+     */
+    virtual BlockedExtrapolator* create_block_worker();
+
+    /**
+     *  Create a querier with its own database connection for fetching blocks ahead of propagation.
+     *  Returns NULL by default, meaning blocks are fetched only when they are propagated.
      */
-    virtual void extrapolate(std::vector<Prefix<PrefixType>*> *prefix_blocks, std::vector<Prefix<PrefixType>*> *subnet_blocks);
+    virtual SQLQuerierType* create_prefetch_querier();
 
 public:
     BlockedExtrapolator(bool random_tiebraking,
@@ -36,11 +132,25 @@ public:
                         bool origin_only,
                         std::vector<uint32_t> *full_path_asns,
                         int max_threads,
-                        bool select_block_id) : BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>(random_tiebraking, store_results, store_invert_results, store_depref_results, origin_only, full_path_asns, max_threads) {
+                        bool select_block_id,
+                        bool parallel_propagation = DEFAULT_PARALLEL_PROPAGATION,
+                        bool pull_propagation = DEFAULT_PULL_PROPAGATION,
+                        uint32_t concurrent_blocks = DEFAULT_CONCURRENT_BLOCKS,
+                        uint32_t prefetch_blocks = DEFAULT_PREFETCH_BLOCKS,
+                        std::string block_plan_dir = DEFAULT_BLOCK_PLAN_DIR,
+                        bool double_buffer_ribs = DEFAULT_DOUBLE_BUFFER_RIBS) : BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>(random_tiebraking, store_results, store_invert_results, store_depref_results, origin_only, full_path_asns, max_threads) {
         
         this->iteration_size = iteration_size;
         this->mh_mode = mh_mode;
         this->select_block_id = select_block_id;
+        this->parallel_propagation = parallel_propagation;
+        this->pull_propagation = pull_propagation;
+        this->concurrent_blocks = concurrent_blocks;
+        this->prefetch_blocks = prefetch_blocks;
+        this->block_plan_dir = block_plan_dir;
+        this->double_buffer_ribs = double_buffer_ribs;
+        this->input = NULL;
+        this->announcement_store = NULL;
     }
 
     BlockedExtrapolator() : BlockedExtrapolator(DEFAULT_RANDOM_TIEBRAKING, DEFAULT_STORE_RESULTS, DEFAULT_STORE_INVERT_RESULTS, DEFAULT_STORE_DEPREF_RESULTS, DEFAULT_ITERATION_SIZE, DEFAULT_MH_MODE, DEFAULT_ORIGIN_ONLY, NULL, DEFAULT_MAX_THREADS, DEFAULT_SELECT_BLOCK_ID) { }
@@ -51,6 +161,8 @@ public:
      *      1) A populated mrt_announcements table
      *      2) A populated customer_provider table
      *      3) A populated peers table
+     *
+     * @throws std::runtime_error if the announcement store cannot be opened
      */
     virtual void perform_propagation();
 
@@ -63,6 +175,33 @@ public:
      */
     virtual void extrapolate_by_block_id(uint32_t max_block_id);
 
+    /** Extrapolate the blocks read from the input source, in order.
+     *
+     * Called by perform_propagation when input is set. The source numbers the prefixes of
+     * each block itself, so the database is not used for the announcements.
+     *
+     * @throws std::runtime_error If the input cannot be read into blocks, see FileInputSource
+     */
+    virtual void extrapolate_input();
+
+    /** Extrapolate the blocks of the announcement store, in order.
+     *
+     * Called by perform_propagation when announcement_store is set. The announcements are 
+     * seeded straight from the mapped file, so nothing is parsed.
+     */
+    virtual void extrapolate_store();
+
+    /** Compile the announcements into a store, to be extrapolated instead of the announcements table.
+     *
+     * The blocks are those perform_propagation would extrapolate, read from the input source 
+     * if it is set, otherwise planned and fetched from the announcements table.
+     *
+     * @param file_name Store file to write
+     * @return False if the store could not be written
+     * @throws std::runtime_error If the input cannot be read into blocks, see FileInputSource
+     */
+    virtual bool compile_announcements(std::string file_name);
+
     /** Recursive function to break the input mrt_announcements into manageable blocks.
      *
      * @param p The current subnet for checking announcement block size
@@ -72,6 +211,59 @@ public:
                                     std::vector<Prefix<PrefixType>*>*, 
                                     std::vector<Prefix<PrefixType>*>*);
 
+    /** Break the announcements into blocks using the number of announcements for each prefix.
+     *
+     * The counts are selected in one query. Loads a cached plan from block_plan_dir instead if 
+     * it was made from the same counts and its blocks fit in the RIBs, otherwise caches this one.
+     *
+     * @param prefix_vector The vector of prefixes of appropriate size
+     * @param bloc_vector The vector of subnets of appropriate size
+     * @param block_sizes Filled with the announcements in each prefix block and then each subnet block, if not NULL
+     */
+    virtual void plan_blocks(std::vector<Prefix<PrefixType>*>* prefix_vector, 
+                                std::vector<Prefix<PrefixType>*>* bloc_vector,
+                                std::vector<uint32_t> *block_sizes = NULL);
+
+    /** Make the same blocks as populate_blocks from the number of announcements for each prefix.
+     *
+     * The counts are summed up a binary trie of the address space, which is then walked in the 
+     * order populate_blocks splits it.
+     *
+     * @param counts Each prefix and its number of announcements
+     * @param prefix_vector The vector of prefixes of appropriate size
+     * @param bloc_vector The vector of subnets of appropriate size
+     * @param block_sizes Filled with the announcements in each prefix block and then each subnet block
+     * @return The most distinct prefixes in any one block
+     */
+    virtual uint32_t plan_blocks_from_counts(const std::vector<std::pair<Prefix<PrefixType>, uint32_t>> &counts,
+                                            std::vector<Prefix<PrefixType>*>* prefix_vector, 
+                                            std::vector<Prefix<PrefixType>*>* bloc_vector,
+                                            std::vector<uint32_t> *block_sizes);
+
+    /** Write a block plan to a file, replacing it atomically.
+     *
+     * @param key Identifies the announcements and settings the plan was made for
+     * @param max_block_prefixes The most distinct prefixes in any one block
+     * @param block_sizes Announcements in each prefix block and then each subnet block
+     * @return True if the plan was saved
+     */
+    bool save_block_plan(std::string file_name, std::string key, uint32_t max_block_prefixes,
+                            std::vector<Prefix<PrefixType>*>* prefix_vector, 
+                            std::vector<Prefix<PrefixType>*>* bloc_vector,
+                            const std::vector<uint32_t> &block_sizes);
+
+    /** Read a block plan saved by save_block_plan.
+     *
+     * @param key Must match the key the plan was saved with
+     * @param max_block_prefixes Slots of the RIBs, every block of the plan must fit in them
+     * @param block_sizes Filled with the announcements in each prefix block and then each subnet block
+     * @return True if the plan was loaded, otherwise the vectors are left empty
+     */
+    bool load_block_plan(std::string file_name, std::string key, uint32_t max_block_prefixes,
+                            std::vector<Prefix<PrefixType>*>* prefix_vector, 
+                            std::vector<Prefix<PrefixType>*>* bloc_vector,
+                            std::vector<uint32_t> *block_sizes);
+
     /** Process a set of prefix or subnet blocks in iterations.
     */
     virtual void extrapolate_blocks(uint32_t &announcement_count, 
@@ -79,6 +271,107 @@ public:
                                     bool subnet, 
                                     std::vector<Prefix<PrefixType>*> *prefix_set);
 
+    /** Extrapolate concurrent_blocks blocks at a time, each on its own block worker.
+     *
+     * Workers share the graph topology read-only. The largest blocks are started first, so
+     * the run does not end waiting on one large block.
+     *
+     * @param blocks The blocks to extrapolate, sorted by this function
+     * @return False if this extrapolator has no block workers, in which case nothing is done
+     */
+    virtual bool extrapolate_blocks_concurrently(std::vector<ExtrapolationBlock<PrefixType>> &blocks);
+
+    /** Extrapolate blocks in order while an input thread fetches and decodes up to prefetch_blocks ahead.
+     *
+     * The input thread has its own database connection. Decoded blocks are held in a bounded 
+     * queue until they are seeded, since the RIBs cannot be seeded while the previous block 
+     * propagates. The time propagation waits on the input thread is reported for every block.
+     *
+     * @param blocks The blocks to extrapolate, in order
+     * @param stop_at_empty Stop at the first empty block rather than skipping it
+     * @param announcement_count Incremented by the number of announcements extrapolated
+     * @param iteration Number of the next block, incremented for each block propagated
+     * @return False if prefetching is disabled or not supported, in which case nothing is done
+     */
+    virtual bool extrapolate_blocks_prefetched(std::vector<ExtrapolationBlock<PrefixType>> &blocks, 
+                                                bool stop_at_empty, 
+                                                uint32_t &announcement_count, 
+                                                int &iteration);
+
+    /** Fetch a block of announcements and decode its rows.
+     *
+     * @param querier Querier to fetch the block with
+     * @param decoded Decoded block, its block member selects what is fetched. Left empty if the query 
+     *                fails part way, so the block is skipped rather than propagated incomplete
+     */
+    virtual void fetch_decoded_block(SQLQuerierType *querier, DecodedBlock<PrefixType> &decoded);
+
+    /** Stream a block of announcements from the database, seeding each chunk of rows as it arrives.
+     *
+     * @param block The block to select
+     * @return Number of announcements in the block, 0 if the query failed part way, in which case 
+     *         the RIBs are cleared of what was seeded
+     */
+    virtual size_t seed_streamed_block(const ExtrapolationBlock<PrefixType> &block);
+
+    /** Seed every announcement in a block of rows from the announcements table.
+     *
+     * @param ann_block Rows of announcements
+     * @param by_block_id Index the RIBs by the block_prefix_id column rather than prefix_id
+     * @param prefix_slots Slot in the RIBs of each prefix_id seeded so far in this block
+     */
+    virtual void seed_block(pqxx::result &ann_block, bool by_block_id, std::unordered_map<uint32_t, uint32_t> &prefix_slots);
+
+    /** Decode a block of rows from the announcements table, dropping announcements with loops.
+     *
+     * Only reads the graph, so it may run while another block propagates.
+     *
+     * @param ann_block Rows of announcements
+     * @param by_block_id Index the RIBs by the block_prefix_id column rather than prefix_id
+     * @param prefix_slots Slot in the RIBs of each prefix_id decoded so far in this block
+     * @param decoded Decoded block the announcements are appended to
+     */
+    virtual void decode_block(pqxx::result &ann_block, bool by_block_id, std::unordered_map<uint32_t, uint32_t> &prefix_slots, DecodedBlock<PrefixType> &decoded);
+
+    /** Give a prefix the next free slot in the RIBs, or the slot it already has in this block.
+     *
+     * The RIBs have graph->max_block_prefix_id slots, see init. A block holding more prefixes 
+     * than that, such as one from a block plan that no longer matches the announcements, 
+     * has no slot for the rest.
+     *
+     * @param prefix_id The prefix_id of the prefix
+     * @param prefix_slots Slot in the RIBs of each prefix_id seeded so far in this block
+     * @param slot Set to the slot of the prefix
+     * @return False if every slot is taken by another prefix
+     */
+    bool assign_slot(uint32_t prefix_id, std::unordered_map<uint32_t, uint32_t> &prefix_slots, uint32_t &slot);
+
+    /** Decode one announcement and append it to a decoded block, unless its path has a loop.
+     *
+     * @param prefix Prefix of the announcement, with its prefix_id and RIB slot as block_id
+     * @param as_path The as_path field, such as "{3,2,1}"
+     * @param decoded Decoded block the announcement is appended to
+     * @return False if the announcement was dropped for a loop
+     */
+    bool decode_announcement(const Prefix<PrefixType> &prefix, const char *as_path, uint32_t origin, int64_t timestamp, DecodedBlock<PrefixType> &decoded);
+
+    /** Seed every announcement of a decoded block.
+     *
+     * @param decoded Decoded announcements
+     */
+    virtual void seed_decoded_block(DecodedBlock<PrefixType> &decoded);
+
+    /** Propagate the seeded block, save its results, and clear the announcements.
+     *
+     * The results are saved in the background while the next block is propagated. With 
+     * double_buffer_ribs the results are saved from the other generation of RIBs, so this only 
+     * waits on the threads saving results when they are still on the previous block.
+     *
+     * @param iteration Number of the block, keeps the files of the results apart
+     * @param save_res_thread Thread saving the results of the previous block
+     */
+    virtual void propagate_block(int iteration, std::thread &save_res_thread);
+
     /** Seed announcement on all ASes on as_path. 
      *
      * The from_monitor attribute is set to true on these announcements so they are
@@ -88,8 +381,66 @@ public:
      *
      * @param as_path Vector of ASNs for this announcement.
      * @param prefix The prefix this announcement is for.
+     * @param path_indices Graph index of each ASN on as_path, as decoded by PathDecoder. Looked up if NULL.
+     */
+    virtual void give_ann_to_as_path(std::vector<uint32_t>* as_path, Prefix<PrefixType> prefix, int64_t timestamp = 0, const std::vector<uint32_t> *path_indices = NULL);
+
+    /** Propagate announcements from customers to peers and providers ASes.
+     *
+     * Uses the pull engine when pull_propagation is enabled, otherwise the rank 
+     * parallel sweep when parallel_propagation is enabled.
+     */
+    virtual void propagate_up();
+
+    /** Send "best" announces from providers to customer ASes. 
+     *
+     * Uses the pull engine when pull_propagation is enabled, otherwise the rank 
+     * parallel sweep when parallel_propagation is enabled.
      */
-    virtual void give_ann_to_as_path(std::vector<uint32_t>* as_path, Prefix<PrefixType> prefix, int64_t timestamp = 0);
+    virtual void propagate_down();
+
+    /** Process the best announcements of one class of neighbors directly from their local RIBs.
+     *
+     * This is the pull engine counterpart of send_all_announcements. Nothing is copied into
+     * incoming_announcements; each route is adjusted and processed as it is read. Neighbors are
+     * visited in the order the push engine would have delivered their announcements, so both
+     * engines produce the same results.
+     *
+     * @param recving_as AS that is pulling announcements
+     * @param relationship AS_REL_PROVIDER, AS_REL_PEER, or AS_REL_CUSTOMER, the neighbors pulled from
+     * @param senders Scratch vector, reused between calls to avoid allocations
+     */
+    virtual void pull_announcements(ASType *recving_as, int relationship, std::vector<ASType*> &senders);
+
+    /** Sweep the ranks in order, each AS processing its incoming announcements and sending to its neighbors.
+     *
+     * @param ranks ASes grouped by rank, in the order the ranks are to be processed
+     * @param relationship AS_REL_PROVIDER, AS_REL_PEER, or AS_REL_CUSTOMER, the neighbors being sent to
+     */
+    virtual void propagate_ranks(std::vector<std::vector<ASType*>> &ranks, int relationship);
+
+    /** Sweep the ranks in order, processing every AS in a rank across max_workers threads.
+     *
+     * ASes within one rank never send to each other in the given direction, so each rank is
+     * handled in two steps separated by a barrier. First each AS processes its incoming 
+     * announcements and assembles what it will send. Then the assembled announcements are 
+     * delivered, with every thread owning a disjoint subset of the receivers. Receivers are fed 
+     * in the same order as the serial sweep, so the results are identical to it.
+     *
+     * @param ranks ASes grouped by rank, in the order the ranks are to be processed
+     * @param relationship AS_REL_PROVIDER, AS_REL_PEER, or AS_REL_CUSTOMER, the neighbors being sent to
+     */
+    virtual void propagate_ranks_parallel(std::vector<std::vector<ASType*>> &ranks, int relationship);
+
+    /** Assemble the announcements an AS sends to one class of its neighbors.
+     *
+     * Applies the multihomed mode and the relationship filters, but does not send anything.
+     *
+     * @param source_as AS that is sending out announces
+     * @param relationship AS_REL_PROVIDER, AS_REL_PEER, or AS_REL_CUSTOMER, the neighbors being sent to
+     * @param anns Vector the outgoing announcements are appended to
+     */
+    virtual void assemble_announcements(ASType *source_as, int relationship, std::vector<AnnouncementType> &anns);
 
     /** Send all announcements kept by an AS to its neighbors. 
      *
@@ -101,6 +452,13 @@ public:
      * @param to_customers Send to customers
      */
     virtual void send_all_announcements(uint32_t asn, bool to_providers = false, bool to_peers = false, bool to_customers = false);
+
+    /** Assemble the announcements of an AS for one class of its neighbors and send them.
+     *
+     * @param source_as AS that is sending out announces
+     * @param relationship AS_REL_PROVIDER, AS_REL_PEER, or AS_REL_CUSTOMER, the neighbors being sent to
+     */
+    virtual void send_announcements(ASType *source_as, int relationship);
 };
 
 #endif
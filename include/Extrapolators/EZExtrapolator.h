@@ -86,7 +86,7 @@ public:
      * This is where the attacker announcement is sent out. All paths are seeded and if an origin of the path
      *      is to be attacked, then have the attacker process a malicous announcement and send it out (muahahaa).
      */
-    void give_ann_to_as_path(std::vector<uint32_t>* as_path, Prefix<> prefix, int64_t timestamp = 0);
+    void give_ann_to_as_path(std::vector<uint32_t>* as_path, Prefix<> prefix, int64_t timestamp = 0, const std::vector<uint32_t> *path_indices = NULL);
 
     /**
      * This will find the neighbor to the attacker on the AS path.
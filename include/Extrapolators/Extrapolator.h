@@ -25,6 +25,9 @@
 #define EXTRAPOLATOR_H
 
 #include "Extrapolators/BlockedExtrapolator.h"
+#include "InputSources/FileInputSource.h"
+#include "ResultSinks/FileResultSink.h"
+#include "ResultSinks/CopyResultSink.h"
 
 template <typename PrefixType = uint32_t>
 class Extrapolator : public BlockedExtrapolator<SQLQuerier<PrefixType>, ASGraph<PrefixType>, Announcement<PrefixType>, AS<PrefixType>, PrefixType> {
@@ -45,10 +48,33 @@ public:
                     bool origin_only,
                     std::vector<uint32_t> *full_path_asns,
                     int max_threads,
-                    bool select_block_id);
+                    bool select_block_id,
+                    bool parallel_propagation = DEFAULT_PARALLEL_PROPAGATION,
+                    bool pull_propagation = DEFAULT_PULL_PROPAGATION,
+                    uint32_t concurrent_blocks = DEFAULT_CONCURRENT_BLOCKS,
+                    bool bfs_rank_order = DEFAULT_BFS_RANK_ORDER,
+                    std::string snapshot_dir = DEFAULT_TOPOLOGY_SNAPSHOT_DIR,
+                    uint32_t prefetch_blocks = DEFAULT_PREFETCH_BLOCKS,
+                    std::string block_plan_dir = DEFAULT_BLOCK_PLAN_DIR,
+                    bool stream_results = DEFAULT_STREAM_RESULTS,
+                    std::string relationships_file = "",
+                    std::string announcements_file = "",
+                    std::string results_dir = "",
+                    std::string results_format = DEFAULT_RESULTS_FORMAT,
+                    bool compress_results = DEFAULT_COMPRESS_RESULTS,
+                    std::string announcement_store = "",
+                    bool double_buffer_ribs = DEFAULT_DOUBLE_BUFFER_RIBS);
 
     Extrapolator();
     ~Extrapolator();
+
+    /** Create an Extrapolator with the same settings that shares this one's graph topology.
+     */
+    BlockedExtrapolator<SQLQuerier<PrefixType>, ASGraph<PrefixType>, Announcement<PrefixType>, AS<PrefixType>, PrefixType>* create_block_worker();
+
+    /** Create a querier with the same settings and its own connection.
+     */
+    SQLQuerier<PrefixType>* create_prefetch_querier();
 };
 
 #endif
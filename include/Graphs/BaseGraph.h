@@ -29,6 +29,7 @@
 #include <vector>
 #include <stack>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <dirent.h>
 #include <pqxx/pqxx>
 
@@ -37,9 +38,48 @@
 #include "ASes/ROVppAS.h"
 #include "ASes/ROVAS.h"
 
+#include "InverseResults.h"
 #include "SQLQueriers/SQLQuerier.h"
+#include "InputSources/InputSource.h"
 #include "TableNames.h"
 
+/** Neighbors of every AS for one relationship, in compressed sparse row form.
+ */
+struct NeighborTable {
+    std::vector<uint32_t> offsets;  // Row of index i is indices[offsets[i]] up to indices[offsets[i+1]]
+    std::vector<uint32_t> indices;  // Neighbor indices, sorted within each row
+
+    IndexRange row(uint32_t index) const {
+        return IndexRange(indices.data() + offsets[index], indices.data() + offsets[index + 1]);
+    }
+};
+
+#define TOPOLOGY_SNAPSHOT_MAGIC "BGPTOPO"
+#define TOPOLOGY_SNAPSHOT_VERSION 1
+
+/** Start of a topology snapshot file, see BaseGraph::save_snapshot.
+ *
+ *  It is followed by these uint32_t arrays, in native byte order:
+ *      asns[num_ases]                          ASN at each index
+ *      rank_offsets[num_ranks + 1]             Rank r is indices rank_offsets[r] up to rank_offsets[r+1]
+ *      offsets[num_ases + 1], indices[num_edges[rel]]  Adjacency for each of AS_REL_PROVIDER, PEER, CUSTOMER
+ *      component_offsets[num_components + 1], component_members[num_members]  Supernodes
+ *      stubs[2 * num_stubs]                    Stub ASN and its parent ASN
+ *      non_stubs[num_non_stubs]
+ */
+struct TopologySnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    char key[68];                   // Identifies the relationships the snapshot was made from
+    uint32_t num_ases;
+    uint32_t num_ranks;
+    uint32_t num_edges[3];
+    uint32_t num_components;
+    uint32_t num_members;
+    uint32_t num_stubs;
+    uint32_t num_non_stubs;
+};
+
 template <class ASType, typename PrefixType = uint32_t>
 class BaseGraph {
 
@@ -53,11 +93,36 @@ public:
     std::map<uint32_t, uint32_t> *component_translation;// Translate AS to supernode AS
     std::map<uint32_t, uint32_t> *stubs_to_parents;
     std::vector<uint32_t> *non_stubs;
-    std::map<std::pair<Prefix<PrefixType>, uint32_t>,std::set<uint32_t>*> *inverse_results; 
+    // Prefix/origin pairs seeded in the block being propagated, NULL without inverse results
+    InverseResults<PrefixType> *inverse_results; 
+    // Inverse results of the last block, read by the threads saving results, see add_rib_generation
+    InverseResults<PrefixType> *saved_inverse_results; 
+    // Position in non_stubs and AS of each non-stub in the graph, see prepare_inverse_results
+    std::vector<std::pair<uint32_t, ASType*>> inverse_ases;
+    // Dense index of the ranked graph, see index_ases
+    std::vector<ASType*> *ases_by_index;                // AS at each index, rank by rank
+    std::unordered_map<uint32_t, uint32_t> *asn_to_index;   // Index of each ASN in ases
+    std::vector<std::vector<uint32_t>> *ranks_by_index; // Indices of the ASes in each rank, in sweep order
+    std::vector<NeighborTable> *adjacency;              // Frozen neighbors, indexed by AS_REL_*, empty if loaded from a snapshot
 
     bool store_depref_results;
+    // Lay out each rank breadth first from the top of the graph instead of in ASN order
+    bool bfs_rank_order;
+    // Directory of processed topology snapshots, empty to always process the graph
+    std::string snapshot_dir;
+    // Directory the stubs, non_stubs, and supernodes csvs are kept in, empty to copy them to the database
+    std::string results_dir;
+    // Mapped snapshot the neighbor indices point into, NULL if the graph was processed here
+    void *snapshot;
+    size_t snapshot_size;
+    // Ranks, neighbors, and supernodes belong to another graph
+    bool shared_topology;
     // Represents the largest prefix_id in a block
     uint32_t max_block_prefix_id;
+    // Prefix of each RIB slot, shared by the RIBs of all ASes in this graph
+    std::vector<Prefix<PrefixType>> *block_prefixes;
+    // Prefix table of the saved generation of RIBs, NULL until add_rib_generation
+    std::vector<Prefix<PrefixType>> *saved_block_prefixes;
 
     BaseGraph(bool store_inverse_results, bool store_depref_results) {
         ases = new std::unordered_map<uint32_t, ASType*>;               // Map of all ASes
@@ -66,13 +131,24 @@ public:
         component_translation = new std::map<uint32_t, uint32_t>;   // Translate node to supernode
         stubs_to_parents = new std::map<uint32_t, uint32_t>;        // Translace stub to parent
         non_stubs = new std::vector<uint32_t>;                      // All non-stubs in the graph
+        block_prefixes = new std::vector<Prefix<PrefixType>>;       // Prefix of each RIB slot
+        ases_by_index = new std::vector<ASType*>;                   // AS at each index
+        asn_to_index = new std::unordered_map<uint32_t, uint32_t>;  // Index of each ASN
+        ranks_by_index = new std::vector<std::vector<uint32_t>>;    // Indices of the ASes in each rank
+        adjacency = new std::vector<NeighborTable>(3);              // Providers, peers, customers
 
         if(store_inverse_results) 
-            inverse_results = new std::map<std::pair<Prefix<PrefixType>, uint32_t>, std::set<uint32_t>*>;
+            inverse_results = new InverseResults<PrefixType>;
         else 
             inverse_results = NULL;
+        saved_inverse_results = inverse_results;
+        saved_block_prefixes = NULL;
         
         this->store_depref_results = store_depref_results;
+        bfs_rank_order = false;
+        snapshot = NULL;
+        snapshot_size = 0;
+        shared_topology = false;
 
         // Set it to an arbitrary value to avoid changing extrapolator tests
         // The variable is changed in BlockedExtrapolator::perform_propagation
@@ -84,12 +160,70 @@ public:
     //Creation of template type
     virtual ASType* createNew(uint32_t asn) = 0;
 
+    /** Create an AS with createNew and have its RIBs use this graph's prefix table.
+     *
+     *  @param asn the asn of the new AS
+     */
+    ASType* create_as(uint32_t asn);
+
+    /** AS at a position of the dense index. 
+     *
+     *  @param index graph_index of the AS
+     */
+    ASType* as_at(uint32_t index) { 
+        return (*ases_by_index)[index]; 
+    }
+
+    /** Look up an AS through the dense index, for use at the input and output boundaries.
+     *
+     *  ASNs merged into a supernode are not in the graph, apart from the supernode's own.
+     *
+     *  @param asn the asn to look up
+     *  @return NULL if the asn is not in the graph
+     */
+    ASType* find_as(uint32_t asn) {
+        auto search = asn_to_index->find(asn);
+        if (search == asn_to_index->end())
+            return NULL;
+        return (*ases_by_index)[search->second];
+    }
+
     //****************** Propagation Interaction ******************//
 
     /** Clear all announcements in AS.
     */
     virtual void clear_announcements();
 
+    /** Give every AS a second generation of RIBs. The results of one block are then saved from 
+     *  the saved generation while the next block is propagated into the other. Doubles the memory 
+     *  of the RIBs, so this is only done when asked for. Must be called after the graph is built.
+     */
+    void add_rib_generation();
+
+    /** Make the RIBs of the block just propagated the saved generation, and clear the other 
+     *  generation for the next block. Must not be called while results are being saved.
+     */
+    void swap_rib_generations();
+
+    /** Check whether add_rib_generation was called.
+     *
+     *  @return true if the RIBs are double buffered
+     */
+    bool has_rib_generations() const { return saved_block_prefixes != NULL; }
+
+    /** Start the saved inverse results over, with every non-stub in every seeded pair. 
+     *  Must be called before compute_inverse_results.
+     */
+    void prepare_inverse_results();
+
+    /** Take the ASes holding each pair out of the saved inverse results, scanning the saved RIBs. 
+     *  Parts own disjoint words of the bitsets, so they may run on separate threads.
+     *
+     *  @param part Share to compute, from 0 to num_parts - 1
+     *  @param num_parts Number of shares the work is split into
+     */
+    void compute_inverse_results(int part, int num_parts);
+
     /** Translates asn to asn of component it belongs to in graph.
      *
      *  @param asn the asn to translate
@@ -99,6 +233,16 @@ public:
 
     //****************** Graph Setup ******************//
 
+    /** Make this graph share the topology of a processed graph, with its own announcements.
+     *
+     *  Every AS in the source gets a counterpart here with its own RIBs, pointing to the
+     *  source's neighbor sets. Ranks, supernodes, and stubs are shared as well. The source
+     *  must outlive this graph and must not be changed while it is shared.
+     *
+     *  @param source the graph to share the topology of
+     */
+    virtual void share_topology(BaseGraph<ASType, PrefixType> *source);
+
     /** Adds an AS relationship to the graph.
      *
      * If the AS does not exist in the graph, it will be created.
@@ -116,11 +260,54 @@ public:
     /** Generates an ASGraph from relationship data in an SQL database based upon:
      *      1) A populated peers table
      *      2) A populated customer_providers table
+     *
+     * If snapshot_dir is set, the graph is loaded from the snapshot of the current 
+     * relationships when there is one, and a snapshot is saved after processing otherwise.
      * 
      * @param querier
+     * @throws std::runtime_error if the relationships could only be read in part
      */
     virtual void create_graph_from_db(SQLQuerier<PrefixType> *querier);
 
+    /** Generates an ASGraph from the relationships of an input source, such as an as-rel file.
+     *
+     * Snapshots are used as in create_graph_from_db, named after the version of the relationships.
+     * 
+     * @param input Source of the relationships
+     * @param querier Used to save the stubs, non_stubs, and supernodes unless results_dir is set
+     */
+    virtual void create_graph_from_input(InputSource<PrefixType> *input, SQLQuerier<PrefixType> *querier);
+
+    /** Write the processed graph to a snapshot file that load_snapshot can map.
+     *
+     *  The file is written under a temporary name and renamed into place, so processes 
+     *  reading the directory never see a partial snapshot.
+     *
+     *  @param file_name path of the snapshot
+     *  @param key identifies the relationships the graph was built from, at most 67 characters
+     *  @return false if the file could not be written
+     */
+    virtual bool save_snapshot(std::string file_name, std::string key);
+
+    /** Fill an empty graph from a snapshot written by save_snapshot, instead of processing it.
+     *
+     *  The file is mapped read only and shared, and the neighbor indices of every AS point 
+     *  into it, so processes loading the same snapshot share those pages. Ranks, supernodes, 
+     *  and stubs are rebuilt from it as if the graph had been processed. The neighbor sets are 
+     *  left empty, as propagation only reads the indices, see fill_neighbor_sets. The offsets 
+     *  and indices are checked to stay within the snapshot before any are used.
+     *
+     *  @param file_name path of the snapshot
+     *  @param key must match the key the snapshot was saved with
+     *  @return false if there is no usable snapshot, in which case the graph is unchanged
+     */
+    virtual bool load_snapshot(std::string file_name, std::string key);
+
+    /** Fill the neighbor sets of a graph loaded from a snapshot from its neighbor indices.
+     *  Only needed by code reading the sets rather than the indices.
+     */
+    void fill_neighbor_sets();
+
     /** Remove the stub ASes from the graph.
      *
      * @param querier
@@ -151,10 +338,25 @@ public:
      *  This means it is possible to have an AS of rank 0 directly below an AS of 
      *  rank 4, but not possible to have an AS of rank 3 below one of rank 2. 
      *
-     *  The bottom of the DAG is rank 0. 
+     *  The bottom of the DAG is rank 0. Ranks are found in one pass over the graph, 
+     *  each AS being ranked once all of its customers are. The graph must have no cycles,
+     *  so supernodes must be combined first.
      */
     virtual void decide_ranks();
 
+    /** Number the ASes 0..N-1 rank by rank, and freeze the topology into adjacency.
+     *
+     *  Called at the end of decide_ranks. Propagation walks ranks_by_index and the rows of 
+     *  adjacency each AS points to, so it never looks up an ASN or walks a neighbor set. 
+     *  The graph must not be changed afterwards without deciding the ranks again.
+     *
+     *  ASes of a rank are in ASN order, or with bfs_rank_order in the order a breadth first 
+     *  search down through customers reaches them. The latter puts the customers of a provider
+     *  next to each other, so they are swept together. It changes which of two equally good 
+     *  announcements an AS keeps, since ties go to the one received first.
+     */
+    virtual void index_ases();
+
     //****************** Supernode Generation ******************//
 
     /** Tarjan driver to detect strongly connected components in the ASGraph.
@@ -164,7 +366,9 @@ public:
     virtual void tarjan();
 
     /** Tarjan algorithm to detect strongly connected components in the ASGraph.
-    */
+     *
+     *  Iterative, so the depth of the graph is not limited by the size of the stack.
+     */
     virtual void tarjan_helper(ASType *as, int &index, std::stack<ASType*> &s);
 
     /** Combine providers, peers, and customers of ASes in a strongly connected component.
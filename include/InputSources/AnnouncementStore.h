@@ -0,0 +1,159 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#ifndef ANNOUNCEMENT_STORE_H
+#define ANNOUNCEMENT_STORE_H
+
+#define ANNOUNCEMENT_STORE_MAGIC "BGPXANN1"
+#define ANNOUNCEMENT_STORE_VERSION 1
+#define ANNOUNCEMENT_STORE_HEADER_SIZE 80
+
+#include <cstdio>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Prefix.h"
+
+/** Header of a compiled announcement store file.
+ *
+ * The file holds the announcements array, then the ASN pool, then the blocks array, 
+ * at the offsets given here. Everything is in host byte order.
+ */
+struct AnnouncementStoreHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t prefix_bytes;          // sizeof the PrefixType of the addresses
+    uint64_t num_blocks;
+    uint64_t num_anns;
+    uint64_t num_asns;
+    uint64_t anns_offset;
+    uint64_t asns_offset;
+    uint64_t blocks_offset;
+    uint32_t max_block_prefix_id;   // One more than the largest slot used in any block
+    uint32_t reserved;
+};
+
+/** A block of the store, its announcements are next to each other.
+ */
+struct StoredBlock {
+    uint64_t first_ann;
+    uint64_t num_anns;
+    uint64_t rows;                  // Rows of the block, including announcements dropped for loops
+};
+
+/** An announcement of the store, ready to be seeded.
+ */
+template <typename PrefixType = uint32_t>
+struct StoredAnnouncement {
+    PrefixType addr;
+    PrefixType netmask;
+    uint32_t prefix_id;
+    uint32_t block_prefix_id;       // Slot in the RIBs for its block
+    uint32_t origin;
+    uint32_t path_length;
+    uint64_t path_start;            // Position of the AS path in the ASN pool
+    int64_t timestamp;
+};
+
+/** Announcements compiled into blocks, with AS paths decoded into a shared pool of ASNs.
+ *
+ * The file is mapped rather than read, so seeding from it neither parses nor copies the 
+ * whole snapshot up front. Paths with loops are dropped when the store is compiled.
+ */
+template <typename PrefixType = uint32_t>
+class AnnouncementStore {
+public:
+    std::string file_name;
+    const AnnouncementStoreHeader *header;
+    const StoredBlock *blocks;
+    const StoredAnnouncement<PrefixType> *anns;
+    const uint32_t *asns;
+
+    AnnouncementStore(std::string file_name);
+    ~AnnouncementStore();
+
+    /** Map the file and check its header and that each block lies within the announcements.
+     *
+     * @return False if the file cannot be mapped, is not a store, or holds the other address family
+     */
+    bool open();
+    void close();
+
+    /** Check that the AS path of an announcement lies within the ASN pool, before reading it.
+     *
+     * @param ann An announcement of this store
+     * @return True if the path can be read
+     */
+    bool valid_path(const StoredAnnouncement<PrefixType> &ann) const {
+        return ann.path_start <= header->num_asns && ann.path_length <= header->num_asns - ann.path_start;
+    }
+
+private:
+    void *mapping;
+    size_t mapped_size;
+};
+
+/** Writes an announcement store one block at a time.
+ *
+ * The announcements are written as they are added and the ASN pool is kept in a temporary 
+ * file, so memory use does not grow with the snapshot. The store is written under a temporary 
+ * name and renamed once complete.
+ */
+template <typename PrefixType = uint32_t>
+class AnnouncementStoreWriter {
+public:
+    std::string file_name;
+
+    AnnouncementStoreWriter(std::string file_name);
+    ~AnnouncementStoreWriter();
+
+    bool open();
+
+    /** Add an announcement to the current block.
+     *
+     * @param path AS path, origin last, prepending kept
+     */
+    void add(const Prefix<PrefixType> &prefix, uint32_t origin, int64_t timestamp, const uint32_t *path, uint32_t path_length);
+
+    /** End the current block.
+     *
+     * @param rows Rows the block was made from, including announcements dropped for loops
+     */
+    void end_block(uint64_t rows);
+
+    /** Write the ASN pool, blocks, and header, and move the store into place.
+     *
+     * @return False if anything could not be written
+     */
+    bool close();
+
+private:
+    std::string tmp_name;
+    FILE *file;
+    FILE *asns_file;
+    AnnouncementStoreHeader header;
+    std::vector<StoredBlock> blocks;
+    uint64_t block_start;
+};
+#endif
@@ -0,0 +1,102 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#ifndef FILE_INPUT_SOURCE_H
+#define FILE_INPUT_SOURCE_H
+
+#define FILE_INPUT_BUFFER_SIZE (1 << 20)
+
+#include <cstdio>
+#include <set>
+
+#include "InputSources/InputSource.h"
+
+/** Reads the relationships and announcements from text files instead of the database.
+ *
+ * The relationships file is in the CAIDA as-rel format, "<as1>|<as2>|<rel>" with -1 when 
+ * as1 is the provider of as2 and 0 when they are peers. Commas or tabs may be used instead 
+ * of bars, and lines starting with # are skipped, so serial-1 and serial-2 files both work.
+ *
+ * The announcements file has one "<prefix>,<as_path>,<origin>,<time>" row per announcement, 
+ * or the same fields separated by tabs. The as_path may be an array such as "{3,2,1}" or 
+ * separated by spaces, and prefixes of the other address family are skipped. The rows of 
+ * each prefix must be next to each other, which sorting the file by prefix ensures, 
+ * otherwise reading fails.
+ */
+template <typename PrefixType = uint32_t>
+class FileInputSource : public InputSource<PrefixType> {
+public:
+    std::string relationships_file;
+    std::string announcements_file;
+
+    FileInputSource(std::string relationships_file, std::string announcements_file);
+    ~FileInputSource();
+
+    std::string relationships_version();
+    void read_relationships(const typename InputSource<PrefixType>::RelationshipCallback &add);
+    void rewind_announcements();
+
+    /** Read the next block of announcements, see InputSource.
+     *
+     * @throws std::runtime_error If the rows of a prefix are not next to each other
+     */
+    size_t read_announcements(size_t max_rows, const typename InputSource<PrefixType>::AnnouncementCallback &add);
+
+    /** Parse an as-rel line in place.
+     *
+     * @return False if the line is a comment or malformed
+     */
+    static bool parse_relationship(char *line, uint32_t &as_1, uint32_t &as_2, int &relationship);
+
+    /** Parse an announcement line in place. The as_path is left pointing into the line.
+     *
+     * @return False if the line is malformed or of the other address family
+     */
+    static bool parse_announcement(char *line, Prefix<PrefixType> &prefix, char *&as_path, uint32_t &origin, int64_t &timestamp);
+
+    /** Parse a prefix in CIDR notation, such as "137.99.0.0/16".
+     *
+     * @return False if the field is not a prefix of this address family
+     */
+    static bool parse_prefix(const char *field, Prefix<PrefixType> &prefix);
+
+private:
+    FILE *announcements;
+    char *line;                 // Line buffer reused by getline
+    size_t line_capacity;
+    bool pending;               // The parsed row is the first of the next block
+    Prefix<PrefixType> row_prefix;
+    char *row_path;
+    uint32_t row_origin;
+    int64_t row_timestamp;
+    uint32_t next_prefix_id;
+    size_t skipped_rows;
+    std::set<Prefix<PrefixType>> seen_prefixes;  // Prefixes in earlier blocks, to catch unsorted files
+
+    /** Read and parse the next announcement row.
+     *
+     * @return False at the end of the file
+     */
+    bool next_row();
+};
+#endif
@@ -0,0 +1,71 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#ifndef INPUT_SOURCE_H
+#define INPUT_SOURCE_H
+
+#include <cstdint>
+#include <string>
+#include <functional>
+
+#include "Prefix.h"
+
+/** Where the relationships and announcements are read from when not from the database.
+ *
+ * Announcements are read a block at a time. The source numbers the prefixes, giving each 
+ * a prefix_id and a block_id which is its slot in the RIBs for the current block.
+ */
+template <typename PrefixType = uint32_t>
+class InputSource {
+public:
+    typedef std::function<void(uint32_t, uint32_t, bool)> RelationshipCallback;
+    typedef std::function<void(const Prefix<PrefixType>&, const char*, uint32_t, int64_t)> AnnouncementCallback;
+
+    virtual ~InputSource() { }
+
+    /** Returns a key which changes whenever the relationships change, used to name topology snapshots.
+     */
+    virtual std::string relationships_version() = 0;
+
+    /** Calls add once for each relationship.
+     *
+     * @param add Called with (provider, customer, false) or (peer, peer, true)
+     */
+    virtual void read_relationships(const RelationshipCallback &add) = 0;
+
+    /** Start reading the announcements from the first block again.
+     */
+    virtual void rewind_announcements() = 0;
+
+    /** Read the next block of announcements, made of whole prefixes.
+     *
+     * A prefix is only started while fewer than max_rows announcements have been read, so 
+     * a block never holds more than max_rows prefixes.
+     *
+     * @param max_rows Number of announcements after which no more prefixes are started
+     * @param add Called with the prefix, as_path field, origin, and time of each announcement
+     * @return The number of announcements read, 0 once there are none left
+     */
+    virtual size_t read_announcements(size_t max_rows, const AnnouncementCallback &add) = 0;
+};
+#endif
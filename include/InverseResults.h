@@ -0,0 +1,115 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#ifndef INVERSE_RESULTS_H
+#define INVERSE_RESULTS_H
+
+#include <cstdint>
+#include <vector>
+#include <utility>
+
+#include "Prefix.h"
+
+/** Inverse results of a block: for each prefix and origin that was seeded, the non-stub ASes 
+ * whose best route for the prefix does not come from that origin.
+ *
+ * The ASes of each pair are a bitset over positions in the graph's non_stubs, so a pair costs 
+ * one bit per non-stub rather than a tree node. Seeds are only recorded while the block is 
+ * propagated; after it, prepare sets every bit and the RIBs are scanned to erase the ASes 
+ * holding each pair, see BaseGraph::compute_inverse_results. Erasing touches only the word 
+ * holding the AS's bit, so threads erasing disjoint ranges of words need no locking.
+ */
+template <typename PrefixType = uint32_t>
+class InverseResults {
+public:
+    typedef std::pair<Prefix<PrefixType>, uint32_t> PrefixOrigin;
+
+    // Returned by find when a pair was not seeded
+    static const size_t npos = (size_t) -1;
+
+    InverseResults();
+
+    /** Record a prefix and origin seeded in this block. Duplicates are allowed.
+     */
+    void add_seed(const Prefix<PrefixType> &prefix, uint32_t origin) {
+        pairs.push_back(PrefixOrigin(prefix, origin));
+    }
+
+    /** Drop the seeds and bitsets of the block.
+     */
+    void clear();
+
+    /** Sort the seeded pairs and give each a bitset holding every AS.
+     *
+     * @param asns The non-stub ASNs, the bit at position i standing for asns[i]
+     */
+    void prepare(const std::vector<uint32_t> *asns);
+
+    /** Find the pair of an announcement, after prepare.
+     *
+     * @return Index of the pair, npos if it was not seeded
+     */
+    size_t find(const Prefix<PrefixType> &prefix, uint32_t origin) const;
+
+    /** Take the AS at a position out of a pair.
+     */
+    void erase(size_t pair, uint32_t position) {
+        bits[pair * words + (position >> 6)] &= ~((uint64_t) 1 << (position & 63));
+    }
+
+    /** Number of pairs, after prepare.
+     */
+    size_t size() const { return pairs.size(); }
+    const PrefixOrigin& at(size_t pair) const { return pairs[pair]; }
+
+    /** Number of 64 bit words in the bitset of each pair.
+     */
+    size_t num_words() const { return words; }
+
+    /** Number of ASes left in a pair.
+     */
+    size_t count(size_t pair) const;
+
+    /** Call f with the ASN of every AS left in a pair, in order of position.
+     */
+    template <typename Function>
+    void for_each_asn(size_t pair, Function f) const {
+        const uint64_t *word = bits.data() + pair * words;
+        for (size_t w = 0; w < words; w++) {
+            uint64_t set = word[w];
+            while (set != 0) {
+                f((*asns)[(w << 6) + __builtin_ctzll(set)]);
+                set &= set - 1;
+            }
+        }
+    }
+
+private:
+    std::vector<PrefixOrigin> pairs;    // Seeds, then sorted by block_id and origin without duplicates
+    std::vector<uint32_t> slot_start;   // Pairs of block_id b are pairs[slot_start[b]] up to pairs[slot_start[b+1]]
+    std::vector<uint64_t> bits;         // Bitset of pair i is words from bits[i * words]
+    size_t words;
+    const std::vector<uint32_t> *asns;
+};
+
+#endif
@@ -0,0 +1,79 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+#ifndef PATH_DECODER_H
+#define PATH_DECODER_H
+
+#define NO_INDEX UINT32_MAX
+
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+
+/** Decodes the fields of announcement rows straight from their bytes.
+ *
+ * Nothing is allocated once the buffers have grown to the longest path, so each seeding 
+ * thread keeps one decoder and reuses it for every row.
+ */
+class PathDecoder {
+public:
+    std::vector<uint32_t> path;     // ASNs on the last decoded path, origin last, prepending kept
+    std::vector<uint32_t> indices;  // Graph index of each ASN on the path, NO_INDEX if not in the graph
+
+    PathDecoder() : epoch(0) { }
+
+    /** Decode an as_path field such as "{3,2,2,1}" in one pass, checking it for loops.
+     *
+     * Prepending is collapsed while checking, so a path has a loop if an ASN appears in two 
+     * separate runs, as in find_loop. Malformed tokens are logged and skipped, as in parse_path.
+     *
+     * @param field The as_path field as returned by libpqxx
+     * @param asn_to_index Index of each ASN in the graph
+     * @return False if the path has a loop
+     */
+    bool decode_path(const char *field, const std::unordered_map<uint32_t, uint32_t> &asn_to_index);
+
+    /** Parse a signed decimal integer, such as the time field.
+     *
+     * @return False if the field is not an integer
+     */
+    static bool parse_int64(const char *field, int64_t &value);
+
+    /** Parse a dotted IPv4 address or netmask, such as the host and netmask fields.
+     *
+     * @return False if the field is not an IPv4 address
+     */
+    static bool parse_ipv4(const char *field, uint32_t &addr);
+
+private:
+    std::vector<uint32_t> seen;     // Epoch of the last path each graph index was seen on
+    std::vector<uint32_t> unknown;  // ASNs outside the graph on the current path
+    uint32_t epoch;
+
+    /** Record one run of the path.
+     *
+     * @return False if the ASN was already on the path
+     */
+    bool visit(uint32_t asn, uint32_t index);
+};
+
+#endif
@@ -23,6 +23,9 @@
 #ifndef PREFIX_H
 #define PREFIX_H
 
+// Longest cidr written by Prefix::write_cidr, an IPv6 address of eight four digit quads and /128
+#define PREFIX_CIDR_MAX_LENGTH 43
+
 #include <cmath>
 #include <cstdint>
 #include <string>
@@ -303,58 +306,56 @@ public:
     }
 
 
-    /** Converts this prefix into a cidr formatted string.
+    /** Writes this prefix in cidr format, without a terminating null.
      *
-     *  @return cidr A string in cidr format.
+     *  IPv6 addresses are written as eight hex quads without leading zeros, and no run of zero 
+     *  quads is shortened, so every prefix of a family is written the same way.
+     *
+     *  @param out Buffer of at least PREFIX_CIDR_MAX_LENGTH chars
+     *  @return Number of chars written
      */
-    std::string to_cidr() const {
-        // Check if this prefix is IPv6 or IPv4
+    size_t write_cidr(char *out) const {
+        char *start = out;
+        uint32_t length = 0;
         if (std::is_same<Integer, uint128_t>::value) {
-            std::ostringstream cidr;
+            static const char hex_digits[] = "0123456789abcdef";
             for (int i = 112; i >= 0; i = i - 16) {
-                // Process each quad separately
-                int quad = (addr >> i) & 0xFFFF;
-                // Convert quad to hex and add to cidr
-                cidr << std::hex << quad;
-                // Don't add a colon after the last quad
-                if (i != 0) {
-                    cidr << ":";
+                uint32_t quad = (uint32_t) ((uint128_t) addr >> i) & 0xFFFF;
+                // Skip the leading zeros of the quad, but keep one digit
+                int shift = 12;
+                while (shift > 0 && (quad >> shift) == 0) {
+                    shift -= 4;
                 }
-            }
-            cidr << '/';
-            
-            // Calculate the number of 1s in netmask
-            uint32_t sz = 0;
-            for (int i = 0; i < 128; i++) {
-                if (netmask & ((uint128_t) 1 << i)) {
-                    sz++;
+                for (; shift >= 0; shift -= 4) {
+                    *out++ = hex_digits[(quad >> shift) & 0xF];
+                }
+                if (i != 0) {
+                    *out++ = ':';
                 }
             }
-            // Switch stringstream back to decimal
-            cidr << std::dec << sz;
-            return cidr.str();
+            length = __builtin_popcountll((uint64_t) netmask) + __builtin_popcountll((uint64_t) ((uint128_t) netmask >> 64));
         } else {
-            std::string cidr = "";
-            uint8_t quad = (addr & 0xFF000000) >> 24;
-            cidr.append(std::to_string(quad) + ".");
-            quad = (addr & 0x00FF0000) >> 16;
-            cidr.append(std::to_string(quad) + ".");
-            quad = (addr & 0x0000FF00) >> 8;
-            cidr.append(std::to_string(quad) + ".");
-            quad = (addr & 0x000000FF) >> 0;
-            cidr.append(std::to_string(quad));
-            cidr.push_back('/');
-            // Assume valid cidr netmask, e.g. no ones after the first zero
-            uint8_t sz = 0;
-            for (int i = 0; i < 32; i++) {
-                if (netmask & (1 << i)) {
-                    sz++;
+            for (int i = 24; i >= 0; i = i - 8) {
+                out = write_small_uint(out, (uint32_t) (addr >> i) & 0xFF);
+                if (i != 0) {
+                    *out++ = '.';
                 }
             }
-            cidr.append(std::to_string(sz));
-            return cidr;
+            // Assume valid cidr netmask, e.g. no ones after the first zero
+            length = __builtin_popcountll((uint64_t) netmask);
         }
-        return "";
+        *out++ = '/';
+        out = write_small_uint(out, length);
+        return out - start;
+    }
+
+    /** Converts this prefix into a cidr formatted string.
+     *
+     *  @return cidr A string in cidr format.
+     */
+    std::string to_cidr() const {
+        char cidr[PREFIX_CIDR_MAX_LENGTH];
+        return std::string(cidr, write_cidr(cidr));
     }
     
     /** operator<< is not defined for 128 bit integers
@@ -426,5 +427,19 @@ public:
     bool contained_in_or_equal_to(const Prefix<Integer> &b) const {
         return b.netmask <= netmask && (addr & b.netmask) == (b.addr & b.netmask);
     }
+
+private:
+    /** Writes an octet or prefix length in decimal.
+     */
+    static char* write_small_uint(char *out, uint32_t value) {
+        if (value >= 100) {
+            *out++ = '0' + value / 100;
+        }
+        if (value >= 10) {
+            *out++ = '0' + value / 10 % 10;
+        }
+        *out++ = '0' + value % 10;
+        return out;
+    }
 };
 #endif
@@ -2,6 +2,8 @@
 #define PREFIX_ANNOUNCEMENT_MAP_H
 
 #include <vector>
+#include <cstdint>
+#include <iostream>
 
 #include "Prefix.h"
 #include "Announcements/Announcement.h"
@@ -9,130 +11,397 @@
 #include "Announcements/ROVppAnnouncement.h"
 #include "Announcements/ROVAnnouncement.h"
 
+/**
+ * How an announcement is kept in a slot of a PrefixAnnouncementMap. By default the whole announcement is stored.
+ */
+template <class AnnouncementType, typename PrefixType>
+struct RIBEntry {
+    typedef AnnouncementType Record;
+    struct Cache { };
+    static const bool uses_prefix_table = false;
+
+    static void store(Record &record, const AnnouncementType &ann) { record = ann; }
+    static void reset(Record &record) { record.tstamp = -1; }
+    static const AnnouncementType& load(const Record &record, const Prefix<PrefixType> &, Cache &, bool &) { return record; }
+};
+
+/**
+ * Plain announcements are packed into 20 bytes. Their prefix is implied by the slot, so it is kept once
+ * per slot in a prefix table shared by the maps of a graph. The vtable pointer, policy_index, and the
+ * unused bytes of the priority are dropped. The 64 bit timestamp is split into two 32 bit halves, so 
+ * the record needs no 8 byte alignment. Reading a slot unpacks it into an announcement held by the iterator.
+ */
+template <typename PrefixType>
+struct RIBEntry<Announcement<PrefixType>, PrefixType> {
+    struct Record {
+        uint32_t origin;
+        uint32_t received_from_asn;
+        uint32_t tstamp_low;
+        uint32_t tstamp_high;
+        uint8_t path_length;
+        uint8_t relationship;
+        bool from_monitor;
+    };
+    typedef Announcement<PrefixType> Cache;
+    static const bool uses_prefix_table = true;
+
+    static void store(Record &record, const Announcement<PrefixType> &ann) {
+        record.origin = ann.origin;
+        record.received_from_asn = ann.received_from_asn;
+        record.tstamp_low = (uint32_t) ann.tstamp;
+        record.tstamp_high = (uint32_t) ((uint64_t) ann.tstamp >> 32);
+        record.path_length = ann.priority.path_length;
+        record.relationship = ann.priority.relationship;
+        record.from_monitor = ann.from_monitor;
+    }
+
+    static void reset(Record &) { }
+
+    static const Announcement<PrefixType>& load(const Record &record, const Prefix<PrefixType> &prefix, Cache &ann, bool &loaded) {
+        if(loaded)
+            return ann;
+        loaded = true;
+        ann.prefix = prefix;
+        ann.origin = record.origin;
+        ann.received_from_asn = record.received_from_asn;
+        ann.tstamp = (int64_t) (((uint64_t) record.tstamp_high << 32) | record.tstamp_low);
+        ann.priority = Priority();
+        ann.priority.path_length = record.path_length;
+        ann.priority.relationship = record.relationship;
+        ann.from_monitor = record.from_monitor;
+        ann.policy_index = 0;
+        return ann;
+    }
+};
+
+/**
+ * Announcements of an AS indexed by the block_id of their prefix.
+ *
+ * Every function is defined here so it can be inlined into the propagation loops. Which slots are
+ * filled is tracked in a bitmap next to the announcements, one bit per slot. Iteration jumps from one
+ * set bit to the next rather than checking every announcement. The words of the bitmap that were
+ * written since the last clear are listed, so clearing costs only as much as what was written.
+ * Slots hold records laid out by RIBEntry, see above.
+ */
 template <class AnnouncementType, typename PrefixType = uint32_t>
 class PrefixAnnouncementMap {
 private:
+    typedef RIBEntry<AnnouncementType, PrefixType> Entry;
+
     size_t filled_size;//Number of announcements that are filled in the announcements vector
-    std::vector<AnnouncementType> announcements;
+    std::vector<typename Entry::Record> announcements;
+    std::vector<Prefix<PrefixType>> *prefixes;//Prefix of each slot, if the records do not hold it
+    bool owns_prefixes;
+    std::vector<uint64_t> occupied;//Bit i is set if announcements[i] is filled
+    std::vector<uint32_t> dirty_words;//Words of occupied that became nonzero since the last clear
+
+    /**
+     *  Returns the index of the first filled announcement at or after index, or the capacity if there is none.
+     */
+    size_t next_filled(size_t index) const {
+        size_t word = index >> 6;
+        if (word >= occupied.size())
+            return announcements.size();
+
+        // Ignore the bits before index in the first word
+        uint64_t bits = occupied[word] & (~(uint64_t) 0 << (index & 63));
+        while (bits == 0) {
+            if (++word == occupied.size())
+                return announcements.size();
+            bits = occupied[word];
+        }
+        return (word << 6) + __builtin_ctzll(bits);
+    }
+
+    bool is_occupied(size_t index) const {
+        return (occupied[index >> 6] >> (index & 63)) & 1;
+    }
+
+    void set_occupied(size_t index) {
+        uint64_t &word = occupied[index >> 6];
+        // A word emptied by erase and filled again is listed twice, clear skips the second
+        if (word == 0)
+            dirty_words.push_back(index >> 6);
+        word |= (uint64_t) 1 << (index & 63);
+    }
+
+    void reset_occupied(size_t index) {
+        occupied[index >> 6] &= ~((uint64_t) 1 << (index & 63));
+    }
+
+    const Prefix<PrefixType>& prefix_at(size_t index) const {
+        static const Prefix<PrefixType> none(0, 0, 0, 0);
+        return prefixes == NULL ? none : (*prefixes)[index];
+    }
+
+    /**
+     *  Records the prefix of a slot in the prefix table. The table is only written when the slot
+     *  changes prefix, which happens while seeding, so propagation only ever reads a shared table.
+     */
+    void set_prefix(size_t index, const Prefix<PrefixType> &prefix) {
+        if(prefixes == NULL) {
+            prefixes = new std::vector<Prefix<PrefixType>>(announcements.size(), Prefix<PrefixType>(0, 0, 0, 0));
+            owns_prefixes = true;
+        }
+
+        Prefix<PrefixType> &slot = (*prefixes)[index];
+        if(slot.addr != prefix.addr || slot.netmask != prefix.netmask || slot.id != prefix.id || slot.block_id != prefix.block_id)
+            slot = prefix;
+    }
 
 public:
     class Iterator {
     public:
         const PrefixAnnouncementMap<AnnouncementType, PrefixType> *parent;
         size_t index;
+        uint64_t bits;//Set bits of the current bitmap word from index on
+        typename Entry::Cache current;//Unpacked announcement at index, for compact records
+        bool loaded;
 
-        Iterator(const PrefixAnnouncementMap<AnnouncementType, PrefixType> *parent, size_t index) : parent(parent), index(index) {
-            if(index < parent->announcements.size() && parent->announcements.at(index).tstamp == -1)
+        Iterator(const PrefixAnnouncementMap<AnnouncementType, PrefixType> *parent, size_t index) : parent(parent), index(index), bits(0), loaded(false) {
+            if(index >= parent->announcements.size() || !parent->is_occupied(index))
                 this->index = parent->announcements.size();
+            else
+                bits = parent->occupied[index >> 6] & (~(uint64_t) 0 << (index & 63));
         }
 
-        Iterator(const Iterator& other) : parent(other.parent), index(other.index) {
+        Iterator(const Iterator& other) : parent(other.parent), index(other.index), bits(other.bits), loaded(false) {
 
         }
 
-        virtual Iterator& operator++();
-        virtual Iterator operator++(int);
+        Iterator& operator=(const Iterator& other) {
+            parent = other.parent;
+            index = other.index;
+            bits = other.bits;
+            loaded = false;
+            return *this;
+        }
+
+        Iterator& operator++() {
+            loaded = false;
+            // Next set bit in the same word, otherwise search the following words
+            bits &= bits - 1;
+            if(bits != 0) {
+                index = (index & ~(size_t) 63) + __builtin_ctzll(bits);
+            } else {
+                index = parent->next_filled((index | 63) + 1);
+                if(index < parent->announcements.size())
+                    bits = parent->occupied[index >> 6] & (~(uint64_t) 0 << (index & 63));
+            }
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator tmp(*this);
+            operator++();
+            return tmp;
+        }
 
-        virtual bool operator==(const Iterator& other) const;
-        virtual bool operator!=(const Iterator& other) const;
+        bool operator==(const Iterator& other) const { return index == other.index; }
+        bool operator!=(const Iterator& other) const { return index != other.index; }
 
-        virtual const AnnouncementType& operator*();
-        virtual const AnnouncementType* operator->();
+        /**
+         *  The reference stays valid until the iterator is moved or destroyed.
+         */
+        const AnnouncementType& operator*() {
+            return Entry::load(parent->announcements[index], parent->prefix_at(index), current, loaded);
+        }
+        const AnnouncementType* operator->() { return &operator*(); }
     };
 
     /**
      * Given the capacity, this will initilize a list to allocate that many announcements of the given type.
      * This will initilize with the default constructor of the announcement type.
      * However, the return value of size after this constructor will be 0.
-     * 
+     *
      * This is because the size function counts the amount of "initilized" announcements.
      * After this constructor, the announcements stored here are meaningless blocks of allocated memory.
      * However, the point is that these blocks of memory are allocated and freed only once. Thus, during execution,
      * memory does not need to be played with as much. In addition, this allows us to access announcements by index
      * since they will be populated in a vector, and their corresponding index is stored in the prefix obejct.
      */
-    PrefixAnnouncementMap(size_t capacity) : filled_size(0) {
+    PrefixAnnouncementMap(size_t capacity) : filled_size(0), prefixes(NULL), owns_prefixes(false), occupied((capacity + 63) / 64, 0) {
         announcements.reserve(capacity);
+        announcements.assign(capacity, typename Entry::Record());
+    }
+
+    PrefixAnnouncementMap(const PrefixAnnouncementMap&) = delete;
+    PrefixAnnouncementMap& operator=(const PrefixAnnouncementMap&) = delete;
 
-        for(size_t i = 0; i < capacity; i++)
-            announcements.push_back(AnnouncementType());
+    ~PrefixAnnouncementMap() {
+        if(owns_prefixes)
+            delete prefixes;
     }
 
-    virtual ~PrefixAnnouncementMap();
+    /**
+     *  Use the given prefix table, indexed by block_id, rather than one of this map's own. Maps that
+     *  share a table must hold the same prefix in each slot, as the RIBs of a graph's ASes do.
+     *  Has no effect on maps whose records hold their prefix.
+     */
+    void share_prefixes(std::vector<Prefix<PrefixType>> *table) {
+        if(!Entry::uses_prefix_table)
+            return;
+
+        if(table->size() < announcements.size())
+            table->resize(announcements.size(), Prefix<PrefixType>(0, 0, 0, 0));
+        if(owns_prefixes)
+            delete prefixes;
+        prefixes = table;
+        owns_prefixes = false;
+    }
 
     /**
      * Returns an iterator to the element at the given prefix. If the announcement at this prefix is "not initilized"
      *  then this will return the end iterator.
      */
-    virtual Iterator find(const Prefix<PrefixType> &prefix);
+    Iterator find(const Prefix<PrefixType> &prefix) const {
+        return Iterator(this, prefix.block_id);
+    }
+
+    void insert(const Prefix<PrefixType> &prefix, const AnnouncementType &ann) {
+        if(prefix.block_id != ann.prefix.block_id) {
+            std::cerr << "This announcement cannot be inserted into this iterator since the index in the prefix is different from the index of the prefix in the announcement!" << std::endl;
+            return;
+        }
+
+        typename Entry::Record &slot = announcements.at(prefix.block_id);
+        bool was_filled = is_occupied(prefix.block_id);
+        Entry::store(slot, ann);
+        if(Entry::uses_prefix_table && ann.tstamp != -1)
+            set_prefix(prefix.block_id, prefix);
+
+        // An announcement with a timestamp of -1 is a placeholder
+        if(was_filled && ann.tstamp == -1) {
+            filled_size--;
+            reset_occupied(prefix.block_id);
+        } else if(!was_filled && ann.tstamp != -1) {
+            filled_size++;
+            set_occupied(prefix.block_id);
+        }
+    }
+
+    void insert(const Iterator &other_iterator) {
+        if(other_iterator.index >= announcements.size()) {
+            std::cerr << "The element of the other iterator cannot be inserted into this map since its index is out of bounds of this map!" << std::endl;
+            return;
+        }
+
+        Iterator other(other_iterator);
+        const AnnouncementType &other_announcement = *other;
+        insert(other_announcement.prefix, other_announcement);
+    }
 
-    virtual void insert(const Prefix<PrefixType> &prefix, const AnnouncementType &ann);
-    virtual void insert(const Iterator &other_iterator);
+    Iterator begin() const {
+        return Iterator(this, next_filled(0));
+    }
 
-    virtual Iterator begin() const;
-    virtual Iterator end() const;
+    Iterator end() const {
+        return Iterator(this, announcements.size());
+    }
 
     /**
      * Resets all stored announcements into a fake "uninitialized" state. The memory is still allocated,
      *  the announcements are all flagged as being uninitialized. Thus, the size will go to 0. The idea here
-     *  is that the announcements will no longer be used or seen, but may be overwritten later with a valid one. 
+     *  is that the announcements will no longer be used or seen, but may be overwritten later with a valid one.
      *  The point is, the memory is only allocated on startup and the absolute end of extrapolation.
+     *
+     *  Only the words of the bitmap written since the last clear are visited, so clearing a map
+     *  that received few announcements is cheap however large its capacity.
      */
-    virtual void clear();
+    void clear() {
+        for(uint32_t word : dirty_words) {
+            uint64_t bits = occupied[word];
+            while(bits != 0) {
+                Entry::reset(announcements[((size_t) word << 6) + __builtin_ctzll(bits)]);
+                bits &= bits - 1;
+            }
+            occupied[word] = 0;
+        }
+
+        dirty_words.clear();
+        filled_size = 0;
+    }
 
     /**
      *  Resets the announcement at this prefix into an "uninitialized" state.
-     * 
+     *
      *  As of writing this, this means setting the timestamp to -1, which cannot happen
      */
-    virtual void erase(Prefix<PrefixType> &prefix);
+    void erase(const Prefix<PrefixType> &prefix) {
+        typename Entry::Record &ann = announcements.at(prefix.block_id);
+
+        if(is_occupied(prefix.block_id)) {
+            filled_size--;
+            reset_occupied(prefix.block_id);
+            Entry::reset(ann);
+        }
+    }
 
     /**
      *  Resets the announcement at the prefix in the announcement given announcement, into an "uninitialized" state.
-     * 
+     *
      *  The given announcement is not modified, unless it happens to be a refrence to the announcement that is in this structure.
-     * 
+     *
      *  As of writing this, this means setting the timestamp to -1, which cannot happen
      */
-    virtual void erase(AnnouncementType &announcement);
+    void erase(const AnnouncementType &announcement) {
+        erase(announcement.prefix);
+    }
 
     /**
      * Determines whether or not the given announcement is a placeholder announcement or is a populated announcement
      * The idea is that we make the upfront allocation of announcments into memory, then modify the state of each announcement
      * This function will tell you if the given announcement is just a placeholder or is a real announcement with meaningful data
      */
-    virtual bool filled(const AnnouncementType &announcement);
+    bool filled(const AnnouncementType &announcement) const {
+        return !(announcement.tstamp == -1);
+    }
 
     /**
      * Determines whether or not the announcement, at the given prefix, is a placeholder announcement or is a populated announcement
      * The idea is that we make the upfront allocation of announcments into memory, then modify the state of each announcement
      * This function will tell you if the announcement, at the given prefix, is just a placeholder or is a real announcement with meaningful data
      */
-    virtual bool filled(const Prefix<PrefixType> &prefix);
+    bool filled(const Prefix<PrefixType> &prefix) const {
+        return prefix.block_id < announcements.size() && is_occupied(prefix.block_id);
+    }
 
     /**
      *  This will give back the number of announcements that are populated in the data structure.
-     * 
+     *
      *  One would expect that the size of this structure to be constant throughout execution, and this is true.
-     * 
+     *
      *  However, the idea of this function is to hide this fact. This will count the number of valid announcements.
-     * 
-     *  BE WARNED, the valid announcements in this structure are likely sparse, so be sure to check if the announcement
-     *      at a given index is filled
      */
-    virtual size_t size();
+    size_t size() const {
+        return filled_size;
+    }
+
+    /**
+     *  Counts the set bits of the occupancy bitmap. Always equal to size, kept to check that it is.
+     */
+    size_t count_filled() const {
+        size_t count = 0;
+        for (uint64_t bits : occupied)
+            count += __builtin_popcountll(bits);
+        return count;
+    }
 
     /**
      *  This returns the capacity of the internal vector.
      *  THIS SHOULD NEVER BE DIFFERENT FROM THE PASSED IN VALUE FROM THE CONSTRUCTOR
      *  IF it is different than what was originally passed in, then there is a bug
      */
-    virtual size_t capacity();
+    size_t capacity() const {
+        return announcements.capacity();
+    }
 
     /**
      *  Returns whether or not there are any filled announcements inside this data structure
      *  True if there are no filled announcements, false if there is at least one announcement
      */
-    virtual bool empty();
+    bool empty() const {
+        return filled_size == 0;
+    }
 };
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,63 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#ifndef COPY_RESULT_SINK_H
+#define COPY_RESULT_SINK_H
+
+#include "ResultSinks/ResultSink.h"
+#include "SQLQueriers/SQLQuerier.h"
+#include "SQLQueriers/CopyBuffer.h"
+
+/** Shard held in a binary COPY buffer and sent to its table when closed.
+ */
+template <typename PrefixType = uint32_t>
+class CopyResultShard : public ResultShard<PrefixType> {
+public:
+    SQLQuerier<PrefixType> *querier;
+    std::string table_name;
+    bool inverse;
+    CopyBuffer rows;
+
+    CopyResultShard(SQLQuerier<PrefixType> *querier, std::string table_name, bool inverse);
+
+    void add_result(uint32_t asn, const Prefix<PrefixType> &prefix, uint32_t origin, uint32_t received_from_asn, int64_t tstamp);
+    void add_inverse(uint32_t asn, const Prefix<PrefixType> &prefix, uint32_t origin);
+    bool close();
+};
+
+/** Sends the results to the database with binary COPY FROM STDIN.
+ *
+ * Each thread copies its shards over its own connection from writer_queriers, so shards of 
+ * different threads can be closed concurrently.
+ */
+template <typename PrefixType = uint32_t>
+class CopyResultSink : public ResultSink<PrefixType> {
+public:
+    SQLQuerier<PrefixType> *querier;    // Not owned
+    std::vector<SQLQuerier<PrefixType>*> *writer_queriers; // Connection of each thread, not owned, NULL or empty to use querier
+
+    CopyResultSink(SQLQuerier<PrefixType> *querier, std::vector<SQLQuerier<PrefixType>*> *writer_queriers = NULL);
+
+    ResultShard<PrefixType>* open_shard(std::string table_name, bool inverse, int iteration, int thread_num);
+};
+#endif
@@ -0,0 +1,98 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#ifndef FILE_RESULT_SINK_H
+#define FILE_RESULT_SINK_H
+
+#define RESULT_FILE_BUFFER_SIZE (1 << 20)
+#define RESULT_FILE_MAGIC "BGPXRES1"
+#define RESULT_FILE_HEADER_SIZE 16
+
+#include <cstdio>
+#include <zlib.h>
+
+#include "ResultSinks/ResultSink.h"
+#include "ResultSinks/ResultFormatter.h"
+
+/** Shard written to its own file, optionally gzip compressed.
+ *
+ * Rows are formatted into a buffer which is written out whenever it fills, so 
+ * memory use does not grow with the number of rows. Csv rows are formatted by a 
+ * ResultFormatter.
+ *
+ * The csv rows have the same columns as the database tables. The binary layout is a 
+ * 16 byte header followed by fixed width records, all integers little endian:
+ *
+ *  header:  "BGPXRES1", address bytes (4 or 16), inverse (0 or 1), record size (u16), 4 zero bytes
+ *  results: asn (u32), address (network order), prefix length (u8), origin (u32), 
+ *           received_from_asn (u32), time (i64), prefix_id (u32)
+ *  inverse: asn (u32), address (network order), prefix length (u8), origin (u32), prefix_id (u32)
+ */
+template <typename PrefixType = uint32_t>
+class FileResultShard : public ResultShard<PrefixType> {
+public:
+    std::string file_name;
+    bool binary;
+    bool inverse;
+
+    FileResultShard(std::string file_name, bool binary, bool compress, bool inverse);
+    ~FileResultShard();
+
+    void add_result(uint32_t asn, const Prefix<PrefixType> &prefix, uint32_t origin, uint32_t received_from_asn, int64_t tstamp);
+    void add_inverse(uint32_t asn, const Prefix<PrefixType> &prefix, uint32_t origin);
+    bool close();
+
+    /** Size of a binary record.
+     */
+    static uint16_t record_size(bool inverse);
+
+private:
+    FILE *file;         // NULL when compressed
+    gzFile gz_file;     // NULL when not compressed
+    bool failed;
+    std::string buffer;                 // Binary records
+    ResultFormatter<PrefixType> csv;    // Csv rows
+
+    void add_int(uint64_t value, int num_bytes);
+    void add_prefix(const Prefix<PrefixType> &prefix);
+    void write(const char *data, size_t size);
+    void flush();
+};
+
+/** Writes each shard to a file in a directory rather than to the database.
+ *
+ * Shards are named <table>_<iteration>_<thread> with a .csv or .bin extension, 
+ * and .gz added when compressed.
+ */
+template <typename PrefixType = uint32_t>
+class FileResultSink : public ResultSink<PrefixType> {
+public:
+    std::string dir;
+    bool binary;
+    bool compress;
+
+    FileResultSink(std::string dir, bool binary, bool compress);
+
+    ResultShard<PrefixType>* open_shard(std::string table_name, bool inverse, int iteration, int thread_num);
+};
+#endif
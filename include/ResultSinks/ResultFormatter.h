@@ -0,0 +1,110 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#ifndef RESULT_FORMATTER_H
+#define RESULT_FORMATTER_H
+
+// Rows are formatted into a buffer of about this size before they are written out
+#define RESULT_FORMATTER_BUFFER_SIZE (1 << 20)
+// Longest row, with every integer at its widest
+#define RESULT_FORMATTER_MAX_ROW (PREFIX_CIDR_MAX_LENGTH + 3 * 10 + 20 + 10 + 6)
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "Prefix.h"
+
+/** Formats csv result rows without iostreams.
+ *
+ * The cidr and prefix_id of each prefix are written once and kept in a cache indexed by the 
+ * block_id of the prefix, its slot in the RIBs, so a block with tens of thousands of ASes 
+ * holding the same prefix formats the prefix only once. Cached entries are checked against 
+ * the prefix, so they are written again when the next block puts another prefix in the slot.
+ *
+ * Rows have the columns of the results tables, the same as Announcement::to_csv:
+ *  results: asn,prefix,origin,received_from_asn,time,prefix_id
+ *  inverse: asn,prefix,origin,prefix_id
+ */
+template <typename PrefixType = uint32_t>
+class ResultFormatter {
+public:
+    ResultFormatter();
+
+    void add_result(uint32_t asn, const Prefix<PrefixType> &prefix, uint32_t origin, uint32_t received_from_asn, int64_t tstamp);
+    void add_inverse(uint32_t asn, const Prefix<PrefixType> &prefix, uint32_t origin);
+
+    /** Rows formatted since the last clear. The buffer is allocated by the first row.
+     */
+    const char* data() const { return buffer.data(); }
+    size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+
+    /** Whether the rows should be written out before more are added.
+     */
+    bool full() const { return length >= RESULT_FORMATTER_BUFFER_SIZE; }
+
+    /** Forget the rows, keeping the buffer and the cached prefixes.
+     */
+    void clear() { length = 0; }
+
+    /** Write an integer in decimal, two digits at a time.
+     *
+     * @param out Buffer of at least 20 chars, 21 for negative values
+     * @return The end of the integer
+     */
+    static char* write_uint(char *out, uint64_t value);
+    static char* write_int(char *out, int64_t value);
+
+private:
+    struct CachedPrefix {
+        PrefixType addr;
+        PrefixType netmask;
+        uint32_t id;
+        bool valid;
+        uint8_t cidr_length;
+        uint8_t id_length;
+        char cidr[PREFIX_CIDR_MAX_LENGTH + 1];  // The cidr and a comma
+        char id_text[12];                        // The prefix_id and a newline
+    };
+
+    std::vector<char> buffer;
+    size_t length;
+    std::vector<CachedPrefix> prefixes;
+
+    /** Get the cached strings of a prefix, formatting them if the slot holds another prefix.
+     */
+    const CachedPrefix& cached(const Prefix<PrefixType> &prefix);
+
+    /** Make room for a row at the end of the buffer.
+     */
+    char* row_start() {
+        if (buffer.size() < length + RESULT_FORMATTER_MAX_ROW) {
+            buffer.resize(std::max(buffer.size() * 2, (size_t) RESULT_FORMATTER_BUFFER_SIZE + RESULT_FORMATTER_MAX_ROW));
+        }
+        return buffer.data() + length;
+    }
+};
+
+#endif
@@ -0,0 +1,76 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#ifndef RESULT_SINK_H
+#define RESULT_SINK_H
+
+#include <cstdint>
+#include <string>
+
+#include "Prefix.h"
+
+/** Rows of one results table written by one thread for one iteration.
+ *
+ * Rows may be buffered until close, which must be called once all rows are added. 
+ * The prefix_id column is taken from prefix.id.
+ */
+template <typename PrefixType = uint32_t>
+class ResultShard {
+public:
+    virtual ~ResultShard() { }
+
+    /** Add a row of the results or depref table.
+     */
+    virtual void add_result(uint32_t asn, const Prefix<PrefixType> &prefix, uint32_t origin, uint32_t received_from_asn, int64_t tstamp) = 0;
+
+    /** Add a row of the inverse results table.
+     */
+    virtual void add_inverse(uint32_t asn, const Prefix<PrefixType> &prefix, uint32_t origin) = 0;
+
+    /** Write out any rows still buffered.
+     *
+     * @return false if the rows could not be saved
+     */
+    virtual bool close() = 0;
+};
+
+/** Where save_results puts the results, depref, and inverse results tables.
+ *
+ * Each worker thread opens its own shard, so a sink must allow shards to be 
+ * written concurrently.
+ */
+template <typename PrefixType = uint32_t>
+class ResultSink {
+public:
+    virtual ~ResultSink() { }
+
+    /** Open a shard for the rows of a table. The caller deletes it after closing it.
+     *
+     * @param table_name Table the rows belong to
+     * @param inverse True for inverse results rows, false for results or depref rows
+     * @param iteration Iteration (block) the rows are from
+     * @param thread_num Worker thread writing the shard
+     */
+    virtual ResultShard<PrefixType>* open_shard(std::string table_name, bool inverse, int iteration, int thread_num) = 0;
+};
+#endif
@@ -0,0 +1,82 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#ifndef COPY_BUFFER_H
+#define COPY_BUFFER_H
+
+#define COPY_CHUNK_SIZE (1 << 20)
+
+#include <cstdint>
+#include <string>
+
+#include "Prefix.h"
+
+/** Rows held in memory to be sent to the database with COPY FROM STDIN.
+ *
+ * In binary mode the buffer starts with the PGCOPY header and each row is built
+ * with begin_row followed by one add_* call per column, so nothing is formatted
+ * as text on the way to the server. In csv mode rows are appended to data directly.
+ */
+class CopyBuffer {
+public:
+    std::string data;
+    bool binary;
+    size_t rows;
+
+    CopyBuffer(bool binary = true);
+
+    void begin_row(int16_t num_fields);
+    void add_bigint(int64_t value);
+    void add_null();
+    void end();
+
+    /** Adds an inet field for the prefix (address and mask length).
+     */
+    template <typename PrefixType>
+    void add_inet(const Prefix<PrefixType> &prefix) {
+        const int num_bytes = sizeof(PrefixType);
+        // Mask length is the number of set bits in the netmask
+        uint8_t bits = 0;
+        PrefixType mask = prefix.netmask;
+        while (mask != 0) {
+            bits += mask & 1;
+            mask >>= 1;
+        }
+        add_int32(4 + num_bytes);
+        // PGSQL_AF_INET is 2, PGSQL_AF_INET6 is 3
+        data.push_back(num_bytes == 4 ? 2 : 3);
+        data.push_back(bits);
+        data.push_back(0);
+        data.push_back(num_bytes);
+        for (int shift = (num_bytes - 1) * 8; shift >= 0; shift -= 8) {
+            data.push_back((char) (uint8_t) (prefix.addr >> shift));
+        }
+    }
+
+    bool empty() const { return binary ? rows == 0 : data.empty(); }
+
+private:
+    void add_int16(int16_t value);
+    void add_int32(int32_t value);
+};
+#endif
@@ -50,6 +50,7 @@ public:
     pqxx::result select_all_pairs_from(std::string const& cur_table);
     pqxx::result select_tracked_ases(std::string const& cur_table);
     
+    using SQLQuerier::copy_results_to_db;
     void copy_results_to_db(std::string);
     void create_results_tbl();
     void copy_blackhole_list_to_db(std::string file_name);
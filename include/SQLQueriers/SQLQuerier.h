@@ -29,16 +29,21 @@
 
 #define DEFAULT_QUERIER_CONFIG_SECTION "bgp"
 #define DEFAULT_QUERIER_CONFIG_PATH "/etc/bgp/bgp.conf"
+#define STREAM_CHUNK_SIZE 10000
+#define ANNOUNCEMENT_COLUMNS "host(prefix), netmask(prefix), as_path, origin, time, prefix_id, block_prefix_id"
 
 #include <pqxx/pqxx>
+#include <libpq-fe.h>
 #include <iostream>
 #include <string>
 #include <sstream>
 #include <fstream>
 #include <algorithm>
+#include <functional>
 
 #include "Prefix.h"
 #include "TableNames.h"
+#include "SQLQueriers/CopyBuffer.h"
 
 #include <boost/program_options.hpp>
 namespace program_options = boost::program_options;
@@ -59,7 +64,9 @@ public:
     std::string config_section;
     std::string config_path;
     int exclude_as_number;
+    bool copy_from_stdin;
     pqxx::connection *C;
+    PGconn *copy_conn;  // Kept for COPY FROM STDIN, opened by the first copy_buffer_to_db
 
     SQLQuerier(std::string announcements_table = ANNOUNCEMENTS_TABLE,
                 std::string results_table = RESULTS_TABLE, 
@@ -70,16 +77,24 @@ public:
                 std::string config_section = DEFAULT_QUERIER_CONFIG_SECTION,
                 std::string config_path = DEFAULT_QUERIER_CONFIG_PATH,
                 bool create_connection = true);
+    SQLQuerier(const SQLQuerier<PrefixType> &other);
     virtual ~SQLQuerier();
     
     // Setup
     void read_config();
+    std::string connection_string();
     void open_connection();
     void close_connection();
     pqxx::result execute(std::string sql, bool insert = false);
+    void prepare_statements();
+    pqxx::result execute_prepared(std::string statement, std::string param);
+    size_t stream_rows(pqxx::work &txn, const std::function<void(pqxx::result&)> &consume);
     
     std::string copy_to_db_query_string(std::string file_name, std::string table_name, std::string column_names);
+    std::string copy_from_stdin_query_string(std::string table_name, std::string column_names, bool binary);
+    bool copy_buffer_to_db(const CopyBuffer &rows, std::string table_name, std::string column_names);
     std::string select_prefix_query_string(Prefix<PrefixType>* p, bool subnet = false, std::string selection = "COUNT(*)");
+    std::string prepared_select_query_string(std::string selection, std::string condition);
     std::string clear_table_query_string(std::string table_name);
     std::string create_table_query_string(std::string table_name, std::string column_names, bool unlogged = false, std::string grant_all_user = "");
     std::string select_max_query_string(std::string table_name, std::string column_name);
@@ -90,6 +105,8 @@ public:
     virtual pqxx::result select_prefix_ann(Prefix<PrefixType>*);
     pqxx::result select_subnet_count(Prefix<PrefixType>*);
     virtual pqxx::result select_subnet_ann(Prefix<PrefixType>*);
+    size_t stream_prefix_ann(Prefix<PrefixType>*, bool subnet, const std::function<void(pqxx::result&)> &consume);
+    size_t stream_from_table(std::string table_name, std::string column_names, const std::function<void(pqxx::result&)> &consume);
     
     // Preprocessing Tables
     void clear_stubs_from_db();
@@ -119,12 +136,21 @@ public:
     virtual void copy_single_results_to_db(std::string file_name);
     void copy_depref_to_db(std::string file_name);
     void copy_inverse_results_to_db(std::string file_name);
+    virtual void copy_results_to_db(const CopyBuffer &rows);
+    virtual void copy_single_results_to_db(const CopyBuffer &rows);
+    void copy_depref_to_db(const CopyBuffer &rows);
+    void copy_inverse_results_to_db(const CopyBuffer &rows);
     
     void create_results_index();
 
     pqxx::result select_max_block_id();
     pqxx::result select_max_prefix_id();
     pqxx::result select_max_block_prefix_id();
+    pqxx::result select_relationships_hash();
     pqxx::result select_prefix_block_id(int block_id, int family);
+    size_t stream_prefix_block_id(int block_id, int family, const std::function<void(pqxx::result&)> &consume);
+    pqxx::result select_block_id_counts(int family);
+    pqxx::result select_prefix_counts(int family);
+    pqxx::result select_announcements_version(int family);
 };
 #endif
@@ -90,6 +90,11 @@ bool test_decide_ranks();
 bool test_remove_stubs();
 bool test_tarjan();
 bool test_combine_components();
+bool test_index_ases();
+bool test_index_ases_bfs();
+bool test_topology_snapshot();
+bool test_preprocess_deep_chain();
+bool test_rib_generations();
 
 // Prototypes for ExtrapolatorTest.cpp
 bool test_Extrapolator_constructor();
@@ -108,6 +113,9 @@ bool test_save_results_parallel();
 bool test_save_results_at_asn();
 bool test_give_ann_to_as_path();
 bool test_give_ann_to_as_path_origin_only();
+bool test_seed_decoded_block();
+bool test_prefix_slots();
+bool test_save_results_at_asn_dir();
 bool test_send_all_announcements();
 bool test_prepending_priority_back();
 bool test_prepending_priority_middle();
@@ -125,8 +133,12 @@ bool test_send_all_announcements_multihomed_peer_mode1();
 bool test_send_all_announcements_multihomed_peer_mode2();
 bool test_extrapolation_buildup();
 bool test_extrapolation_teardown();
+bool test_plan_blocks_from_counts();
 bool test_extrapolate_blocks();
 bool test_extrapolate_by_block_id();
+bool test_propagate_parallel();
+bool test_propagate_pull();
+bool test_block_workers();
 
 
 // Prototypes for ROVppTest.cpp
@@ -185,6 +197,39 @@ bool test_rov_prepending_priority_beginning_existing_ann2();
 
 //PrefixAnnouncementMap
 bool prefixAnnouncementMap_test_insert();
+bool prefixAnnouncementMap_test_iteration();
+bool prefixAnnouncementMap_test_clear();
+bool prefixAnnouncementMap_test_compact();
+
+//PathDecoder
+bool test_decode_path();
+bool test_decode_path_loops();
+bool test_decode_fields();
+
+//FileInputSource
+bool test_parse_relationship();
+bool test_parse_announcement();
+bool test_read_announcements();
+bool test_extrapolate_input();
+
+//AnnouncementStore
+bool test_announcement_store();
+bool test_extrapolate_store();
+
+//ResultSinks
+bool test_file_result_sink();
+
+//ResultFormatter
+bool test_result_formatter();
+bool test_result_formatter_ipv6();
+
+//InverseResults
+bool test_inverse_results();
+bool test_compute_inverse_results();
+
+//WriterPool
+bool test_writer_pool_balance();
+bool test_writer_pool_run();
 
 //EZBGPsec
 bool ezbgpsec_test_path_propagation();
@@ -193,8 +238,12 @@ bool ezbgpsec_test_path_propagation();
 bool test_querier_buildup();
 bool test_querier_teardown();
 bool test_parse_config();
+bool test_querier_copy();
 bool test_copy_to_db_string();
+bool test_copy_from_stdin_string();
+bool test_copy_buffer();
 bool test_select_prefix_string();
+bool test_prepared_select_query_string();
 bool test_clear_table_string();
 bool test_create_table_string();
 bool test_select_max_query_string();
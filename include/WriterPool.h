@@ -0,0 +1,78 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+#ifndef WRITER_POOL_H
+#define WRITER_POOL_H
+
+#include <cstdint>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <functional>
+#include <condition_variable>
+
+/** Threads that save the results of every block, started once and kept for the whole run.
+ *
+ * The thread calling run takes the first share of each job, so a pool of one thread starts none.
+ */
+class WriterPool {
+public:
+    WriterPool(int num_threads);
+    ~WriterPool();
+
+    /** Number of shares each job is split into, including the calling thread's.
+     */
+    int size() const { return num_threads; }
+
+    /** Run a job on every thread, and return once all of them have finished it.
+     *
+     * Only one job may run at a time.
+     *
+     * @param job Called with the number of each thread, from 0 to size() - 1
+     */
+    void run(const std::function<void(int)> &job);
+
+    /** Split items into contiguous ranges of about equal total weight.
+     *
+     * @param weights Weight of each item, such as the number of announcements an AS holds
+     * @param parts Number of ranges
+     * @return parts + 1 bounds, range i being the items from bounds[i] up to bounds[i + 1]
+     */
+    static std::vector<size_t> balance(const std::vector<size_t> &weights, int parts);
+
+private:
+    int num_threads;
+    std::vector<std::thread> threads;
+    std::mutex mutex;
+    std::condition_variable job_ready;
+    std::condition_variable job_done;
+    const std::function<void(int)> *job;    // Job of the current round, set by run
+    uint64_t round;                         // Number of jobs run so far
+    int unfinished;                         // Threads still working on the current job
+    bool stopping;
+
+    /** Wait for jobs and take this thread's share of each, until the pool is destroyed.
+     */
+    void work(int thread_num);
+};
+
+#endif
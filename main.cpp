@@ -21,7 +21,7 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  ************************************************************************/
 
-#ifndef RUN_TESTS
+#if !defined(RUN_TESTS) && !defined(RUN_BENCHMARKS)
 #include <iostream>
 #include <boost/program_options.hpp>
 #include <thread>
@@ -95,6 +95,54 @@ int main(int argc, char *argv[]) {
         ("max-threads,m", 
          po::value<uint32_t>()->default_value(DEFAULT_MAX_THREADS), 
          "limits number of threads to a specified amount, uses all threads by default")
+        ("parallel-propagation", 
+         po::value<bool>()->default_value(DEFAULT_PARALLEL_PROPAGATION), 
+         "propagate each rank of the graph across max-threads threads")
+        ("pull-propagation", 
+         po::value<bool>()->default_value(DEFAULT_PULL_PROPAGATION), 
+         "ASes pull announcements from their neighbors rather than being sent them")
+        ("concurrent-blocks", 
+         po::value<uint32_t>()->default_value(DEFAULT_CONCURRENT_BLOCKS), 
+         "number of blocks to extrapolate at once, each with its own copy of the announcements")
+        ("bfs-rank-order", 
+         po::value<bool>()->default_value(DEFAULT_BFS_RANK_ORDER), 
+         "sweep each rank in breadth first order from the top of the graph rather than in ASN order")
+        ("topology-snapshot-dir", 
+         po::value<string>()->default_value(DEFAULT_TOPOLOGY_SNAPSHOT_DIR), 
+         "directory of processed graph snapshots, loaded instead of processing the graph when the relationships are unchanged")
+        ("prefetch-blocks", 
+         po::value<uint32_t>()->default_value(DEFAULT_PREFETCH_BLOCKS), 
+         "number of blocks fetched and decoded on an input thread ahead of propagation, 0 to disable")
+        ("block-plan-dir", 
+         po::value<string>()->default_value(DEFAULT_BLOCK_PLAN_DIR), 
+         "directory of cached block plans, loaded instead of planning the blocks when the announcements are unchanged")
+        ("stream-results", 
+         po::value<bool>()->default_value(DEFAULT_STREAM_RESULTS), 
+         "send results to the database with COPY FROM STDIN rather than through csvs in /dev/shm")
+        ("relationships-file", 
+         po::value<string>()->default_value(""), 
+         "CAIDA as-rel file to read the relationships from instead of the database, needs announcements-file")
+        ("announcements-file", 
+         po::value<string>()->default_value(""), 
+         "csv or tsv file of announcements sorted by prefix to read instead of the database, needs relationships-file")
+        ("results-dir", 
+         po::value<string>()->default_value(""), 
+         "directory to keep the results csvs in instead of copying them to the database")
+        ("results-format", 
+         po::value<string>()->default_value(DEFAULT_RESULTS_FORMAT), 
+         "format of the files in results-dir, csv or binary")
+        ("compress-results", 
+         po::value<bool>()->default_value(DEFAULT_COMPRESS_RESULTS), 
+         "gzip the files in results-dir")
+        ("announcements-store", 
+         po::value<string>()->default_value(""), 
+         "announcement store made by compile-announcements to extrapolate instead of the announcements table")
+        ("compile-announcements", 
+         po::value<string>()->default_value(""), 
+         "compile the announcements into this store file and exit, without extrapolating")
+        ("double-buffer-ribs", 
+         po::value<bool>()->default_value(DEFAULT_DOUBLE_BUFFER_RIBS), 
+         "save the results of a block from a second copy of the announcements while the next block is propagated")
         ("results-table,r",
          po::value<string>()->default_value(RESULTS_TABLE),
          "name of the results table")
@@ -168,6 +216,21 @@ int main(int argc, char *argv[]) {
     // Handle intro information
     intro();
 
+    // The relationships and announcements are read from the same source, a store only holds announcements
+    if (!vm["announcements-file"].as<string>().empty() && vm["relationships-file"].as<string>().empty()) {
+        std::cerr << "announcements-file needs relationships-file" << std::endl;
+        return 1;
+    }
+    if (!vm["relationships-file"].as<string>().empty() && vm["announcements-file"].as<string>().empty() && 
+            vm["announcements-store"].as<string>().empty()) {
+        std::cerr << "relationships-file needs announcements-file or announcements-store" << std::endl;
+        return 1;
+    }
+    if (vm["results-format"].as<string>() != "csv" && vm["results-format"].as<string>() != "binary") {
+        std::cerr << "results-format must be csv or binary" << std::endl;
+        return 1;
+    }
+
     // Record full path asns
     vector<uint32_t> *full_path_asns = NULL;
     vector<uint32_t> asn_vect;
@@ -301,10 +364,35 @@ int main(int argc, char *argv[]) {
             vm["origin-only"].as<bool>(),
             full_path_asns,
             vm["max-threads"].as<uint32_t>(),
-            vm["select-block-id"].as<bool>());
+            vm["select-block-id"].as<bool>(),
+            vm["parallel-propagation"].as<bool>(),
+            vm["pull-propagation"].as<bool>(),
+            vm["concurrent-blocks"].as<uint32_t>(),
+            vm["bfs-rank-order"].as<bool>(),
+            vm["topology-snapshot-dir"].as<string>(),
+            vm["prefetch-blocks"].as<uint32_t>(),
+            vm["block-plan-dir"].as<string>(),
+            vm["stream-results"].as<bool>(),
+            vm["relationships-file"].as<string>(),
+            vm["announcements-file"].as<string>(),
+            vm["results-dir"].as<string>(),
+            vm["results-format"].as<string>(),
+            vm["compress-results"].as<bool>(),
+            vm["announcements-store"].as<string>(),
+            vm["double-buffer-ribs"].as<bool>());
             
-        // Run propagation
-        extrap->perform_propagation();
+        // Run propagation, or only compile the announcements
+        try {
+            if (!vm["compile-announcements"].as<string>().empty()) {
+                extrap->compile_announcements(vm["compile-announcements"].as<string>());
+            } else {
+                extrap->perform_propagation();
+            }
+        } catch (const std::runtime_error &e) {
+            std::cerr << e.what() << std::endl;
+            delete extrap;
+            return 1;
+        }
         // Clean up
         delete extrap;
     } else {
@@ -335,13 +423,38 @@ int main(int argc, char *argv[]) {
             vm["origin-only"].as<bool>(),
             full_path_asns,
             vm["max-threads"].as<uint32_t>(),
-            vm["select-block-id"].as<bool>());
+            vm["select-block-id"].as<bool>(),
+            vm["parallel-propagation"].as<bool>(),
+            vm["pull-propagation"].as<bool>(),
+            vm["concurrent-blocks"].as<uint32_t>(),
+            vm["bfs-rank-order"].as<bool>(),
+            vm["topology-snapshot-dir"].as<string>(),
+            vm["prefetch-blocks"].as<uint32_t>(),
+            vm["block-plan-dir"].as<string>(),
+            vm["stream-results"].as<bool>(),
+            vm["relationships-file"].as<string>(),
+            vm["announcements-file"].as<string>(),
+            vm["results-dir"].as<string>(),
+            vm["results-format"].as<string>(),
+            vm["compress-results"].as<bool>(),
+            vm["announcements-store"].as<string>(),
+            vm["double-buffer-ribs"].as<bool>());
             
-        // Run propagation
-        extrap->perform_propagation();
+        // Run propagation, or only compile the announcements
+        try {
+            if (!vm["compile-announcements"].as<string>().empty()) {
+                extrap->compile_announcements(vm["compile-announcements"].as<string>());
+            } else {
+                extrap->perform_propagation();
+            }
+        } catch (const std::runtime_error &e) {
+            std::cerr << e.what() << std::endl;
+            delete extrap;
+            return 1;
+        }
         // Clean up
         delete extrap;
     }
     return 0;
 }
-#endif // RUN_TESTS
+#endif // RUN_TESTS, RUN_BENCHMARKS
@@ -1,17 +1,14 @@
 #include "ASes/AS.h"
 
 template <typename PrefixType>
-AS<PrefixType>::AS(uint32_t asn, uint32_t max_block_prefix_id, bool store_depref_results, std::map<std::pair<Prefix<PrefixType>, uint32_t>, std::set<uint32_t>*> *inverse_results) 
-    : BaseAS<Announcement<PrefixType>, PrefixType>(asn, max_block_prefix_id, store_depref_results, inverse_results) { }
+AS<PrefixType>::AS(uint32_t asn, uint32_t max_block_prefix_id, bool store_depref_results) 
+    : BaseAS<Announcement<PrefixType>, PrefixType>(asn, max_block_prefix_id, store_depref_results) { }
 
 template <typename PrefixType>
-AS<PrefixType>::AS(uint32_t asn, uint32_t max_block_prefix_id, bool store_depref_results) : AS<PrefixType>(asn, max_block_prefix_id, store_depref_results, NULL) { }
+AS<PrefixType>::AS(uint32_t asn, uint32_t max_block_prefix_id) : AS<PrefixType>(asn, max_block_prefix_id, false) { }
 
 template <typename PrefixType>
-AS<PrefixType>::AS(uint32_t asn, uint32_t max_block_prefix_id) : AS<PrefixType>(asn, max_block_prefix_id, false, NULL) { }
-
-template <typename PrefixType>
-AS<PrefixType>::AS() : AS<PrefixType>(0, 20, false, NULL) { }
+AS<PrefixType>::AS() : AS<PrefixType>(0, 20, false) { }
 
 template <typename PrefixType>
 AS<PrefixType>::~AS() { }
@@ -25,8 +25,12 @@
 template <class AnnouncementType, typename PrefixType>
 BaseAS<AnnouncementType, PrefixType>::~BaseAS() {
     delete incoming_announcements;
+    if(saved_anns != all_anns)
+        delete saved_anns;
     delete all_anns;
 
+    if(saved_depref_anns != depref_anns)
+        delete saved_depref_anns;
     if(depref_anns != NULL)
         delete depref_anns;
     
@@ -86,21 +90,6 @@ void BaseAS<AnnouncementType, PrefixType>::remove_neighbor(uint32_t asn, int rel
 
 //****************** Announcement Handling ******************//
 
-template <class AnnouncementType, typename PrefixType>
-void BaseAS<AnnouncementType, PrefixType>::swap_inverse_result(std::pair<Prefix<PrefixType>, uint32_t> old, std::pair<Prefix<PrefixType>, uint32_t> current) {
-    if (inverse_results != NULL) {
-        // Add back to old set, remove from new set
-        auto set = inverse_results->find(old);
-        if (set != inverse_results->end()) {
-            set->second->insert(asn);
-        }
-        set = inverse_results->find(current);
-        if (set != inverse_results->end()) {
-            set->second->erase(asn);
-        }
-    }
-}
-
 template <class AnnouncementType, typename PrefixType>
 void BaseAS<AnnouncementType, PrefixType>::receive_announcements(std::vector<AnnouncementType> &announcements) {
     for (AnnouncementType &ann : announcements) {
@@ -117,14 +106,6 @@ void BaseAS<AnnouncementType, PrefixType>::process_announcement(AnnouncementType
     // No announcement found for incoming announcement prefix
     if (search == all_anns->end()) {
         all_anns->insert(ann.prefix, ann);
-        // Inverse results need to be computed also with announcements from monitors
-        if (inverse_results != NULL) {
-            auto set = inverse_results->find(
-                std::pair<Prefix<PrefixType>, uint32_t>(ann.prefix, ann.origin));
-            if (set != inverse_results->end()) {
-                set->second->erase(asn);
-            }
-        }
     } else {
         // Logger::getInstance().log("Matching_Prefixes") << "Received an additional announcement for prefix:" << ann.prefix.to_cidr() << ", tstamp on processing announcement: " 
         //             << ann.tstamp << ", timestamp on stored announcement: " << search->tstamp
@@ -145,13 +126,6 @@ void BaseAS<AnnouncementType, PrefixType>::process_announcement(AnnouncementType
 
             // Defaults to first come, first kept if not random
             if (value) {
-                // Update inverse results
-                if(inverse_results != NULL) {
-                    swap_inverse_result(
-                        std::pair<Prefix<PrefixType>, uint32_t>(search->prefix, search->origin),
-                        std::pair<Prefix<PrefixType>, uint32_t>(ann.prefix, ann.origin));
-                }
-
                 // Use the new announcement
                 if(depref_anns != NULL) {
                     // auto search_depref = depref_anns->find(ann.prefix);
@@ -182,13 +156,6 @@ void BaseAS<AnnouncementType, PrefixType>::process_announcement(AnnouncementType
             }
         // Otherwise check new announcements priority for best path selection
         } else if (ann.priority > search->priority) {
-            if(inverse_results != NULL) {
-                // Update inverse results
-                swap_inverse_result(
-                    std::pair<Prefix<PrefixType>, uint32_t>(search->prefix, search->origin),
-                    std::pair<Prefix<PrefixType>, uint32_t>(ann.prefix, ann.origin));
-            }
-
             if(depref_anns != NULL) {
                 // auto search_depref = depref_anns->find(ann.prefix);
                 // if (search_depref == depref_anns->end()) {
@@ -242,6 +209,25 @@ void BaseAS<AnnouncementType, PrefixType>::clear_announcements() {
         depref_anns->clear();
 }
 
+template <class AnnouncementType, typename PrefixType>
+void BaseAS<AnnouncementType, PrefixType>::add_generation(std::vector<Prefix<PrefixType>> *prefixes) {
+    if(saved_anns != all_anns)
+        return;
+    saved_anns = new PrefixAnnouncementMap<AnnouncementType, PrefixType>(all_anns->capacity());
+    saved_anns->share_prefixes(prefixes);
+    if(depref_anns != NULL) {
+        saved_depref_anns = new PrefixAnnouncementMap<AnnouncementType, PrefixType>(depref_anns->capacity());
+        saved_depref_anns->share_prefixes(prefixes);
+    }
+}
+
+template <class AnnouncementType, typename PrefixType>
+void BaseAS<AnnouncementType, PrefixType>::swap_generations() {
+    std::swap(all_anns, saved_anns);
+    std::swap(depref_anns, saved_depref_anns);
+    clear_announcements();
+}
+
 template <class AnnouncementType, typename PrefixType>
 bool BaseAS<AnnouncementType, PrefixType>::already_received(AnnouncementType &ann) {
     auto search = all_anns->find(ann.prefix);
@@ -283,7 +269,7 @@ std::ostream& operator<<(std::ostream &os, const BaseAS<U>& as) {
 
 template <class AnnouncementType, typename PrefixType>
 std::ostream& BaseAS<AnnouncementType, PrefixType>::stream_announcements(std::ostream &os) {
-    for (auto const &ann : *all_anns) {
+    for (auto const &ann : *saved_anns) {
         os << asn << ',';
         ann.to_csv(os);
     }
@@ -292,8 +278,8 @@ std::ostream& BaseAS<AnnouncementType, PrefixType>::stream_announcements(std::os
 
 template <class AnnouncementType, typename PrefixType>
 std::ostream& BaseAS<AnnouncementType, PrefixType>::stream_depref(std::ostream &os) {
-    if(depref_anns != NULL) {
-        for (auto const &ann : *depref_anns) {
+    if(saved_depref_anns != NULL) {
+        for (auto const &ann : *saved_depref_anns) {
             os << asn << ',';
             ann.to_csv(os);
         }
@@ -1,6 +1,6 @@
 #include "ASes/EZAS.h"
 
-EZAS::EZAS(uint32_t asn, uint32_t max_block_prefix_id) : BaseAS<EZAnnouncement>(asn, max_block_prefix_id, false, NULL) { }
+EZAS::EZAS(uint32_t asn, uint32_t max_block_prefix_id) : BaseAS<EZAnnouncement>(asn, max_block_prefix_id, false) { }
 EZAS::EZAS() : EZAS(0, 20) { }
 EZAS::~EZAS() { }
 
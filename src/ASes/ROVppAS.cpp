@@ -96,14 +96,6 @@ void ROVppAS::process_announcement(ROVppAnnouncement &ann, bool ran) {
     // No rovannouncement found for incoming rovannouncement prefix
     if (search == loc_rib->end()) {
         loc_rib->insert(ann.prefix, ann);
-        // Inverse results need to be computed also with announcements from monitors
-        if (inverse_results != NULL) {
-            auto set = inverse_results->find(
-                std::pair<Prefix<>,uint32_t>(ann.prefix, ann.origin));
-            if (set != inverse_results->end()) {
-                set->second->erase(asn);
-            }
-        }
     // Tiebraker for equal priority between old and new ann (but not if they're the same ann)
     } else if (ann.priority == search->priority && ann != *search) {
         // Random tiebraker
@@ -113,13 +105,6 @@ void ROVppAS::process_announcement(ROVppAnnouncement &ann, bool ran) {
         // TODO This sets first come, first kept
         // value = false;
         if (value) {
-            if(inverse_results != NULL) {
-                // Update inverse results
-                swap_inverse_result(
-                    std::pair<Prefix<>, uint32_t>(search->prefix, search->origin),
-                    std::pair<Prefix<>, uint32_t>(ann.prefix, ann.origin));
-            }
-
             // Use the new rovannouncement
             if(depref_anns != NULL) 
                 depref_anns->insert(search);
@@ -133,13 +118,6 @@ void ROVppAS::process_announcement(ROVppAnnouncement &ann, bool ran) {
 
     // Otherwise check new announcements priority for best path selection
     } else if (ann.priority > search->priority) {
-        if(inverse_results != NULL) {
-            // Update inverse results
-            swap_inverse_result(
-                std::pair<Prefix<>, uint32_t>(search->prefix, search->origin),
-                std::pair<Prefix<>, uint32_t>(ann.prefix, ann.origin));
-        }
-
         if(depref_anns != NULL)
             depref_anns->insert(search);
 
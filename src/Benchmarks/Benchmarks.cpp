@@ -0,0 +1,60 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#ifdef RUN_BENCHMARKS
+#include <map>
+#include <functional>
+
+#include "Benchmarks/Benchmarks.h"
+
+/** Run the benchmarks named on the command line, or all of them if none are named.
+ */
+int main(int argc, char *argv[]) {
+    std::map<std::string, std::function<void()>> benchmarks = {
+        {"prefix_announcement_map", benchmark_prefix_announcement_map},
+        {"rank_order", benchmark_rank_order},
+        {"graph_preprocessing", benchmark_graph_preprocessing},
+        {"path_decoding", benchmark_path_decoding},
+        {"result_sinks", benchmark_result_sinks},
+        {"result_formatter", benchmark_result_formatter}
+    };
+
+    std::vector<std::string> selected(argv + 1, argv + argc);
+    if (selected.empty()) {
+        for (auto &benchmark : benchmarks) {
+            selected.push_back(benchmark.first);
+        }
+    }
+
+    for (auto &name : selected) {
+        auto search = benchmarks.find(name);
+        if (search == benchmarks.end()) {
+            std::cerr << "Unknown benchmark: " << name << std::endl;
+            return 1;
+        }
+        std::cout << "***** " << name << " *****" << std::endl;
+        search->second();
+    }
+    return 0;
+}
+#endif // RUN_BENCHMARKS
@@ -0,0 +1,96 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include <random>
+#include <iomanip>
+
+#include "Benchmarks/Benchmarks.h"
+#include "Graphs/ASGraph.h"
+
+/** Build a random graph shaped like the CAIDA relationships: two customer-provider links 
+ *  per AS on average, with providers drawn mostly from the top, four peer links per AS, 
+ *  and a few customer-provider cycles for tarjan to find.
+ */
+static void build_caida_like_graph(ASGraph<> &graph, uint32_t num_ases) {
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<double> dist(0, 1);
+    // Only the topology is timed, keep the RIBs small
+    graph.max_block_prefix_id = 1;
+    for (uint32_t asn = 2; asn <= num_ases; asn++) {
+        uint32_t num_providers = gen() % 3 + 1;
+        for (uint32_t i = 0; i < num_providers; i++) {
+            double u = dist(gen);
+            uint32_t provider = 1 + (uint32_t) ((asn - 1) * u * u);
+            graph.add_relationship(asn, provider, AS_REL_PROVIDER);
+            graph.add_relationship(provider, asn, AS_REL_CUSTOMER);
+        }
+    }
+    for (uint32_t i = 0; i < num_ases / 1000; i++) {
+        uint32_t customer = gen() % num_ases + 1;
+        auto *as = graph.ases->find(customer)->second;
+        if (as->providers->empty()) {
+            continue;
+        }
+        uint32_t provider = *as->providers->begin();
+        graph.add_relationship(provider, customer, AS_REL_PROVIDER);
+        graph.add_relationship(customer, provider, AS_REL_CUSTOMER);
+    }
+    for (uint32_t i = 0; i < 4 * num_ases; i++) {
+        uint32_t a = gen() % num_ases + 1;
+        uint32_t b = gen() % num_ases + 1;
+        auto *as_a = graph.ases->find(a)->second;
+        if (a == b || as_a->providers->count(b) || as_a->customers->count(b)) {
+            continue;
+        }
+        graph.add_relationship(a, b, AS_REL_PEER);
+        graph.add_relationship(b, a, AS_REL_PEER);
+    }
+}
+
+/** Time the graph preprocessing steps on a CAIDA sized graph and on one ten times larger.
+ */
+void benchmark_graph_preprocessing() {
+    std::cout << std::setw(10) << "ASes" << std::setw(12) << "supernodes"
+              << std::setw(12) << "tarjan ms" << std::setw(14) << "combine ms" << std::setw(12) << "ranks ms" << std::setw(12) << "index ms" << std::endl;
+
+    for (uint32_t num_ases : {75000, 750000}) {
+        ASGraph<> graph = ASGraph<>(false, false);
+        build_caida_like_graph(graph, num_ases);
+
+        double tarjan = time_best_of(1, [&]() { graph.tarjan(); });
+        double combine = time_best_of(1, [&]() { graph.combine_components(); });
+        double ranks = time_best_of(1, [&]() { graph.decide_ranks(); });
+        // decide_ranks ends by indexing the graph, time that on its own
+        double index = time_best_of(1, [&]() { graph.index_ases(); });
+
+        uint32_t supernodes = 0;
+        for (auto const& component : *graph.components) {
+            if (component->size() > 1) {
+                supernodes++;
+            }
+        }
+        std::cout << std::fixed << std::setprecision(3)
+                  << std::setw(10) << num_ases << std::setw(12) << supernodes
+                  << std::setw(12) << tarjan * 1000 << std::setw(14) << combine * 1000 << std::setw(12) << (ranks - index) * 1000 << std::setw(12) << index * 1000 << std::endl;
+    }
+}
@@ -0,0 +1,117 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include <random>
+#include <iomanip>
+
+#include "Benchmarks/Benchmarks.h"
+#include "Extrapolators/Extrapolator.h"
+
+/** A row of the announcements table, as its fields arrive from libpqxx.
+ */
+struct BenchmarkRow {
+    std::string host;
+    std::string netmask;
+    std::string as_path;
+    std::string time;
+};
+
+/** Make rows with paths of one to ten hops, some of them prepended, over ASNs mostly in the graph.
+ */
+static std::vector<BenchmarkRow> make_rows(uint32_t num_rows, uint32_t num_ases) {
+    std::mt19937 gen(1);
+    std::vector<BenchmarkRow> rows(num_rows);
+    for (BenchmarkRow &row : rows) {
+        row.host = std::to_string(gen() % 224) + "." + std::to_string(gen() % 256) + "." + std::to_string(gen() % 256) + ".0";
+        row.netmask = "255.255.255.0";
+        row.time = std::to_string(1583020800 + gen() % 86400);
+        row.as_path = "{";
+        uint32_t hops = gen() % 10 + 1;
+        for (uint32_t hop = 0; hop < hops; hop++) {
+            uint32_t asn = gen() % (num_ases + num_ases / 100) + 1;
+            uint32_t repeats = gen() % 8 == 0 ? gen() % 3 + 2 : 1;
+            for (uint32_t i = 0; i < repeats; i++) {
+                row.as_path += (row.as_path.size() > 1 ? "," : "") + std::to_string(asn);
+            }
+        }
+        row.as_path += "}";
+    }
+    return rows;
+}
+
+/** Compare decoding rows with parse_path and find_loop against PathDecoder.
+ */
+void benchmark_path_decoding() {
+    const uint32_t num_rows = 500000;
+    const uint32_t num_ases = 70000;
+    const int runs = 5;
+
+    Extrapolator<> e = Extrapolator<>(DEFAULT_RANDOM_TIEBRAKING, DEFAULT_STORE_RESULTS, DEFAULT_STORE_INVERT_RESULTS, DEFAULT_STORE_DEPREF_RESULTS, 
+                                        ANNOUNCEMENTS_TABLE, RESULTS_TABLE, INVERSE_RESULTS_TABLE, DEPREF_RESULTS_TABLE, FULL_PATH_RESULTS_TABLE, 
+                                        DEFAULT_QUERIER_CONFIG_SECTION, DEFAULT_ITERATION_SIZE, -1, DEFAULT_MH_MODE, DEFAULT_ORIGIN_ONLY, NULL, DEFAULT_MAX_THREADS, DEFAULT_SELECT_BLOCK_ID);
+    std::unordered_map<uint32_t, uint32_t> asn_to_index;
+    for (uint32_t asn = 1; asn <= num_ases; asn++) {
+        asn_to_index[asn] = asn - 1;
+    }
+    std::vector<BenchmarkRow> rows = make_rows(num_rows, num_ases);
+
+    // Sum of what was decoded, so neither loop is optimized away
+    uint64_t checksum[2] = {0, 0};
+    double strings = time_best_of(runs, [&]() {
+        checksum[0] = 0;
+        for (BenchmarkRow &row : rows) {
+            Prefix<> prefix(row.host, row.netmask, 0, 0);
+            std::vector<uint32_t> *as_path = e.parse_path(row.as_path);
+            if (!e.find_loop(as_path)) {
+                int64_t timestamp = std::stol(row.time);
+                checksum[0] += prefix.addr + as_path->size() + timestamp;
+            }
+            delete as_path;
+        }
+    });
+    PathDecoder decoder;
+    double decoded = time_best_of(runs, [&]() {
+        checksum[1] = 0;
+        for (BenchmarkRow &row : rows) {
+            uint32_t addr, netmask;
+            int64_t timestamp;
+            PathDecoder::parse_ipv4(row.host.c_str(), addr);
+            PathDecoder::parse_ipv4(row.netmask.c_str(), netmask);
+            Prefix<> prefix(addr, netmask, 0, 0);
+            if (decoder.decode_path(row.as_path.c_str(), asn_to_index)) {
+                PathDecoder::parse_int64(row.time.c_str(), timestamp);
+                checksum[1] += prefix.addr + decoder.path.size() + timestamp;
+            }
+        }
+    });
+    if (checksum[0] != checksum[1]) {
+        std::cerr << "Decoders disagree" << std::endl;
+    }
+
+    std::cout << std::setw(14) << "decoder" << std::setw(16) << "rows/sec" << std::endl;
+    std::cout << std::fixed << std::setprecision(0)
+              << std::setw(14) << "parse_path" << std::setw(16) << num_rows / strings << std::endl
+              << std::setw(14) << "PathDecoder" << std::setw(16) << num_rows / decoded 
+              << std::setprecision(2) << "  (" << strings / decoded << "x)" << std::endl;
+    std::cout << "Best of " << runs << " runs, " << num_rows << " rows, " << num_ases << " ASes in the graph" << std::endl;
+}
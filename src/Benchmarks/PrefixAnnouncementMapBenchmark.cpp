@@ -0,0 +1,138 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include <random>
+#include <iomanip>
+
+#include "Benchmarks/Benchmarks.h"
+#include "PrefixAnnouncementMap.h"
+
+/** The map as it was before the occupancy bitmap: every call is virtual, and iteration 
+ *  checks the timestamp of each slot to skip the empty ones.
+ */
+class ScanningAnnouncementMap {
+public:
+    std::vector<Announcement<>> announcements;
+
+    ScanningAnnouncementMap(size_t capacity) : announcements(capacity) { }
+    virtual ~ScanningAnnouncementMap() { }
+
+    virtual size_t next_filled(size_t index) {
+        while (index < announcements.size() && announcements.at(index).tstamp == -1) {
+            index++;
+        }
+        return index;
+    }
+
+    virtual const Announcement<>& at(size_t index) { 
+        return announcements.at(index); 
+    }
+
+    virtual void insert(const Announcement<> &ann) {
+        announcements.at(ann.prefix.block_id) = ann;
+    }
+
+    virtual void clear() {
+        for (auto &ann : announcements) {
+            ann.tstamp = -1;
+        }
+    }
+};
+
+// Keep the compiler from devirtualizing the baseline
+__attribute__((noinline)) static ScanningAnnouncementMap* new_scanning_map(size_t capacity) {
+    return new ScanningAnnouncementMap(capacity);
+}
+
+/** Compare iterating and clearing RIBs with the occupancy bitmap against scanning every slot,
+ *  for RIBs of DEFAULT_ITERATION_SIZE slots from sparse to full.
+ */
+void benchmark_prefix_announcement_map() {
+    const size_t capacity = 50000;
+    const int passes = 200;
+
+    std::cout << std::setw(8) << "filled" 
+              << std::setw(16) << "scan iter ms" << std::setw(16) << "bitmap iter ms" << std::setw(10) << "speedup"
+              << std::setw(16) << "scan clear ms" << std::setw(17) << "bitmap clear ms" << std::setw(10) << "speedup" << std::endl;
+
+    for (double fill : {0.001, 0.01, 0.1, 0.5, 1.0}) {
+        ScanningAnnouncementMap *scanning = new_scanning_map(capacity);
+        PrefixAnnouncementMap<Announcement<>> bitmap(capacity);
+
+        std::vector<Announcement<>> anns;
+        std::mt19937 gen(1);
+        std::uniform_real_distribution<double> dist(0, 1);
+        for (uint32_t i = 0; i < capacity; i++) {
+            if (dist(gen) < fill) {
+                Prefix<> p(i << 8, 0xFFFFFF00, i, i);
+                anns.push_back(Announcement<>(i, p, i));
+            }
+        }
+        auto fill_both = [&]() {
+            for (auto &ann : anns) {
+                scanning->insert(ann);
+                bitmap.insert(ann.prefix, ann);
+            }
+        };
+        fill_both();
+
+        uint64_t scan_sum = 0, bitmap_sum = 0;
+        double scan_iter = time_best_of(5, [&]() {
+            uint64_t sum = 0;
+            for (int pass = 0; pass < passes; pass++) {
+                for (size_t i = scanning->next_filled(0); i < capacity; i = scanning->next_filled(i + 1)) {
+                    sum += scanning->at(i).origin;
+                }
+            }
+            scan_sum = sum;
+        });
+        double bitmap_iter = time_best_of(5, [&]() {
+            uint64_t sum = 0;
+            for (int pass = 0; pass < passes; pass++) {
+                for (auto &ann : bitmap) {
+                    sum += ann.origin;
+                }
+            }
+            bitmap_sum = sum;
+        });
+        if (scan_sum != bitmap_sum) {
+            std::cerr << "Iteration results differ" << std::endl;
+        }
+
+        // Clearing is timed once per refill
+        double scan_clear = 0, bitmap_clear = 0;
+        for (int pass = 0; pass < passes; pass++) {
+            fill_both();
+            scan_clear += time_best_of(1, [&]() { scanning->clear(); });
+            bitmap_clear += time_best_of(1, [&]() { bitmap.clear(); });
+        }
+
+        std::cout << std::fixed << std::setprecision(3)
+                  << std::setw(8) << anns.size()
+                  << std::setw(16) << scan_iter * 1000 << std::setw(16) << bitmap_iter * 1000 << std::setw(10) << scan_iter / bitmap_iter
+                  << std::setw(16) << scan_clear * 1000 << std::setw(17) << bitmap_clear * 1000 << std::setw(10) << scan_clear / bitmap_clear 
+                  << std::endl;
+        delete scanning;
+    }
+    std::cout << "Times are totals over " << passes << " passes, RIB capacity " << capacity << std::endl;
+}
@@ -0,0 +1,138 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include <random>
+#include <iomanip>
+#include <algorithm>
+#include <cstdlib>
+
+#include "Benchmarks/Benchmarks.h"
+#include "Extrapolators/Extrapolator.h"
+
+/** Build a layered random graph whose ASNs are shuffled, so that ASN order says nothing 
+ *  about where an AS sits in the topology. Providers are drawn mostly from the top of the 
+ *  graph, as in the real one.
+ */
+static void build_shuffled_graph(Extrapolator<> &e, uint32_t num_ases, uint32_t num_prefixes) {
+    std::mt19937 gen(1);
+    std::vector<uint32_t> asns(num_ases);
+    for (uint32_t i = 0; i < num_ases; i++) {
+        asns[i] = i + 1;
+    }
+    std::shuffle(asns.begin(), asns.end(), gen);
+
+    std::uniform_real_distribution<double> dist(0, 1);
+    e.graph->max_block_prefix_id = num_prefixes;
+    for (uint32_t position = 1; position < num_ases; position++) {
+        uint32_t num_providers = gen() % 3 + 1;
+        for (uint32_t i = 0; i < num_providers; i++) {
+            double u = dist(gen);
+            uint32_t provider = (uint32_t) (position * u * u);
+            e.graph->add_relationship(asns[position], asns[provider], AS_REL_PROVIDER);
+            e.graph->add_relationship(asns[provider], asns[position], AS_REL_CUSTOMER);
+        }
+    }
+    for (uint32_t i = 0; i < num_ases / 4; i++) {
+        uint32_t a = asns[gen() % num_ases];
+        uint32_t b = asns[gen() % num_ases];
+        auto *as_a = e.graph->ases->find(a)->second;
+        if (a == b || as_a->providers->count(b) || as_a->customers->count(b)) {
+            continue;
+        }
+        e.graph->add_relationship(a, b, AS_REL_PEER);
+        e.graph->add_relationship(b, a, AS_REL_PEER);
+    }
+    e.graph->decide_ranks();
+}
+
+/** Seed every prefix at one or two origins, the same ones on every call.
+ */
+static void seed_prefixes(Extrapolator<> &e, uint32_t num_ases, uint32_t num_prefixes) {
+    std::mt19937 gen(2);
+    for (uint32_t prefix_id = 0; prefix_id < num_prefixes; prefix_id++) {
+        Prefix<> p = Prefix<>(0x0A000000 + (prefix_id << 8), 0xFFFFFF00, prefix_id, prefix_id);
+        uint32_t num_origins = gen() % 2 + 1;
+        for (uint32_t i = 0; i < num_origins; i++) {
+            std::vector<uint32_t> as_path = {(uint32_t) (gen() % num_ases + 1)};
+            e.give_ann_to_as_path(&as_path, p);
+        }
+    }
+}
+
+/** Mean distance in the index between an AS and its customers, a stand in for how far apart
+ *  in memory the RIBs touched together are.
+ */
+static double mean_customer_distance(Extrapolator<> &e) {
+    uint64_t total = 0, edges = 0;
+    for (AS<> *as : *e.graph->ases_by_index) {
+        for (uint32_t index : as->customer_indices) {
+            total += std::abs((int64_t) index - (int64_t) as->graph_index);
+            edges++;
+        }
+    }
+    return edges ? (double) total / edges : 0;
+}
+
+/** Compare propagation over the same graph with ranks laid out in ASN order and breadth first.
+ */
+void benchmark_rank_order() {
+    const uint32_t num_ases = 20000;
+    const uint32_t num_prefixes = 256;
+    const int runs = 5;
+
+    std::cout << std::setw(8) << "order" << std::setw(20) << "customer distance" 
+              << std::setw(16) << "propagate ms" << std::endl;
+
+    double asn_time = 0;
+    for (bool bfs : {false, true}) {
+        Extrapolator<> e = Extrapolator<>(DEFAULT_RANDOM_TIEBRAKING, DEFAULT_STORE_RESULTS, DEFAULT_STORE_INVERT_RESULTS, DEFAULT_STORE_DEPREF_RESULTS, 
+                                            ANNOUNCEMENTS_TABLE, RESULTS_TABLE, INVERSE_RESULTS_TABLE, DEPREF_RESULTS_TABLE, FULL_PATH_RESULTS_TABLE, 
+                                            DEFAULT_QUERIER_CONFIG_SECTION, DEFAULT_ITERATION_SIZE, -1, DEFAULT_MH_MODE, DEFAULT_ORIGIN_ONLY, NULL, DEFAULT_MAX_THREADS, DEFAULT_SELECT_BLOCK_ID, 
+                                            DEFAULT_PARALLEL_PROPAGATION, DEFAULT_PULL_PROPAGATION, DEFAULT_CONCURRENT_BLOCKS, bfs);
+        build_shuffled_graph(e, num_ases, num_prefixes);
+
+        // Seeding is not timed
+        double best = -1;
+        for (int run = 0; run < runs; run++) {
+            seed_prefixes(e, num_ases, num_prefixes);
+            double elapsed = time_best_of(1, [&]() {
+                e.propagate_up();
+                e.propagate_down();
+            });
+            e.graph->clear_announcements();
+            if (best < 0 || elapsed < best) {
+                best = elapsed;
+            }
+        }
+
+        std::cout << std::fixed << std::setprecision(3)
+                  << std::setw(8) << (bfs ? "bfs" : "asn") << std::setw(20) << mean_customer_distance(e)
+                  << std::setw(16) << best * 1000;
+        if (bfs) {
+            std::cout << "  (" << asn_time / best << "x)";
+        }
+        std::cout << std::endl;
+        asn_time = best;
+    }
+    std::cout << "Best of " << runs << " runs, " << num_ases << " ASes, " << num_prefixes << " prefixes" << std::endl;
+}
@@ -0,0 +1,114 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include <random>
+#include <iomanip>
+#include <fstream>
+#include <cstdio>
+#include <unistd.h>
+
+#include "Benchmarks/Benchmarks.h"
+#include "Announcements/Announcement.h"
+#include "ResultSinks/ResultFormatter.h"
+
+/** Address of the prefix in a slot of the block, 10.<slot>.0/24 or 2001:db8:<slot>::/48.
+ */
+static void block_prefix(uint32_t block_id, uint32_t &addr, uint32_t &netmask) {
+    addr = 0x0A000000 + (block_id << 8);
+    netmask = 0xFFFFFF00;
+}
+
+static void block_prefix(uint32_t block_id, uint128_t &addr, uint128_t &netmask) {
+    addr = ((uint128_t) 0x20010DB8 << 96) | ((uint128_t) block_id << 80);
+    netmask = ~(uint128_t) 0 << 80;
+}
+
+/** Make results rows for a block of num_prefixes prefixes spread over num_ases ASes.
+ *
+ * Each prefix has its slot in the block as its block_id, as it does in the RIBs.
+ */
+template <typename PrefixType>
+static std::vector<std::pair<uint32_t, Announcement<PrefixType>>> make_block_results(uint32_t num_rows, uint32_t num_prefixes, uint32_t num_ases) {
+    std::mt19937 gen(1);
+    std::vector<std::pair<uint32_t, Announcement<PrefixType>>> rows;
+    rows.reserve(num_rows);
+    for (uint32_t i = 0; i < num_rows; i++) {
+        uint32_t block_id = gen() % num_prefixes;
+        PrefixType addr;
+        PrefixType netmask;
+        block_prefix(block_id, addr, netmask);
+        Prefix<PrefixType> prefix(addr, netmask, block_id + 100000, block_id);
+        rows.push_back(std::make_pair(gen() % num_ases + 1, 
+                                      Announcement<PrefixType>(gen() % num_ases + 1, prefix, gen() % num_ases + 1, 1583020800 + gen() % 86400)));
+    }
+    return rows;
+}
+
+/** Time the ofstream rows written by to_csv against the formatter, both written to a file.
+ */
+template <typename PrefixType>
+static void compare_formatters(std::string family, uint32_t num_rows, int runs) {
+    std::vector<std::pair<uint32_t, Announcement<PrefixType>>> rows = make_block_results<PrefixType>(num_rows, 50000, 70000);
+    std::string file_name = "/dev/shm/bgp-bench-" + std::to_string(getpid()) + ".csv";
+
+    double ofstream_time = time_best_of(runs, [&]() {
+        std::ofstream outfile(file_name);
+        for (auto &row : rows) {
+            outfile << row.first << ',';
+            row.second.to_csv(outfile);
+        }
+    });
+
+    double formatter_time = time_best_of(runs, [&]() {
+        ResultFormatter<PrefixType> formatter;
+        FILE *outfile = fopen(file_name.c_str(), "w");
+        for (auto &row : rows) {
+            const Announcement<PrefixType> &ann = row.second;
+            formatter.add_result(row.first, ann.prefix, ann.origin, ann.received_from_asn, ann.tstamp);
+            if (formatter.full()) {
+                fwrite(formatter.data(), 1, formatter.size(), outfile);
+                formatter.clear();
+            }
+        }
+        fwrite(formatter.data(), 1, formatter.size(), outfile);
+        fclose(outfile);
+    });
+    std::remove(file_name.c_str());
+
+    std::cout << std::fixed << std::setprecision(0) 
+              << std::setw(16) << family + " ofstream" << std::setw(16) << num_rows / ofstream_time << std::endl
+              << std::setw(16) << family + " formatter" << std::setw(16) << num_rows / formatter_time
+              << std::setprecision(2) << "  (" << ofstream_time / formatter_time << "x)" << std::endl;
+}
+
+/** Compare the rate one results thread formats csv rows with iostreams against the ResultFormatter.
+ */
+void benchmark_result_formatter() {
+    const uint32_t num_rows = 2000000;
+    const int runs = 3;
+
+    std::cout << std::setw(16) << "writer" << std::setw(16) << "rows/sec" << std::endl;
+    compare_formatters<uint32_t>("IPv4", num_rows, runs);
+    compare_formatters<uint128_t>("IPv6", num_rows, runs);
+    std::cout << "Best of " << runs << " runs, " << num_rows << " rows from a block of 50000 prefixes on one thread" << std::endl;
+}
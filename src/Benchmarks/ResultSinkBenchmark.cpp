@@ -0,0 +1,140 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include <random>
+#include <iomanip>
+#include <fstream>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "Benchmarks/Benchmarks.h"
+#include "Announcements/Announcement.h"
+#include "SQLQueriers/CopyBuffer.h"
+#include "ResultSinks/FileResultSink.h"
+
+/** Make results rows for num_prefixes prefixes spread over num_ases ASes.
+ */
+static std::vector<std::pair<uint32_t, Announcement<>>> make_results(uint32_t num_rows, uint32_t num_prefixes, uint32_t num_ases) {
+    std::mt19937 gen(1);
+    std::vector<std::pair<uint32_t, Announcement<>>> rows;
+    rows.reserve(num_rows);
+    for (uint32_t i = 0; i < num_rows; i++) {
+        uint32_t prefix_id = gen() % num_prefixes;
+        Prefix<> prefix(0x0A000000 + (prefix_id << 8), 0xFFFFFF00, prefix_id, 0);
+        rows.push_back(std::make_pair(gen() % num_ases + 1, 
+                                      Announcement<>(gen() % num_ases + 1, prefix, gen() % num_ases + 1, 1583020800 + gen() % 86400)));
+    }
+    return rows;
+}
+
+/** Size of a file in bytes.
+ */
+static off_t file_size(std::string file_name) {
+    struct stat st;
+    return stat(file_name.c_str(), &st) == 0 ? st.st_size : 0;
+}
+
+/** Compare the rate one results thread produces rows with the COPY paths against the file sinks.
+ *
+ * The csv row is how save_results writes the csvs in /dev/shm which the server then COPYs, 
+ * and the COPY buffer is the client side of --stream-results. Neither includes the time the 
+ * database takes to load the rows, so they are upper bounds for the COPY path.
+ */
+void benchmark_result_sinks() {
+    const uint32_t num_rows = 2000000;
+    const uint32_t num_prefixes = 50000;
+    const uint32_t num_ases = 70000;
+    const int runs = 3;
+
+    std::vector<std::pair<uint32_t, Announcement<>>> rows = make_results(num_rows, num_prefixes, num_ases);
+    std::string dir = "/dev/shm/bgp-bench-" + std::to_string(getpid());
+    mkdir(dir.c_str(), 0777);
+
+    std::vector<std::string> names;
+    std::vector<double> times;
+    std::vector<off_t> sizes;
+
+    // The csvs copied by the server
+    std::string csv_name = dir + "/csv_0_0.csv";
+    times.push_back(time_best_of(runs, [&]() {
+        std::ofstream outfile(csv_name);
+        for (auto &row : rows) {
+            outfile << row.first << ',';
+            row.second.to_csv(outfile);
+        }
+    }));
+    names.push_back("ofstream csv");
+    sizes.push_back(file_size(csv_name));
+    std::remove(csv_name.c_str());
+
+    // Binary COPY FROM STDIN
+    size_t copy_size = 0;
+    times.push_back(time_best_of(runs, [&]() {
+        CopyBuffer buffer;
+        for (auto &row : rows) {
+            const Announcement<> &ann = row.second;
+            buffer.begin_row(6);
+            buffer.add_bigint(row.first);
+            buffer.add_inet(ann.prefix);
+            buffer.add_bigint(ann.origin);
+            buffer.add_bigint(ann.received_from_asn);
+            buffer.add_bigint(ann.tstamp);
+            buffer.add_bigint(ann.prefix.id);
+        }
+        buffer.end();
+        copy_size = buffer.data.size();
+    }));
+    names.push_back("COPY binary");
+    sizes.push_back(copy_size);
+
+    // File sinks
+    for (int format = 0; format < 4; format++) {
+        bool binary = format >= 2;
+        bool compress = format % 2 == 1;
+        FileResultSink<> sink(dir, binary, compress);
+        std::string file_name;
+        times.push_back(time_best_of(runs, [&]() {
+            FileResultShard<> *shard = (FileResultShard<>*) sink.open_shard("results", false, 0, 0);
+            for (auto &row : rows) {
+                const Announcement<> &ann = row.second;
+                shard->add_result(row.first, ann.prefix, ann.origin, ann.received_from_asn, ann.tstamp);
+            }
+            shard->close();
+            file_name = shard->file_name;
+            delete shard;
+        }));
+        names.push_back(std::string("sink ") + (binary ? "binary" : "csv") + (compress ? ".gz" : ""));
+        sizes.push_back(file_size(file_name));
+        std::remove(file_name.c_str());
+    }
+    rmdir(dir.c_str());
+
+    std::cout << std::setw(16) << "writer" << std::setw(16) << "rows/sec" << std::setw(12) << "MB" << std::endl;
+    for (size_t i = 0; i < names.size(); i++) {
+        std::cout << std::fixed << std::setprecision(0) 
+                  << std::setw(16) << names[i] << std::setw(16) << num_rows / times[i] 
+                  << std::setprecision(1) << std::setw(12) << sizes[i] / 1e6
+                  << std::setprecision(2) << "  (" << times[0] / times[i] << "x)" << std::endl;
+    }
+    std::cout << "Best of " << runs << " runs, " << num_rows << " rows on one thread, database load time not included" << std::endl;
+}
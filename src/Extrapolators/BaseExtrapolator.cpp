@@ -34,6 +34,7 @@
 
 #include "Logger.h"
 #include "Extrapolators/BaseExtrapolator.h"
+#include "ResultSinks/ResultFormatter.h"
 
 template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
 BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::~BaseExtrapolator() {
@@ -41,6 +42,12 @@ BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::~BaseExtr
         delete graph;
     if(querier != NULL)
         delete querier;
+    if(result_sink != NULL)
+        delete result_sink;
+    if(writer_pool != NULL)
+        delete writer_pool;
+    for (SQLQuerierType *writer_querier : writer_queriers)
+        delete writer_querier;
     sem_destroy(&worker_thread_count);
     sem_destroy(&csvs_written);
 }
@@ -82,15 +89,15 @@ bool BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::find
 
 template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
 void BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::propagate_up() {
-    size_t levels = graph->ases_by_rank->size();
+    size_t levels = graph->ranks_by_index->size();
     // Propagate to providers
     for (size_t level = 0; level < levels; level++) {
-        for (uint32_t asn : *graph->ases_by_rank->at(level)) {
-            auto search = graph->ases->find(asn);
-            search->second->process_announcements(random_tiebraking);
-            bool is_empty = search->second->all_anns->empty();
+        for (uint32_t index : graph->ranks_by_index->at(level)) {
+            ASType *as = graph->as_at(index);
+            as->process_announcements(random_tiebraking);
+            bool is_empty = as->all_anns->empty();
             if (!is_empty) {
-                send_all_announcements(asn, true, false, false);
+                send_all_announcements(as->asn, true, false, false);
             }
         }
     }
@@ -99,12 +106,12 @@ void BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::prop
     // all ASes may not have processed all incoming announcements after the function completes.
     // Those announcements will be processed after propagate_down()
     for (size_t level = 0; level < levels; level++) {
-        for (uint32_t asn : *graph->ases_by_rank->at(level)) {
-            auto search = graph->ases->find(asn);
-            search->second->process_announcements(random_tiebraking);
-            bool is_empty = search->second->all_anns->empty();
+        for (uint32_t index : graph->ranks_by_index->at(level)) {
+            ASType *as = graph->as_at(index);
+            as->process_announcements(random_tiebraking);
+            bool is_empty = as->all_anns->empty();
             if (!is_empty) {
-                send_all_announcements(asn, false, true, false);
+                send_all_announcements(as->asn, false, true, false);
             }
         }
     }
@@ -113,14 +120,14 @@ void BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::prop
 
 template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
 void BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::propagate_down() {
-    size_t levels = graph->ases_by_rank->size();
+    size_t levels = graph->ranks_by_index->size();
     for (size_t level = levels-1; level-- > 0;) {
-        for (uint32_t asn : *graph->ases_by_rank->at(level)) {
-            auto search = graph->ases->find(asn);
-            search->second->process_announcements(random_tiebraking);
-            bool is_empty = search->second->all_anns->empty();
+        for (uint32_t index : graph->ranks_by_index->at(level)) {
+            ASType *as = graph->as_at(index);
+            as->process_announcements(random_tiebraking);
+            bool is_empty = as->all_anns->empty();
             if (!is_empty) {
-                send_all_announcements(asn, false, false, true);
+                send_all_announcements(as->asn, false, false, true);
             }
         }
     }
@@ -128,101 +135,242 @@ void BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::prop
 
 template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
 void BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::save_results_thread(int iteration, int thread_num, int num_threads){
+    if (result_sink != NULL) {
+        sink_results_thread(iteration, thread_num, num_threads);
+        return;
+    }
     // Decrement semaphore to limit the number of concurrent threads
     sem_wait(&worker_thread_count);
-    int counter = thread_num;
-    std::ofstream outfile;
+    auto start = std::chrono::high_resolution_clock::now();
+    ResultFormatter<ResultPrefixType> rows;
+    FILE *outfile = NULL;
+    // Rows are written out whenever the buffer fills, and once more at the end
+    auto write_rows = [&rows, &outfile]() {
+        if (outfile != NULL) {
+            fwrite(rows.data(), 1, rows.size(), outfile);
+        }
+        rows.clear();
+    };
     std::string file_name = "/dev/shm/bgp/" + std::to_string(iteration) + "_" + std::to_string(thread_num) + ".csv";
     std::string depref_name = "/dev/shm/bgp/depref" + std::to_string(iteration) + "_" + std::to_string(thread_num) + ".csv";
     std::string inverse_file_name = "/dev/shm/bgp/inverse" + std::to_string(iteration) + "_" + std::to_string(thread_num) + ".csv";
 
     // Handle standard results
     if (store_results) {
-        outfile.open(file_name);
-        for (auto &as : *graph->ases){
-            if (counter++ % num_threads == 0) {
-                as.second->stream_announcements(outfile);
+        outfile = fopen(file_name.c_str(), "w");
+        for (size_t i = save_as_bounds[thread_num]; i < save_as_bounds[thread_num + 1]; i++) {
+            for (auto &ann : *save_ases[i]->saved_anns) {
+                rows.add_result(save_ases[i]->asn, ann.prefix, ann.origin, ann.received_from_asn, ann.tstamp);
+                if (rows.full()) {
+                    write_rows();
+                }
             }
         }
-        outfile.close();
+        write_rows();
+        if (outfile != NULL) {
+            fclose(outfile);
+        }
     }
     
     // Handle inverse results
     if (store_invert_results) {
-        outfile.open(inverse_file_name);
-        for (auto po : *graph->inverse_results){
-            // The results are divided into num_threads CSVs. For example, with 
-            // four threads, this loop will save every fourth item in the loop.
-            if (counter++ % num_threads == 0) {
-                for (uint32_t asn : *po.second) {
-                    outfile << asn << ','
-                            << po.first.first.to_cidr() << ','
-                            << po.first.first.id << ','
-                            << po.first.second << '\n';
+        outfile = fopen(inverse_file_name.c_str(), "w");
+        auto *inverse = graph->saved_inverse_results;
+        for (size_t i = save_inverse_bounds[thread_num]; i < save_inverse_bounds[thread_num + 1]; i++) {
+            auto &po = inverse->at(i);
+            inverse->for_each_asn(i, [&](uint32_t asn) {
+                rows.add_inverse(asn, po.first, po.second);
+                if (rows.full()) {
+                    write_rows();
                 }
-            }
+            });
         }
-        outfile.close();
-    
-    // Handle standard results
-    } else {
-        for (auto &as : *graph->ases){
-            if (counter++ % num_threads == 0) {
-                as.second->stream_announcements(outfile);
-            }
+        write_rows();
+        if (outfile != NULL) {
+            fclose(outfile);
         }
-        outfile.close();
-
     }
     
     // Handle depref results
     if (store_depref_results) {
-        outfile.open(depref_name);
-        for (auto &as : *graph->ases) {
-            if (counter++ % num_threads == 0) {
-                as.second->stream_depref(outfile);
+        outfile = fopen(depref_name.c_str(), "w");
+        for (size_t i = save_as_bounds[thread_num]; i < save_as_bounds[thread_num + 1]; i++) {
+            if (save_ases[i]->saved_depref_anns != NULL) {
+                for (auto &ann : *save_ases[i]->saved_depref_anns) {
+                    rows.add_result(save_ases[i]->asn, ann.prefix, ann.origin, ann.received_from_asn, ann.tstamp);
+                    if (rows.full()) {
+                        write_rows();
+                    }
+                }
             }
         }
-        outfile.close();
+        write_rows();
+        if (outfile != NULL) {
+            fclose(outfile);
+        }
     }
 
     // Csvs are saved, release the semaphore 
     sem_post(&csvs_written);
+    auto written = std::chrono::high_resolution_clock::now();
 
-    // Need a copy of the querier to make a new db connection to avoid resource conflicts 
-    SQLQuerierType querier_copy(*querier);
-    querier_copy.open_connection();
+    // Each thread copies over its own connection to avoid resource conflicts 
+    SQLQuerierType *writer_querier = writer_queriers.at(thread_num);
     
     // Handle inverse results
     if (store_invert_results) {
-        querier_copy.copy_inverse_results_to_db(file_name);
+        writer_querier->copy_inverse_results_to_db(inverse_file_name);
         std::remove(inverse_file_name.c_str());
-    
-    // Handle standard results
     }
+
+    // Handle standard results
     if (store_results) {
-        querier_copy.copy_results_to_db(file_name);
+        writer_querier->copy_results_to_db(file_name);
         std::remove(file_name.c_str());
     }
     
     // Handle depref results
     if (store_depref_results) {
-        querier_copy.copy_depref_to_db(depref_name);
+        writer_querier->copy_depref_to_db(depref_name);
         std::remove(depref_name.c_str());
     }
 
     // Handle full_path results
     if (full_path_asns != NULL) {
-        for (uint32_t asn : *full_path_asns){
-            if (counter++ % num_threads == 0) {
-                this->save_results_at_asn(asn);
+        for (size_t i = save_full_path_bounds[thread_num]; i < save_full_path_bounds[thread_num + 1]; i++) {
+            this->save_results_at_asn(full_path_asns->at(i), writer_querier, iteration);
+        }
+    }
+
+    std::chrono::duration<double> w = written - start;
+    std::chrono::duration<double> e = std::chrono::high_resolution_clock::now() - start;
+    BOOST_LOG_TRIVIAL(debug) << "Writer " << thread_num << " of iteration " << iteration << " saved " 
+                             << save_as_bounds[thread_num + 1] - save_as_bounds[thread_num] << " ASes in " 
+                             << w.count() << "s, " << e.count() << "s with copying";
+    sem_post(&worker_thread_count);
+
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
+void BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::sink_results_thread(int iteration, int thread_num, int num_threads){
+    // Decrement semaphore to limit the number of concurrent threads
+    sem_wait(&worker_thread_count);
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<ResultShard<ResultPrefixType>*> shards;
+
+    // Handle standard results
+    if (store_results) {
+        ResultShard<ResultPrefixType> *shard = result_sink->open_shard(querier->results_table, false, iteration, thread_num);
+        for (size_t i = save_as_bounds[thread_num]; i < save_as_bounds[thread_num + 1]; i++) {
+            for (auto &ann : *save_ases[i]->saved_anns) {
+                shard->add_result(save_ases[i]->asn, ann.prefix, ann.origin, ann.received_from_asn, ann.tstamp);
             }
         }
+        shards.push_back(shard);
+    }
+
+    // Handle inverse results
+    if (store_invert_results) {
+        ResultShard<ResultPrefixType> *shard = result_sink->open_shard(querier->inverse_results_table, true, iteration, thread_num);
+        auto *inverse = graph->saved_inverse_results;
+        for (size_t i = save_inverse_bounds[thread_num]; i < save_inverse_bounds[thread_num + 1]; i++) {
+            auto &po = inverse->at(i);
+            inverse->for_each_asn(i, [&](uint32_t asn) {
+                shard->add_inverse(asn, po.first, po.second);
+            });
+        }
+        shards.push_back(shard);
     }
 
-    querier_copy.close_connection();
+    // Handle depref results
+    if (store_depref_results) {
+        ResultShard<ResultPrefixType> *shard = result_sink->open_shard(querier->depref_table, false, iteration, thread_num);
+        for (size_t i = save_as_bounds[thread_num]; i < save_as_bounds[thread_num + 1]; i++) {
+            if (save_ases[i]->saved_depref_anns != NULL) {
+                for (auto &ann : *save_ases[i]->saved_depref_anns) {
+                    shard->add_result(save_ases[i]->asn, ann.prefix, ann.origin, ann.received_from_asn, ann.tstamp);
+                }
+            }
+        }
+        shards.push_back(shard);
+    }
+
+    // The RIBs are no longer needed, release the semaphore
+    sem_post(&csvs_written);
+    auto written = std::chrono::high_resolution_clock::now();
+
+    // Sinks log their own errors
+    for (ResultShard<ResultPrefixType> *shard : shards) {
+        shard->close();
+        delete shard;
+    }
+
+    // Handle full_path results
+    if (full_path_asns != NULL) {
+        SQLQuerierType *writer_querier = writer_queriers.empty() ? NULL : writer_queriers.at(thread_num);
+        for (size_t i = save_full_path_bounds[thread_num]; i < save_full_path_bounds[thread_num + 1]; i++) {
+            this->save_results_at_asn(full_path_asns->at(i), writer_querier, iteration);
+        }
+    }
+
+    std::chrono::duration<double> w = written - start;
+    std::chrono::duration<double> e = std::chrono::high_resolution_clock::now() - start;
+    BOOST_LOG_TRIVIAL(debug) << "Writer " << thread_num << " of iteration " << iteration << " saved " 
+                             << save_as_bounds[thread_num + 1] - save_as_bounds[thread_num] << " ASes in " 
+                             << w.count() << "s, " << e.count() << "s with closing the shards";
     sem_post(&worker_thread_count);
+}
 
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
+void BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::open_writer_connections(){
+    if (!writer_queriers.empty() || !results_dir.empty() || querier == NULL) {
+        return;
+    }
+    // One for each thread of writer_pool
+    int num_threads = max_workers > 1 ? max_workers : 1;
+    BOOST_LOG_TRIVIAL(info) << "Opening " << num_threads << " connections for saving results";
+    for (int i = 0; i < num_threads; i++) {
+        SQLQuerierType *writer_querier = new SQLQuerierType(*querier);
+        writer_querier->open_connection();
+        writer_queriers.push_back(writer_querier);
+    }
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
+void BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::partition_results(int num_threads){
+    // The ASes saved for the standard and depref results
+    std::vector<size_t> weights;
+    save_ases.clear();
+    save_ases.reserve(graph->ases->size());
+    weights.reserve(graph->ases->size());
+    for (auto &as : *graph->ases) {
+        size_t rows = as.second->saved_anns->size();
+        if (as.second->saved_depref_anns != NULL) {
+            rows += as.second->saved_depref_anns->size();
+        }
+        save_ases.push_back(as.second);
+        // Walking past an AS with nothing to save still costs something
+        weights.push_back(rows + 1);
+    }
+    save_as_bounds = WriterPool::balance(weights, num_threads);
+
+    weights.clear();
+    if (store_invert_results && graph->saved_inverse_results != NULL) {
+        for (size_t i = 0; i < graph->saved_inverse_results->size(); i++) {
+            weights.push_back(graph->saved_inverse_results->count(i) + 1);
+        }
+    }
+    save_inverse_bounds = WriterPool::balance(weights, num_threads);
+
+    // Tracing the paths of an AS costs about as much as it has announcements
+    weights.clear();
+    if (full_path_asns != NULL) {
+        for (uint32_t asn : *full_path_asns) {
+            auto search = graph->ases->find(asn);
+            weights.push_back(search == graph->ases->end() ? 1 : search->second->saved_anns->size() + 1);
+        }
+    }
+    save_full_path_bounds = WriterPool::balance(weights, num_threads);
 }
 
 template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
@@ -235,38 +383,65 @@ void BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::save
     if (store_depref_results) {
         BOOST_LOG_TRIVIAL(info) << "Saving Depref Results From Iteration: " << iteration;
     }
-    std::vector<std::thread> threads;
-    if (max_workers > 1) {
-        for (int i = 0; i < max_workers; i++) {
-            // Start the worker threads
-            threads.push_back(std::thread(&BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::save_results_thread, this, iteration, i, max_workers));
-        }
-        for (size_t i = 0; i < threads.size(); i++) {
-            threads[i].join();
-        }
-    } else {
-        this->save_results_thread(iteration, 0, 1);
+    if (writer_pool == NULL) {
+        writer_pool = new WriterPool(max_workers);
+    }
+    open_writer_connections();
+    int num_threads = writer_pool->size();
+    if (store_invert_results && graph->saved_inverse_results != NULL) {
+        auto start = std::chrono::high_resolution_clock::now();
+        graph->prepare_inverse_results();
+        writer_pool->run([this, num_threads](int thread_num) {
+            graph->compute_inverse_results(thread_num, num_threads);
+        });
+        std::chrono::duration<double> e = std::chrono::high_resolution_clock::now() - start;
+        BOOST_LOG_TRIVIAL(debug) << "Computed inverse results of " << graph->saved_inverse_results->size() 
+                                 << " prefix/origin pairs in " << e.count() << "s";
     }
+    partition_results(num_threads);
+    writer_pool->run([this, iteration, num_threads](int thread_num) {
+        this->save_results_thread(iteration, thread_num, num_threads);
+    });
 }
 
 template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
-void BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::save_results_at_asn(uint32_t asn){
+void BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::save_results_at_asn(uint32_t asn, SQLQuerierType *writer_querier, int iteration){
     auto search = graph->ases->find(asn); 
     if (search == graph->ases->end()) {
         // If the asn does not exist, return
         return;
     }
+    if (writer_querier == NULL) {
+        writer_querier = this->querier;
+    }
     ASType &as = *search->second;
-    std::ofstream outfile;
-    std::string file_name = "/dev/shm/bgp/as" + std::to_string(asn) + ".csv";
-    outfile.open(file_name);
-    for (auto &ann : *as.all_anns) {
+    if (this->querier->copy_from_stdin && results_dir.empty()) {
+        // The as_path column is sent as text, so these rows stay csv
+        std::ostringstream rows_stream;
+        for (auto &ann : *as.saved_anns) {
+            const AnnouncementType &a = ann;
+            rows_stream << asn << ',' << a.prefix.to_cidr() << ',' << a.origin << ',' << a.received_from_asn << ',' << a.tstamp << ',' << a.prefix.id << ",\"" << this->stream_as_path(a, asn) << "\"\n";
+        }
+        CopyBuffer rows(false);
+        rows.data = rows_stream.str();
+        writer_querier->copy_single_results_to_db(rows);
+        return;
+    }
+    // One file for each AS and block, as concurrent blocks are saved at the same time
+    std::string file_name = "/dev/shm/bgp/as" + std::to_string(asn) + "_" + std::to_string(iteration) + ".csv";
+    if (!results_dir.empty()) {
+        file_name = results_dir + "/" + this->querier->full_path_results_table + "_" + std::to_string(asn) + "_" + std::to_string(iteration) + ".csv";
+    }
+    std::ofstream outfile(file_name);
+    for (auto &ann : *as.saved_anns) {
         const AnnouncementType &a = ann;
         outfile << asn << ',' << a.prefix.to_cidr() << ',' << a.origin << ',' << a.received_from_asn << ',' << a.tstamp << ',' << a.prefix.id << ",\"" << this->stream_as_path(a, asn) << "\"\n";
     }
     outfile.close();
-    this->querier->copy_single_results_to_db(file_name);
-    std::remove(file_name.c_str());
+    if (results_dir.empty()) {
+        writer_querier->copy_single_results_to_db(file_name);
+        std::remove(file_name.c_str());
+    }
 }
 
 template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType>
@@ -278,14 +453,15 @@ std::string BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType
     // 1. The origin is the received from ASN
     // 2. The received from ASN does not exist in the graph
     // 3. A loop in the topology is detected
+    ASType *from_as;
     while (ann.origin != ann.received_from_asn && 
-           graph->ases->find(ann.received_from_asn) != graph->ases->end()) {
+           (from_as = graph->find_as(ann.received_from_asn)) != NULL) {
         if (std::find(as_path_vect.begin(), as_path_vect.end(), ann.received_from_asn) != as_path_vect.end()) {
             BOOST_LOG_TRIVIAL(warning) << "Loop detected in AS_PATH from AS " << asn << " to prefix " << ann.prefix.to_cidr();
             break;
         }
         as_path_vect.push_back(ann.received_from_asn);
-        ann = *graph->ases->find(ann.received_from_asn)->second->all_anns->find(ann.prefix);
+        ann = *from_as->saved_anns->find(ann.prefix);
     }
     // Stringify
     as_path << '{' << asn << ',';
@@ -1,9 +1,20 @@
+#include <atomic>
+#include <memory>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <cstring>
+#include <stdexcept>
+#include <unistd.h>
+#include <boost/thread/barrier.hpp>
+
 #include "Extrapolators/BlockedExtrapolator.h"
 
 
 template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType>
 BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::~BlockedExtrapolator() {
-
+    delete input;
+    delete announcement_store;
 }
 
 template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType>
@@ -16,6 +27,56 @@ void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, Pr
         closedir(dir);
     }
 
+    if (!this->results_dir.empty()) {
+        mkdir(this->results_dir.c_str(), 0777);
+    } else {
+        init_tables();
+        this->open_writer_connections();
+    }
+
+    if (announcement_store != NULL) {
+        // Nothing can be extrapolated without it, end the run
+        if (!announcement_store->open()) {
+            throw std::runtime_error("Failed to open announcement store " + announcement_store->file_name);
+        }
+        // Slots were given to the prefixes when the store was compiled
+        this->graph->max_block_prefix_id = std::max(announcement_store->header->max_block_prefix_id, (uint32_t) 1);
+        if (input != NULL) {
+            this->graph->create_graph_from_input(input, this->querier);
+        } else {
+            this->graph->create_graph_from_db(this->querier);
+        }
+        return;
+    }
+
+    if (input != NULL) {
+        // Blocks read from the input hold at most iteration_size prefixes, see read_announcements
+        this->graph->max_block_prefix_id = iteration_size;
+        this->graph->create_graph_from_input(input, this->querier);
+        return;
+    }
+
+    // Calculate max block_prefix_id before creating any ASes
+    pqxx::result r;
+    if (select_block_id) {
+        BOOST_LOG_TRIVIAL(info) << "Calculating max block_prefix_id";
+        r = this->querier->select_max_block_prefix_id();
+        this->graph->max_block_prefix_id = r[0][0].as<uint32_t>() + 1;  
+    } else {
+        // Blocks made by populate_blocks hold fewer than iteration_size prefixes, which are
+        // given dense slots as they are seeded. No need for more slots than there are prefixes.
+        // Announcements of a block holding more are dropped, see assign_slot.
+        BOOST_LOG_TRIVIAL(info) << "Calculating max prefix_id";
+        r = this->querier->select_max_prefix_id();
+        this->graph->max_block_prefix_id = std::min(r[0][0].as<uint32_t>() + 1, iteration_size);
+    }
+
+    // Generate the graph and populate the stubs & supernode tables
+    this->graph->create_graph_from_db(this->querier);
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::init_tables() {
     // Generate required tables
     if (this->store_results) {
         this->querier->clear_results_from_db();
@@ -43,38 +104,25 @@ void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, Pr
     this->querier->create_non_stubs_tbl();
     this->querier->clear_supernodes_from_db();
     this->querier->create_supernodes_tbl();
-    
-    // Calculate max block_prefix_id before creating any ASes
-    pqxx::result r;
-    if (select_block_id) {
-        BOOST_LOG_TRIVIAL(info) << "Calculating max block_prefix_id";
-        r = this->querier->select_max_block_prefix_id();
-    } else {
-        // If creating blocks manually, use prefix_id instead
-        BOOST_LOG_TRIVIAL(info) << "Calculating max prefix_id";
-        r = this->querier->select_max_prefix_id();
-    }
-    this->graph->max_block_prefix_id = r[0][0].as<uint32_t>() + 1;  
-
-    // Generate the graph and populate the stubs & supernode tables
-    this->graph->create_graph_from_db(this->querier);
 }
 
 template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType>
 void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::perform_propagation() {
     init();
 
-    
-    if (!select_block_id) {
+    if (announcement_store != NULL) {
+        extrapolate_store();
+    } else if (input != NULL) {
+        extrapolate_input();
+    } else if (!select_block_id) {
         BOOST_LOG_TRIVIAL(info) << "Generating subnet blocks...";
         // Generate iteration blocks
         std::vector<Prefix<PrefixType>*> *prefix_blocks = new std::vector<Prefix<PrefixType>*>; // Prefix blocks
         std::vector<Prefix<PrefixType>*> *subnet_blocks = new std::vector<Prefix<PrefixType>*>; // Subnet blocks
-        Prefix<PrefixType> *cur_prefix = new Prefix<PrefixType>("0.0.0.0", "0.0.0.0", 0, 0); // Start at 0.0.0.0/0
-        this->populate_blocks(cur_prefix, prefix_blocks, subnet_blocks); // Select blocks based on iteration size
-        delete cur_prefix;
+        std::vector<uint32_t> block_sizes;
+        this->plan_blocks(prefix_blocks, subnet_blocks, &block_sizes); // Select blocks based on iteration size
         
-        extrapolate(prefix_blocks, subnet_blocks);
+        extrapolate(prefix_blocks, subnet_blocks, &block_sizes);
         // Cleanup
         delete prefix_blocks;
         delete subnet_blocks;
@@ -89,7 +137,27 @@ void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, Pr
 }
 
 template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType>
-void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::extrapolate(std::vector<Prefix<PrefixType>*> *prefix_blocks, std::vector<Prefix<PrefixType>*> *subnet_blocks) {
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::extrapolate(std::vector<Prefix<PrefixType>*> *prefix_blocks, std::vector<Prefix<PrefixType>*> *subnet_blocks,
+                                                                                            const std::vector<uint32_t> *block_sizes) {
+    if (concurrent_blocks > 1) {
+        // Size each block to schedule the largest first, from the plan if it has the sizes
+        bool planned = block_sizes != NULL && block_sizes->size() == prefix_blocks->size() + subnet_blocks->size();
+        size_t position = 0;
+        std::vector<ExtrapolationBlock<PrefixType>> blocks;
+        for (Prefix<PrefixType>* prefix : *prefix_blocks) {
+            uint32_t size = planned ? block_sizes->at(position++) : this->querier->select_prefix_count(prefix)[0][0].template as<uint32_t>();
+            blocks.push_back(ExtrapolationBlock<PrefixType>{prefix, false, 0, size});
+        }
+        for (Prefix<PrefixType>* prefix : *subnet_blocks) {
+            uint32_t size = planned ? block_sizes->at(position++) : this->querier->select_subnet_count(prefix)[0][0].template as<uint32_t>();
+            blocks.push_back(ExtrapolationBlock<PrefixType>{prefix, true, 0, size});
+        }
+
+        if (this->extrapolate_blocks_concurrently(blocks)) {
+            return;
+        }
+    }
+
     BOOST_LOG_TRIVIAL(info) << "Beginning propagation...";
     
     // Seed MRT announcements and propagate
@@ -111,6 +179,26 @@ void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, Pr
 
 template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType>
 void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::extrapolate_by_block_id(uint32_t max_block_id) { 
+    if (concurrent_blocks > 1) {
+        // Size each block to schedule the largest first
+        int address_family = (sizeof(PrefixType) == 4 ? 4 : 6);
+        pqxx::result r = this->querier->select_block_id_counts(address_family);
+
+        std::vector<ExtrapolationBlock<PrefixType>> blocks;
+        for (pqxx::result::size_type i = 0; i < r.size(); i++) {
+            ExtrapolationBlock<PrefixType> block = {NULL, false, 0, 0};
+            r[i]["block_id"].to(block.block_id);
+            r[i]["count"].to(block.size);
+            if (block.block_id <= max_block_id) {
+                blocks.push_back(block);
+            }
+        }
+
+        if (this->extrapolate_blocks_concurrently(blocks)) {
+            return;
+        }
+    }
+
     BOOST_LOG_TRIVIAL(info) << "Beginning propagation...";
     
     // Seed MRT announcements and propagate
@@ -118,6 +206,19 @@ void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, Pr
     int iteration = 0;
     auto ext_start = std::chrono::high_resolution_clock::now();
 
+    // Fetch the blocks ahead of propagation if enabled
+    std::vector<ExtrapolationBlock<PrefixType>> blocks;
+    for (uint32_t i = 0; i <= max_block_id; i++) {
+        blocks.push_back(ExtrapolationBlock<PrefixType>{NULL, false, i, 0});
+    }
+    if (this->extrapolate_blocks_prefetched(blocks, false, announcement_count, iteration)) {
+        auto ext_finish = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> e = ext_finish - ext_start;
+        BOOST_LOG_TRIVIAL(info) << "Block elapsed time: " << e.count();
+        BOOST_LOG_TRIVIAL(info) << "Announcement count: " << announcement_count;
+        return;
+    }
+
     std::thread save_res_thread;
 
     // Propagate each unprocessed block of announcements 
@@ -125,106 +226,567 @@ void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, Pr
         //BOOST_LOG_TRIVIAL(info) << "Selecting Announcements...";
         auto prefix_start = std::chrono::high_resolution_clock::now();
 
-        // Get a block of announcements
-        int address_family = (sizeof(PrefixType) == 4 ? 4 : 6);
-        pqxx::result ann_block = this->querier->select_prefix_block_id(i, address_family);
+        // Seed the block of announcements as it is streamed in
+        ExtrapolationBlock<PrefixType> block = {NULL, false, i, 0};
+        size_t bsize = this->seed_streamed_block(block);
 
         // Check for empty block
-        auto bsize = ann_block.size();
         if (bsize == 0) {
             //BOOST_LOG_TRIVIAL(info) << "No announcements with this block id...";
             continue;
         }
         announcement_count += bsize;
 
-        BOOST_LOG_TRIVIAL(info) << "Seeding announcements...";
+        this->propagate_block(iteration, save_res_thread);
+        iteration++;
+        
+        BOOST_LOG_TRIVIAL(info) << "block_id " << i << " completed.";
+        auto prefix_finish = std::chrono::high_resolution_clock::now();
+        std::chrono::duration<double> q = prefix_finish - prefix_start;
+    }
+    
+    // Finalize saving before exiting the function
+    if (save_res_thread.joinable()) {
+        save_res_thread.join();
+    }
 
-        // For all announcements in this block
-        for (pqxx::result::size_type i = 0; i < bsize; i++) {
-            // Get row origin
-            uint32_t origin;
-            ann_block[i]["origin"].to(origin);
-            // Get row prefix
-            std::string ip = ann_block[i]["host"].c_str();
-            std::string mask = ann_block[i]["netmask"].c_str();
-            
-            uint32_t prefix_id;
-            uint32_t prefix_block_id;
+    auto ext_finish = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> e = ext_finish - ext_start;
+    BOOST_LOG_TRIVIAL(info) << "Block elapsed time: " << e.count();
+    BOOST_LOG_TRIVIAL(info) << "Announcement count: " << announcement_count;
+}
 
-            ann_block[i]["prefix_id"].to(prefix_id);
-            ann_block[i]["block_prefix_id"].to(prefix_block_id);
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::extrapolate_input() {
+    BOOST_LOG_TRIVIAL(info) << "Beginning propagation...";
 
-            Prefix<PrefixType> cur_prefix(ip, mask, prefix_id, prefix_block_id);
-            // Get row AS path
-            std::string path_as_string(ann_block[i]["as_path"].as<std::string>());
-            std::vector<uint32_t> *as_path = this->parse_path(path_as_string);
-            
-            // Check for loops in the path and drop announcement if they exist
-            bool loop = this->find_loop(as_path);
-            if (loop) {
-                continue;
+    uint32_t announcement_count = 0;
+    int iteration = 0;
+    auto ext_start = std::chrono::high_resolution_clock::now();
+
+    std::thread save_res_thread;
+    DecodedBlock<PrefixType> decoded;
+    auto add = [this, &decoded](const Prefix<PrefixType> &prefix, const char *as_path, uint32_t origin, int64_t timestamp) {
+        this->decode_announcement(prefix, as_path, origin, timestamp, decoded);
+    };
+
+    input->rewind_announcements();
+    while (true) {
+        decoded.clear();
+        try {
+            decoded.rows = input->read_announcements(iteration_size, add);
+        } catch (const std::runtime_error &e) {
+            // Finish saving the earlier blocks before failing the run
+            if (save_res_thread.joinable()) {
+                save_res_thread.join();
             }
+            throw;
+        }
+        if (decoded.rows == 0) {
+            break;
+        }
+        this->seed_decoded_block(decoded);
+        announcement_count += decoded.rows;
 
-            // Get timestamp
-            int64_t timestamp = std::stol(ann_block[i]["time"].as<std::string>());
+        this->propagate_block(iteration, save_res_thread);
+        BOOST_LOG_TRIVIAL(info) << "Block " << iteration << " completed.";
+        iteration++;
+    }
 
-            if(this->graph->inverse_results != NULL) {
-                // Assemble pair
-                auto prefix_origin = std::pair<Prefix<PrefixType>, uint32_t>(cur_prefix, origin);
-                
-                // Insert the inverse results for this prefix
-                if (this->graph->inverse_results->find(prefix_origin) == this->graph->inverse_results->end()) {
-                    // This is horrifying
-                    this->graph->inverse_results->insert(std::pair<std::pair<Prefix<PrefixType>, uint32_t>, 
-                                                            std::set<uint32_t>*>
-                                                            (prefix_origin, new std::set<uint32_t>()));
-                    
-                    // Put all non-stub ASNs in the set
-                    for (uint32_t asn : *this->graph->non_stubs) {
-                        this->graph->inverse_results->find(prefix_origin)->second->insert(asn);
-                    }
-                }
+    // Finalize saving before exiting the function
+    if (save_res_thread.joinable()) {
+        save_res_thread.join();
+    }
+
+    auto ext_finish = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> e = ext_finish - ext_start;
+    BOOST_LOG_TRIVIAL(info) << "Block elapsed time: " << e.count();
+    BOOST_LOG_TRIVIAL(info) << "Announcement count: " << announcement_count;
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::extrapolate_store() {
+    if (announcement_store->header == NULL) {
+        return;
+    }
+    BOOST_LOG_TRIVIAL(info) << "Beginning propagation...";
+
+    uint32_t announcement_count = 0;
+    auto ext_start = std::chrono::high_resolution_clock::now();
+
+    std::thread save_res_thread;
+    DecodedBlock<PrefixType> decoded;
+    const std::unordered_map<uint32_t, uint32_t> &asn_to_index = *this->graph->asn_to_index;
+    for (int iteration = 0; (uint64_t) iteration < announcement_store->header->num_blocks; iteration++) {
+        const StoredBlock &block = announcement_store->blocks[iteration];
+        decoded.clear();
+        decoded.rows = block.rows;
+        for (uint64_t i = block.first_ann; i < block.first_ann + block.num_anns; i++) {
+            const StoredAnnouncement<PrefixType> &ann = announcement_store->anns[i];
+            if (!announcement_store->valid_path(ann)) {
+                BOOST_LOG_TRIVIAL(error) << "Skipping block " << iteration << ", the path of announcement " << i << " is out of range";
+                decoded.clear();
+                break;
+            }
+            typename DecodedBlock<PrefixType>::Row row = {Prefix<PrefixType>(ann.addr, ann.netmask, ann.prefix_id, ann.block_prefix_id), 
+                                                          ann.origin, ann.timestamp, (uint32_t) decoded.asns.size(), ann.path_length};
+            decoded.anns.push_back(row);
+            // Only the graph indices depend on this run
+            const uint32_t *path = announcement_store->asns + ann.path_start;
+            decoded.asns.insert(decoded.asns.end(), path, path + ann.path_length);
+            for (uint32_t hop = 0; hop < ann.path_length; hop++) {
+                auto search = asn_to_index.find(path[hop]);
+                decoded.indices.push_back(search == asn_to_index.end() ? NO_INDEX : search->second);
             }
+        }
+        if (decoded.rows == 0) {
+            continue;
+        }
+        this->seed_decoded_block(decoded);
+        announcement_count += decoded.rows;
 
-            // Seed announcements along AS path
-            this->give_ann_to_as_path(as_path, cur_prefix, timestamp);
-            delete as_path;
+        this->propagate_block(iteration, save_res_thread);
+        BOOST_LOG_TRIVIAL(info) << "Block " << iteration << " completed.";
+    }
+
+    // Finalize saving before exiting the function
+    if (save_res_thread.joinable()) {
+        save_res_thread.join();
+    }
+
+    auto ext_finish = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> e = ext_finish - ext_start;
+    BOOST_LOG_TRIVIAL(info) << "Block elapsed time: " << e.count();
+    BOOST_LOG_TRIVIAL(info) << "Announcement count: " << announcement_count;
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType>
+bool BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::compile_announcements(std::string file_name) {
+    AnnouncementStoreWriter<PrefixType> writer(file_name);
+    if (!writer.open()) {
+        return false;
+    }
+    // Paths are decoded without a graph, loops are found the same way
+    DecodedBlock<PrefixType> decoded;
+    auto write_block = [&writer, &decoded]() {
+        if (decoded.rows == 0) {
+            return;
+        }
+        for (auto &ann : decoded.anns) {
+            writer.add(ann.prefix, ann.origin, ann.timestamp, decoded.asns.data() + ann.path_start, ann.path_length);
+        }
+        writer.end_block(decoded.rows);
+    };
+
+    if (input != NULL) {
+        auto add = [this, &decoded](const Prefix<PrefixType> &prefix, const char *as_path, uint32_t origin, int64_t timestamp) {
+            this->decode_announcement(prefix, as_path, origin, timestamp, decoded);
+        };
+        input->rewind_announcements();
+        while ((decoded.rows = input->read_announcements(iteration_size, add)) > 0) {
+            write_block();
+            decoded.clear();
+        }
+    } else if (!select_block_id) {
+        std::vector<Prefix<PrefixType>*> prefix_blocks, subnet_blocks;
+        this->plan_blocks(&prefix_blocks, &subnet_blocks);
+        for (auto *blocks : {&prefix_blocks, &subnet_blocks}) {
+            for (Prefix<PrefixType> *prefix : *blocks) {
+                decoded.clear();
+                decoded.block = ExtrapolationBlock<PrefixType>{prefix, blocks == &subnet_blocks, 0, 0};
+                this->fetch_decoded_block(this->querier, decoded);
+                write_block();
+                delete prefix;
+            }
         }
-        // Propagate for this subnet
-        BOOST_LOG_TRIVIAL(info) << "Propagating...";
-        this->propagate_up();
-        this->propagate_down();
+    } else {
+        pqxx::result r = this->querier->select_max_block_id();
+        max_block_id = r[0][0].as<uint32_t>();
+        for (uint32_t block_id = 0; block_id <= max_block_id; block_id++) {
+            decoded.clear();
+            decoded.block = ExtrapolationBlock<PrefixType>{NULL, false, block_id, 0};
+            this->fetch_decoded_block(this->querier, decoded);
+            write_block();
+        }
+    }
+    return writer.close();
+}
 
-        // Make sure we finish saving to the database before running save_results() on the next prefix
-        if (save_res_thread.joinable()) {
-            save_res_thread.join();
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType>
+BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>* BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::create_block_worker() {
+    return NULL;
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType>
+SQLQuerierType* BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::create_prefetch_querier() {
+    return NULL;
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType>
+bool BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::extrapolate_blocks_prefetched(std::vector<ExtrapolationBlock<PrefixType>> &blocks, 
+                                                                                                    bool stop_at_empty, 
+                                                                                                    uint32_t &announcement_count, 
+                                                                                                    int &iteration) {
+    if (prefetch_blocks == 0) {
+        return false;
+    }
+    SQLQuerierType *input_querier = this->create_prefetch_querier();
+    if (input_querier == NULL) {
+        BOOST_LOG_TRIVIAL(warning) << "Prefetching is not supported by this extrapolator, fetching each block when it is propagated";
+        return false;
+    }
+
+    // Decoded blocks waiting to be seeded, in order, at most prefetch_blocks of them
+    std::deque<DecodedBlock<PrefixType>*> ready;
+    std::mutex ready_mutex;
+    std::condition_variable ready_changed;
+    bool stop = false;
+
+    std::thread input_thread([&]() {
+        for (auto &block : blocks) {
+            DecodedBlock<PrefixType> *decoded = new DecodedBlock<PrefixType>();
+            decoded->block = block;
+            this->fetch_decoded_block(input_querier, *decoded);
+
+            std::unique_lock<std::mutex> lock(ready_mutex);
+            ready_changed.wait(lock, [&]() { return stop || ready.size() < prefetch_blocks; });
+            if (stop) {
+                delete decoded;
+                return;
+            }
+            ready.push_back(decoded);
+            ready_changed.notify_all();
         }
+    });
 
-        // Run save_results() in a separate thread
-        save_res_thread = std::thread(&BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::save_results, this, iteration);
+    std::thread save_res_thread;
+    std::chrono::duration<double> total_stall(0);
+    for (size_t i = 0; i < blocks.size(); i++) {
+        // Wait for the input thread to have the next block
+        auto stall_start = std::chrono::high_resolution_clock::now();
+        DecodedBlock<PrefixType> *decoded;
+        {
+            std::unique_lock<std::mutex> lock(ready_mutex);
+            ready_changed.wait(lock, [&]() { return !ready.empty(); });
+            decoded = ready.front();
+            ready.pop_front();
+            ready_changed.notify_all();
+        }
+        std::chrono::duration<double> stall = std::chrono::high_resolution_clock::now() - stall_start;
+        total_stall += stall;
 
-        // Wait for all csvs to be saved before clearing the announcements
-        for (int i = 0; i < this->max_workers; i++) {
-            sem_wait(&this->csvs_written);
+        // Check for empty block
+        if (decoded->rows == 0) {
+            delete decoded;
+            if (stop_at_empty) {
+                break;
+            }
+            continue;
         }
+        announcement_count += decoded->rows;
 
-        this->graph->clear_announcements();
+        BOOST_LOG_TRIVIAL(info) << "Seeding announcements...";
+        this->seed_decoded_block(*decoded);
+        this->propagate_block(iteration, save_res_thread);
         iteration++;
-        
-        BOOST_LOG_TRIVIAL(info) << "block_id " << i << " completed.";
-        auto prefix_finish = std::chrono::high_resolution_clock::now();
-        std::chrono::duration<double> q = prefix_finish - prefix_start;
+
+        if (decoded->block.prefix == NULL) {
+            BOOST_LOG_TRIVIAL(info) << "block_id " << decoded->block.block_id << " completed, input stall " << stall.count() << "s";
+        } else {
+            BOOST_LOG_TRIVIAL(info) << decoded->block.prefix->to_cidr() << " completed, input stall " << stall.count() << "s";
+        }
+        delete decoded;
     }
-    
+
+    // Stop the input thread if the blocks ended early
+    {
+        std::lock_guard<std::mutex> lock(ready_mutex);
+        stop = true;
+        ready_changed.notify_all();
+    }
+    input_thread.join();
+    for (DecodedBlock<PrefixType> *decoded : ready) {
+        delete decoded;
+    }
+    delete input_querier;
+
     // Finalize saving before exiting the function
     if (save_res_thread.joinable()) {
         save_res_thread.join();
     }
+    BOOST_LOG_TRIVIAL(info) << "Input stall time: " << total_stall.count() << "s with " << prefetch_blocks << " blocks prefetched";
+    return true;
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType>
+bool BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::extrapolate_blocks_concurrently(std::vector<ExtrapolationBlock<PrefixType>> &blocks) {
+    // Create the workers, each with its own RIBs and database connection
+    std::vector<BlockedExtrapolator*> workers;
+    for (uint32_t i = 0; i < concurrent_blocks && i < blocks.size(); i++) {
+        BlockedExtrapolator *worker = this->create_block_worker();
+        if (worker == NULL) {
+            BOOST_LOG_TRIVIAL(warning) << "Concurrent blocks are not supported by this extrapolator, extrapolating one block at a time";
+            return false;
+        }
+        workers.push_back(worker);
+    }
+
+    BOOST_LOG_TRIVIAL(info) << "Beginning propagation of " << blocks.size() << " blocks, " << workers.size() << " at a time...";
+    auto ext_start = std::chrono::high_resolution_clock::now();
+
+    // Largest first, so the run does not end waiting on a large block
+    std::stable_sort(blocks.begin(), blocks.end(), 
+        [](const ExtrapolationBlock<PrefixType> &a, const ExtrapolationBlock<PrefixType> &b) { return a.size > b.size; });
+
+    std::atomic<size_t> next_block(0);
+    std::atomic<uint32_t> announcement_count(0);
+    std::vector<std::thread> threads;
+    for (BlockedExtrapolator *worker : workers) {
+        threads.push_back(std::thread([&blocks, &next_block, &announcement_count, worker]() {
+            std::thread save_res_thread;
+            for (size_t i = next_block++; i < blocks.size(); i = next_block++) {
+                ExtrapolationBlock<PrefixType> &block = blocks.at(i);
+
+                size_t bsize = worker->seed_streamed_block(block);
+                if (bsize == 0) {
+                    continue;
+                }
+                announcement_count += bsize;
+
+                // The position of the block is its iteration, unique across the workers
+                worker->propagate_block(i, save_res_thread);
+
+                if (block.prefix == NULL) {
+                    BOOST_LOG_TRIVIAL(info) << "block_id " << block.block_id << " completed.";
+                } else {
+                    BOOST_LOG_TRIVIAL(info) << block.prefix->to_cidr() << " completed.";
+                }
+            }
+
+            // Finalize saving before the worker is deleted
+            if (save_res_thread.joinable()) {
+                save_res_thread.join();
+            }
+        }));
+    }
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    for (BlockedExtrapolator *worker : workers) {
+        delete worker;
+    }
 
     auto ext_finish = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> e = ext_finish - ext_start;
     BOOST_LOG_TRIVIAL(info) << "Block elapsed time: " << e.count();
     BOOST_LOG_TRIVIAL(info) << "Announcement count: " << announcement_count;
+    return true;
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType>
+size_t BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::seed_streamed_block(const ExtrapolationBlock<PrefixType> &block) {
+    BOOST_LOG_TRIVIAL(info) << "Seeding announcements...";
+
+    // Slot in the RIBs of each prefix_id in this block, kept across the chunks
+    std::unordered_map<uint32_t, uint32_t> prefix_slots;
+    bool by_block_id = block.prefix == NULL;
+    size_t seeded = 0;
+    auto consume = [this, &prefix_slots, by_block_id, &seeded](pqxx::result &ann_block) {
+        seeded += ann_block.size();
+        this->seed_block(ann_block, by_block_id, prefix_slots);
+    };
+
+    size_t rows;
+    if (by_block_id) {
+        int address_family = (sizeof(PrefixType) == 4 ? 4 : 6);
+        rows = this->querier->stream_prefix_block_id(block.block_id, address_family, consume);
+    } else {
+        rows = this->querier->stream_prefix_ann(block.prefix, block.subnet, consume);
+    }
+
+    // The query failed after some chunks were seeded, do not propagate and save part of the block
+    if (rows != seeded) {
+        BOOST_LOG_TRIVIAL(error) << "Skipping block, its query failed after " << seeded << " announcements were seeded";
+        this->graph->clear_announcements();
+        return 0;
+    }
+    return rows;
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::fetch_decoded_block(SQLQuerierType *querier, DecodedBlock<PrefixType> &decoded) {
+    // Slot in the RIBs of each prefix_id in this block, kept across the chunks
+    std::unordered_map<uint32_t, uint32_t> prefix_slots;
+    const ExtrapolationBlock<PrefixType> &block = decoded.block;
+    bool by_block_id = block.prefix == NULL;
+    auto consume = [this, &prefix_slots, &decoded, by_block_id](pqxx::result &ann_block) {
+        this->decode_block(ann_block, by_block_id, prefix_slots, decoded);
+    };
+
+    size_t rows;
+    if (by_block_id) {
+        int address_family = (sizeof(PrefixType) == 4 ? 4 : 6);
+        rows = querier->stream_prefix_block_id(block.block_id, address_family, consume);
+    } else {
+        rows = querier->stream_prefix_ann(block.prefix, block.subnet, consume);
+    }
+
+    // The query failed after some chunks were decoded, do not seed part of the block
+    if (rows != decoded.rows) {
+        BOOST_LOG_TRIVIAL(error) << "Skipping block, its query failed after " << decoded.rows << " announcements were decoded";
+        decoded.clear();
+    }
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::seed_block(pqxx::result &ann_block, bool by_block_id, std::unordered_map<uint32_t, uint32_t> &prefix_slots) {
+    // Reused for every chunk seeded on this thread
+    static thread_local DecodedBlock<PrefixType> decoded;
+    decoded.clear();
+    this->decode_block(ann_block, by_block_id, prefix_slots, decoded);
+    this->seed_decoded_block(decoded);
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::decode_block(pqxx::result &ann_block, bool by_block_id, std::unordered_map<uint32_t, uint32_t> &prefix_slots, DecodedBlock<PrefixType> &decoded) {
+    decoded.rows += ann_block.size();
+    size_t dropped = 0;
+    // For all announcements in this block
+    for (pqxx::result::size_type i = 0; i < ann_block.size(); i++) {
+        // Get row origin
+        uint32_t origin;
+        ann_block[i]["origin"].to(origin);
+        // Get row prefix
+        const char *ip = ann_block[i]["host"].c_str();
+        const char *mask = ann_block[i]["netmask"].c_str();
+
+        uint32_t prefix_id;
+        ann_block[i]["prefix_id"].to(prefix_id);
+
+        // Blocks made by populate_blocks number their prefixes in the order they are seeded
+        uint32_t prefix_block_id;
+        bool has_slot;
+        if (by_block_id) {
+            ann_block[i]["block_prefix_id"].to(prefix_block_id);
+            has_slot = prefix_block_id < this->graph->max_block_prefix_id;
+        } else {
+            has_slot = assign_slot(prefix_id, prefix_slots, prefix_block_id);
+        }
+        if (!has_slot) {
+            dropped++;
+            continue;
+        }
+
+        // IPv4 addresses are parsed in place, anything else goes through the string constructor
+        uint32_t addr, netmask;
+        bool ipv4 = sizeof(PrefixType) == 4 && PathDecoder::parse_ipv4(ip, addr) && PathDecoder::parse_ipv4(mask, netmask);
+        Prefix<PrefixType> cur_prefix = ipv4 ? Prefix<PrefixType>(addr, netmask, prefix_id, prefix_block_id)
+                                             : Prefix<PrefixType>(ip, mask, prefix_id, prefix_block_id);
+
+        // Get timestamp
+        int64_t timestamp;
+        if (!PathDecoder::parse_int64(ann_block[i]["time"].c_str(), timestamp)) {
+            timestamp = std::stol(ann_block[i]["time"].as<std::string>());
+        }
+
+        this->decode_announcement(cur_prefix, ann_block[i]["as_path"].c_str(), origin, timestamp, decoded);
+    }
+    if (dropped > 0) {
+        BOOST_LOG_TRIVIAL(error) << "Block holds more prefixes than the " << this->graph->max_block_prefix_id 
+                                 << " slots of the RIBs, dropped " << dropped << " announcements";
+    }
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType>
+bool BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::assign_slot(uint32_t prefix_id, std::unordered_map<uint32_t, uint32_t> &prefix_slots, uint32_t &slot) {
+    auto search = prefix_slots.find(prefix_id);
+    if (search != prefix_slots.end()) {
+        slot = search->second;
+        return true;
+    }
+    if (prefix_slots.size() >= this->graph->max_block_prefix_id) {
+        return false;
+    }
+    slot = prefix_slots.size();
+    prefix_slots.insert(std::make_pair(prefix_id, slot));
+    return true;
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType>
+bool BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::decode_announcement(const Prefix<PrefixType> &prefix, const char *as_path, uint32_t origin, int64_t timestamp, DecodedBlock<PrefixType> &decoded) {
+    // Decodes the rows of every block on this thread
+    static thread_local PathDecoder decoder;
+
+    // Decode the AS path, dropping the announcement if it has a loop
+    if (!decoder.decode_path(as_path, *this->graph->asn_to_index)) {
+        // Logger::getInstance().log("Loops") << "AS path loop, Origin: " << origin << ", Prefix: " << prefix.to_cidr() << ", Path: " << as_path;
+        return false;
+    }
+
+    typename DecodedBlock<PrefixType>::Row row = {prefix, origin, timestamp, (uint32_t) decoded.asns.size(), (uint32_t) decoder.path.size()};
+    decoded.anns.push_back(row);
+    decoded.asns.insert(decoded.asns.end(), decoder.path.begin(), decoder.path.end());
+    decoded.indices.insert(decoded.indices.end(), decoder.indices.begin(), decoder.indices.end());
+    return true;
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::seed_decoded_block(DecodedBlock<PrefixType> &decoded) {
+    // Reused for the path of every announcement
+    std::vector<uint32_t> as_path, path_indices;
+
+    for (auto &ann : decoded.anns) {
+        // The inverse results of the pair are computed from the RIBs when they are saved
+        if(this->graph->inverse_results != NULL) {
+            this->graph->inverse_results->add_seed(ann.prefix, ann.origin);
+        }
+
+        // Seed announcements along AS path
+        as_path.assign(decoded.asns.begin() + ann.path_start, decoded.asns.begin() + ann.path_start + ann.path_length);
+        path_indices.assign(decoded.indices.begin() + ann.path_start, decoded.indices.begin() + ann.path_start + ann.path_length);
+        this->give_ann_to_as_path(&as_path, ann.prefix, ann.timestamp, &path_indices);
+    }
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::propagate_block(int iteration, std::thread &save_res_thread) {
+    // Propagate for this block
+    BOOST_LOG_TRIVIAL(info) << "Propagating...";
+    this->propagate_up();
+    this->propagate_down();
+
+    if (double_buffer_ribs) {
+        // Writers still on the previous block hold the saved generation, wait for them
+        if (save_res_thread.joinable()) {
+            save_res_thread.join();
+            for (int i = 0; i < this->max_workers; i++) {
+                sem_wait(&this->csvs_written);
+            }
+        }
+        // Added on the first block, so the graphs of block workers get one as well
+        this->graph->add_rib_generation();
+        this->graph->swap_rib_generations();
+
+        // Save this block from the saved generation while the next is seeded and propagated
+        save_res_thread = std::thread(&BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::save_results, this, iteration);
+        return;
+    }
+
+    // Make sure we finish saving to the database before running save_results() on the next block
+    if (save_res_thread.joinable()) {
+        save_res_thread.join();
+    }
+
+    // Run save_results() in a separate thread
+    save_res_thread = std::thread(&BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::save_results, this, iteration);
+
+    // Wait for all csvs to be saved before clearing the announcements
+    for (int i = 0; i < this->max_workers; i++) {
+        sem_wait(&this->csvs_written);
+    }
+
+    this->graph->clear_announcements();
 }
 
 template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType>
@@ -310,11 +872,234 @@ void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, Pr
     }
 }
 
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::plan_blocks(std::vector<Prefix<PrefixType>*>* prefix_vector,
+                                                                        std::vector<Prefix<PrefixType>*>* bloc_vector,
+                                                                        std::vector<uint32_t> *block_sizes) {
+    int address_family = (sizeof(PrefixType) == 4 ? 4 : 6);
+    std::vector<uint32_t> sizes;
+
+    // Plans are only valid for the same announcements and settings
+    std::string plan_key, plan_file;
+    if (!block_plan_dir.empty()) {
+        pqxx::result r = this->querier->select_announcements_version(address_family);
+        if (!r.empty()) {
+            plan_key = r[0][0].as<std::string>() + "-" + std::to_string(address_family) + "-" + 
+                std::to_string(this->iteration_size) + "-" + std::to_string(this->querier->exclude_as_number);
+            plan_file = block_plan_dir + "/block-plan-" + plan_key + ".bin";
+            if (load_block_plan(plan_file, plan_key, this->graph->max_block_prefix_id, prefix_vector, bloc_vector, &sizes)) {
+                BOOST_LOG_TRIVIAL(info) << "Loaded block plan " << plan_file;
+                if (block_sizes != NULL) {
+                    block_sizes->swap(sizes);
+                }
+                return;
+            }
+        }
+    }
+
+    pqxx::result r = this->querier->select_prefix_counts(address_family);
+    std::vector<std::pair<Prefix<PrefixType>, uint32_t>> counts;
+    counts.reserve(r.size());
+    for (pqxx::result::size_type i = 0; i < r.size(); i++) {
+        // Only the address of the host string is used, the netmask comes from the length
+        std::string host = r[i][0].as<std::string>();
+        Prefix<PrefixType> prefix(host, host, 0, 0);
+        uint32_t length = r[i][1].as<uint32_t>();
+        prefix.netmask = length == 0 ? 0 : ~((PrefixType) 0) << (sizeof(PrefixType) * 8 - length);
+        counts.push_back(std::make_pair(prefix, r[i][2].as<uint32_t>()));
+    }
+    uint32_t max_block_prefixes = plan_blocks_from_counts(counts, prefix_vector, bloc_vector, &sizes);
+
+    if (!plan_file.empty()) {
+        BOOST_LOG_TRIVIAL(info) << "Saving block plan " << plan_file;
+        save_block_plan(plan_file, plan_key, max_block_prefixes, prefix_vector, bloc_vector, sizes);
+    }
+    if (block_sizes != NULL) {
+        block_sizes->swap(sizes);
+    }
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType>
+uint32_t BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::plan_blocks_from_counts(const std::vector<std::pair<Prefix<PrefixType>, uint32_t>> &counts,
+                                                                                    std::vector<Prefix<PrefixType>*>* prefix_vector,
+                                                                                    std::vector<Prefix<PrefixType>*>* bloc_vector,
+                                                                                    std::vector<uint32_t> *block_sizes) {
+    const int bits = sizeof(PrefixType) * 8;
+    struct Node {
+        uint32_t children[2];   // 0 if there is no child
+        uint64_t count;         // Announcements for this prefix
+        uint64_t subnet_count;  // Announcements for this prefix and every prefix within it
+        uint32_t prefixes;      // Distinct prefixes within this prefix, itself included
+    };
+    std::vector<Node> trie(1, Node{{0, 0}, 0, 0, 0});
+
+    // Sum each count up the path to its prefix
+    for (auto &prefix_count : counts) {
+        const Prefix<PrefixType> &prefix = prefix_count.first;
+        uint32_t node = 0;
+        trie[node].subnet_count += prefix_count.second;
+        trie[node].prefixes++;
+        for (int depth = 0; depth < bits && (prefix.netmask >> (bits - 1 - depth)) & 1; depth++) {
+            int bit = (prefix.addr >> (bits - 1 - depth)) & 1;
+            if (trie[node].children[bit] == 0) {
+                trie[node].children[bit] = trie.size();
+                trie.push_back(Node{{0, 0}, 0, 0, 0});
+            }
+            node = trie[node].children[bit];
+            trie[node].subnet_count += prefix_count.second;
+            trie[node].prefixes++;
+        }
+        trie[node].count += prefix_count.second;
+    }
+
+    // Walk the trie depth first, lower half first, as populate_blocks splits the address space
+    struct Visit {
+        uint32_t node;
+        PrefixType addr;
+        int length;
+    };
+    std::vector<Visit> stack(1, Visit{0, 0, 0});
+    uint32_t max_block_prefixes = 0;
+    std::vector<uint32_t> subnet_sizes;
+    block_sizes->clear();
+    while (!stack.empty()) {
+        Visit visit = stack.back();
+        stack.pop_back();
+        const Node &node = trie[visit.node];
+        PrefixType netmask = visit.length == 0 ? 0 : ~((PrefixType) 0) << (bits - visit.length);
+
+        // If the subnet count is within size constraint
+        if (node.subnet_count < this->iteration_size) {
+            if (node.subnet_count > 0) {
+                bloc_vector->push_back(new Prefix<PrefixType>(visit.addr, netmask, 0, 0));
+                subnet_sizes.push_back(node.subnet_count);
+                max_block_prefixes = std::max(max_block_prefixes, node.prefixes);
+            }
+            continue;
+        }
+        // Store the prefix if there are announcements for it specifically
+        if (node.count > 0) {
+            prefix_vector->push_back(new Prefix<PrefixType>(visit.addr, netmask, 0, 0));
+            block_sizes->push_back(node.count);
+            max_block_prefixes = std::max(max_block_prefixes, (uint32_t) 1);
+        }
+        for (int bit = 1; bit >= 0; bit--) {
+            if (node.children[bit] != 0) {
+                PrefixType addr = visit.addr | ((PrefixType) bit << (bits - 1 - visit.length));
+                stack.push_back(Visit{node.children[bit], addr, visit.length + 1});
+            }
+        }
+    }
+    // Subnet blocks follow the prefix blocks, as in the plan file
+    block_sizes->insert(block_sizes->end(), subnet_sizes.begin(), subnet_sizes.end());
+    return max_block_prefixes;
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType>
+bool BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::save_block_plan(std::string file_name, std::string key, uint32_t max_block_prefixes,
+                                                                            std::vector<Prefix<PrefixType>*>* prefix_vector,
+                                                                            std::vector<Prefix<PrefixType>*>* bloc_vector,
+                                                                            const std::vector<uint32_t> &block_sizes) {
+    if (block_sizes.size() != prefix_vector->size() + bloc_vector->size()) {
+        return false;
+    }
+    BlockPlanHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::strncpy(header.magic, BLOCK_PLAN_MAGIC, sizeof(header.magic));
+    header.version = BLOCK_PLAN_VERSION;
+    std::strncpy(header.key, key.c_str(), sizeof(header.key) - 1);
+    header.prefix_bytes = sizeof(PrefixType);
+    header.num_prefix_blocks = prefix_vector->size();
+    header.num_subnet_blocks = bloc_vector->size();
+    header.max_block_prefixes = max_block_prefixes;
+
+    std::string tmp_name = file_name + ".tmp." + std::to_string(getpid());
+    std::ofstream outfile(tmp_name, std::ios::binary);
+    outfile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    size_t position = 0;
+    for (auto *blocks : {prefix_vector, bloc_vector}) {
+        for (Prefix<PrefixType> *prefix : *blocks) {
+            outfile.write(reinterpret_cast<const char*>(&prefix->addr), sizeof(PrefixType));
+            outfile.write(reinterpret_cast<const char*>(&prefix->netmask), sizeof(PrefixType));
+            outfile.write(reinterpret_cast<const char*>(&block_sizes[position++]), sizeof(uint32_t));
+        }
+    }
+    outfile.close();
+
+    if (!outfile || std::rename(tmp_name.c_str(), file_name.c_str()) != 0) {
+        BOOST_LOG_TRIVIAL(warning) << "Could not write block plan " << file_name;
+        std::remove(tmp_name.c_str());
+        return false;
+    }
+    return true;
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType>
+bool BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::load_block_plan(std::string file_name, std::string key, uint32_t max_block_prefixes,
+                                                                            std::vector<Prefix<PrefixType>*>* prefix_vector,
+                                                                            std::vector<Prefix<PrefixType>*>* bloc_vector,
+                                                                            std::vector<uint32_t> *block_sizes) {
+    std::ifstream infile(file_name, std::ios::binary);
+    if (!infile) {
+        return false;
+    }
+    BlockPlanHeader header;
+    infile.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (!infile || std::strncmp(header.magic, BLOCK_PLAN_MAGIC, sizeof(header.magic)) != 0 ||
+            header.version != BLOCK_PLAN_VERSION || header.prefix_bytes != sizeof(PrefixType) ||
+            std::strncmp(header.key, key.c_str(), sizeof(header.key)) != 0) {
+        BOOST_LOG_TRIVIAL(warning) << "Ignoring mismatched block plan " << file_name;
+        return false;
+    }
+    // Announcements of a block that does not fit would be dropped, see assign_slot
+    if (header.max_block_prefixes > max_block_prefixes) {
+        BOOST_LOG_TRIVIAL(warning) << "Ignoring block plan " << file_name << ", it has blocks of " << header.max_block_prefixes 
+                                   << " prefixes but the RIBs have " << max_block_prefixes << " slots";
+        return false;
+    }
+
+    block_sizes->clear();
+    std::vector<Prefix<PrefixType>*> *blocks[] = {prefix_vector, bloc_vector};
+    uint32_t sizes[] = {header.num_prefix_blocks, header.num_subnet_blocks};
+    for (int i = 0; i < 2; i++) {
+        for (uint32_t j = 0; j < sizes[i]; j++) {
+            PrefixType addr, netmask;
+            uint32_t size;
+            infile.read(reinterpret_cast<char*>(&addr), sizeof(PrefixType));
+            infile.read(reinterpret_cast<char*>(&netmask), sizeof(PrefixType));
+            infile.read(reinterpret_cast<char*>(&size), sizeof(uint32_t));
+            blocks[i]->push_back(new Prefix<PrefixType>(addr, netmask, 0, 0));
+            block_sizes->push_back(size);
+        }
+    }
+    if (!infile) {
+        BOOST_LOG_TRIVIAL(warning) << "Ignoring truncated block plan " << file_name;
+        for (auto *vector : blocks) {
+            for (Prefix<PrefixType> *prefix : *vector) {
+                delete prefix;
+            }
+            vector->clear();
+        }
+        block_sizes->clear();
+        return false;
+    }
+    return true;
+}
+
 template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType>
 void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::extrapolate_blocks(uint32_t &announcement_count, 
                                                                                                     int &iteration, 
                                                                                                     bool subnet, 
                                                                                                     std::vector<Prefix<PrefixType>*> *prefix_set) {
+    // Fetch the blocks ahead of propagation if enabled
+    std::vector<ExtrapolationBlock<PrefixType>> blocks;
+    for (Prefix<PrefixType>* prefix : *prefix_set) {
+        blocks.push_back(ExtrapolationBlock<PrefixType>{prefix, subnet, 0, 0});
+    }
+    if (this->extrapolate_blocks_prefetched(blocks, true, announcement_count, iteration)) {
+        return;
+    }
+
     std::thread save_res_thread;
     
     // For each unprocessed block of announcements 
@@ -322,95 +1107,16 @@ void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, Pr
         BOOST_LOG_TRIVIAL(info) << "Selecting Announcements...";
         auto prefix_start = std::chrono::high_resolution_clock::now();
         
-        // Handle prefix blocks or subnet blocks of announcements
-        pqxx::result ann_block;
-        if (!subnet) {
-            // Get the block of announcements for the specific prefix
-            ann_block = this->querier->select_prefix_ann(prefix);
-        } else {
-            // Get the block of announcements for the whole subnet
-            ann_block = this->querier->select_subnet_ann(prefix);
-        } 
+        // Seed the prefix block or subnet block of announcements as it is streamed in
+        ExtrapolationBlock<PrefixType> block = {prefix, subnet, 0, 0};
+        size_t bsize = this->seed_streamed_block(block);
         
         // Check for empty block
-        auto bsize = ann_block.size();
         if (bsize == 0)
             break;
         announcement_count += bsize;
         
-        BOOST_LOG_TRIVIAL(info) << "Seeding announcements...";
-        // For all announcements in this block
-        for (pqxx::result::size_type i = 0; i < bsize; i++) {
-            // Get row origin
-            uint32_t origin;
-            ann_block[i]["origin"].to(origin);
-            // Get row prefix
-            std::string ip = ann_block[i]["host"].c_str();
-            std::string mask = ann_block[i]["netmask"].c_str();
-
-            uint32_t prefix_id;
-            ann_block[i]["prefix_id"].to(prefix_id);
-            Prefix<PrefixType> cur_prefix(ip, mask, prefix_id);
-
-            // Get row AS path
-            std::string path_as_string(ann_block[i]["as_path"].as<std::string>());
-            std::vector<uint32_t> *as_path = this->parse_path(path_as_string);
-            
-            // Check for loops in the path and drop announcement if they exist
-            bool loop = this->find_loop(as_path);
-            if (loop) {
-                static int g_loop = 1;
-                
-                // Logger::getInstance().log("Loops") << "AS path loop #" << g_loop << ", Origin: " << origin << ", Prefix: " << cur_prefix.to_cidr() << ", Path: " << path_as_string;
-
-                g_loop++;
-                continue;
-            }
-
-            // Get timestamp
-            int64_t timestamp = std::stol(ann_block[i]["time"].as<std::string>());
-
-            if(this->graph->inverse_results != NULL) {
-                // Assemble pair
-                auto prefix_origin = std::pair<Prefix<PrefixType>, uint32_t>(cur_prefix, origin);
-                
-                // Insert the inverse results for this prefix
-                if (this->graph->inverse_results->find(prefix_origin) == this->graph->inverse_results->end()) {
-                    // This is horrifying
-                    this->graph->inverse_results->insert(std::pair<std::pair<Prefix<PrefixType>, uint32_t>, 
-                                                            std::set<uint32_t>*>
-                                                            (prefix_origin, new std::set<uint32_t>()));
-                    
-                    // Put all non-stub ASNs in the set
-                    for (uint32_t asn : *this->graph->non_stubs) {
-                        this->graph->inverse_results->find(prefix_origin)->second->insert(asn);
-                    }
-                }
-            }
-
-            // Seed announcements along AS path
-            this->give_ann_to_as_path(as_path, cur_prefix, timestamp);
-            delete as_path;
-        }
-        // Propagate for this subnet
-        BOOST_LOG_TRIVIAL(info) << "Propagating...";
-        this->propagate_up();
-        this->propagate_down();
-
-        // Make sure we finish saving to the database before running save_results() on the next prefix
-        if (save_res_thread.joinable()) {
-            save_res_thread.join();
-        }
-
-        // Run save_results() in a separate thread
-        save_res_thread = std::thread(&BaseExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType>::save_results, this, iteration);
-
-        // Wait for all csvs to be saved before clearing the announcements
-        for (int i = 0; i < this->max_workers; i++) {
-            sem_wait(&this->csvs_written);
-        }
-
-        this->graph->clear_announcements();
+        this->propagate_block(iteration, save_res_thread);
         iteration++;
         
         BOOST_LOG_TRIVIAL(info) << prefix->to_cidr() << " completed.";
@@ -425,7 +1131,7 @@ void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, Pr
 }
 
 template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType>
-void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::give_ann_to_as_path(std::vector<uint32_t>* as_path, Prefix<PrefixType> prefix, int64_t timestamp) {
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::give_ann_to_as_path(std::vector<uint32_t>* as_path, Prefix<PrefixType> prefix, int64_t timestamp, const std::vector<uint32_t> *path_indices) {
     // Handle empty as_path
     if (as_path->empty()) { 
         return;
@@ -441,6 +1147,8 @@ void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, Pr
     //                                     0,
     //                                     timestamp); 
     
+    // AS of the previous hop on the path, NULL if it is not in the graph
+    ASType *previous_as = NULL;
     // Iterate through path starting at the origin
     for (auto it = as_path->rbegin(); it != as_path->rend(); ++it) {
         // Only seed at origin AS if origin only mode is enabled
@@ -450,14 +1158,21 @@ void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, Pr
 
         // Increments path length, including prepending
         i++;
+        // Find the current AS on the path. ASNs in the graph are never translated to a 
+        // supernode, members are removed from it and the supernode keeps the lowest ASN.
+        ASType *as_on_path;
+        if (path_indices != NULL) {
+            uint32_t index = (*path_indices)[path_l - i];
+            as_on_path = index == NO_INDEX ? NULL : this->graph->as_at(index);
+        } else {
+            as_on_path = this->graph->find_as(*it);
+        }
+        ASType *from_as = previous_as;
+        previous_as = as_on_path;
         // If ASN not in graph, continue
-        if (this->graph->ases->find(*it) == this->graph->ases->end()) {
+        if (as_on_path == NULL) {
             continue;
         }
-        // Translate ASN to it's supernode
-        uint32_t asn_on_path = this->graph->translate_asn(*it);
-        // Find the current AS on the path
-        ASType *as_on_path = this->graph->ases->find(asn_on_path)->second;
 
         auto second_announcement_search = as_on_path->all_anns->find(prefix);
 
@@ -469,11 +1184,13 @@ void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, Pr
         // If this is not the origin AS
         if (i > 1) {
             // Get the previous ASes relationship to current AS
-            if (as_on_path->providers->find(*(it - 1)) != as_on_path->providers->end()) {
+            if (from_as == NULL) {
+                broken_path = true;
+            } else if (as_on_path->provider_indices.contains(from_as->graph_index)) {
                 received_from = AS_REL_PROVIDER;
-            } else if (as_on_path->peers->find(*(it - 1)) != as_on_path->peers->end()) {
+            } else if (as_on_path->peer_indices.contains(from_as->graph_index)) {
                 received_from = AS_REL_PEER;
-            } else if (as_on_path->customers->find(*(it - 1)) != as_on_path->customers->end()) {
+            } else if (as_on_path->customer_indices.contains(from_as->graph_index)) {
                 received_from = AS_REL_CUSTOMER;
             } else {
                 broken_path = true;
@@ -496,9 +1213,6 @@ void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, Pr
                 // Position of previous AS on path
                 uint32_t prevPos = path_l - i + 1;
 
-                // Position of the current AS on path
-                uint32_t currPos = path_l - i;
-
                 // Tie breaker for equal timestamp
                 bool keep_first = true;
                 // Random tiebreak if enabled
@@ -507,11 +1221,10 @@ void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, Pr
                 }
 
                 // Skip announcement if there exists one with a higher priority
-                ASType *current_as = this->graph->ases->find(as_path->at(currPos))->second;
-                if (current_as->all_anns->find(prefix)->priority > priority) {
+                if (second_announcement.priority > priority) {
                     continue;
                 // If the new announcement has a higher priority, change keep_first to false to make sure we save it
-                } else if (current_as->all_anns->find(prefix)->priority < priority) {
+                } else if (second_announcement.priority < priority) {
                     keep_first = false;
                 }
 
@@ -562,19 +1275,11 @@ void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, Pr
                                                     true);
             // Send the announcement to the current AS
             as_on_path->process_announcement(ann, this->random_tiebraking);
-            if (this->graph->inverse_results != NULL) {
-                auto set = this->graph->inverse_results->find(
-                        std::pair<Prefix<PrefixType>,uint32_t>(ann.prefix, ann.origin));
-                // Remove the AS from the prefix's inverse results
-                if (set != this->graph->inverse_results->end()) {
-                    set->second->erase(as_on_path->asn);
-                }
-            }
         } else {
             // Report the broken path
             //std::cerr << "Broken path for " << *(it - 1) << ", " << *it << std::endl;
             
-            static int g_broken_path = 0;
+            static std::atomic<int> g_broken_path(0);
 
             // Log the part of path where break takes place
             // Logger::getInstance().log("Broken_Paths") << "Broken Path #" << g_broken_path << ", between these two ASes: " << *(it - 1) << ", " << *it;
@@ -585,49 +1290,250 @@ void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, Pr
 }
 
 template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType>
-void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::send_all_announcements(uint32_t asn, 
-                                                                                                        bool to_providers, 
-                                                                                                        bool to_peers, 
-                                                                                                        bool to_customers) {
-    // Get the AS that is sending it's announcements
-    auto *source_as = this->graph->ases->find(asn)->second;
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::propagate_up() {
+    std::vector<std::vector<ASType*>> ranks;
+    for (auto &rank : *this->graph->ranks_by_index) {
+        ranks.push_back(std::vector<ASType*>());
+        for (uint32_t index : rank) {
+            ranks.back().push_back(this->graph->as_at(index));
+        }
+    }
 
-    // If to_customers = true and the AS is multihomed, return now for efficiency
-    if (mh_mode == 1) {
-        // Check if AS is multihomed
-        if (source_as->customers->empty()) {
-            if (to_customers) {
-                return;
+    if (pull_propagation) {
+        std::vector<ASType*> senders;
+        // Pull from customers
+        for (auto &rank : ranks) {
+            for (ASType *as : rank) {
+                pull_announcements(as, AS_REL_CUSTOMER, senders);
+            }
+        }
+        // Pull from peers
+        for (auto &rank : ranks) {
+            for (ASType *as : rank) {
+                pull_announcements(as, AS_REL_PEER, senders);
             }
         }
+        return;
     }
 
-    // Don't propagate from multihomed
-    if (mh_mode == 2) {
-        // Check if AS is multihomed
-        if (source_as->customers->empty()) {
-            return;
+    if (!parallel_propagation) {
+        propagate_ranks(ranks, AS_REL_PROVIDER);
+        propagate_ranks(ranks, AS_REL_PEER);
+        return;
+    }
+
+    // Propagate to providers
+    propagate_ranks_parallel(ranks, AS_REL_PROVIDER);
+    // Propagate to peers
+    propagate_ranks_parallel(ranks, AS_REL_PEER);
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::propagate_down() {
+    // Top rank first, skipping the empty rank decide_ranks leaves at the end
+    std::vector<std::vector<ASType*>> ranks;
+    size_t levels = this->graph->ranks_by_index->size();
+    for (size_t level = levels-1; level-- > 0;) {
+        ranks.push_back(std::vector<ASType*>());
+        for (uint32_t index : this->graph->ranks_by_index->at(level)) {
+            ranks.back().push_back(this->graph->as_at(index));
         }
     }
 
-    // Only propagate to peers from multihomed
-    if (mh_mode == 3) {
-            // Check if AS is multihomed
-            if (source_as->customers->empty()) {
-                if (to_peers) {
-                    to_providers = false;
-                    to_customers = false;
-                } else {
-                    return;
+    if (pull_propagation) {
+        std::vector<ASType*> senders;
+        for (auto &rank : ranks) {
+            for (ASType *as : rank) {
+                pull_announcements(as, AS_REL_PROVIDER, senders);
+            }
+        }
+        return;
+    }
+
+    if (!parallel_propagation) {
+        propagate_ranks(ranks, AS_REL_CUSTOMER);
+        return;
+    }
+
+    propagate_ranks_parallel(ranks, AS_REL_CUSTOMER);
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::pull_announcements(ASType *recving_as, 
+                                                                                                    int relationship, 
+                                                                                                    std::vector<ASType*> &senders) {
+    // The push engine delivers in rank order (top down for providers), then by index
+    senders.clear();
+    for (uint32_t index : recving_as->neighbor_indices(relationship)) {
+        senders.push_back(this->graph->as_at(index));
+    }
+    if (relationship == AS_REL_PROVIDER) {
+        std::stable_sort(senders.begin(), senders.end(), [](ASType *a, ASType *b) { return a->rank > b->rank; });
+    } else {
+        std::stable_sort(senders.begin(), senders.end(), [](ASType *a, ASType *b) { return a->rank < b->rank; });
+    }
+
+    for (ASType *source_as : senders) {
+        if (source_as->all_anns->empty()) {
+            continue;
+        }
+
+        // Multihomed modes, same rules as assemble_announcements
+        bool multihomed = source_as->customer_indices.empty();
+        if ((mh_mode == 1 && multihomed && relationship == AS_REL_PROVIDER) ||
+            (mh_mode == 2 && multihomed) ||
+            (mh_mode == 3 && multihomed && relationship != AS_REL_PEER)) {
+            continue;
+        }
+
+        for (auto &ann : *source_as->all_anns) {
+            if (!source_as->all_anns->filled(ann)) {
+                continue;
+            }
+
+            // Only announcements from customers go to peers and providers
+            if (relationship != AS_REL_PROVIDER && ann.priority.relationship < 2) {
+                continue;
+            }
+
+            // Automatic multihomed mode, skip if a provider was seeded with this prefix-origin.
+            // Seeded announcements are all a provider holds when the push engine makes this check.
+            if (mh_mode == 1 && multihomed && relationship == AS_REL_CUSTOMER) {
+                bool provider_has_ann = false;
+                for (uint32_t provider_index : source_as->provider_indices) {
+                    auto *provider_as = this->graph->as_at(provider_index);
+                    auto search = provider_as->all_anns->find(ann.prefix);
+                    if (search != provider_as->all_anns->end() && search->from_monitor && search->origin == ann.origin) {
+                        provider_has_ann = true;
+                        break;
+                    }
                 }
-                
+                if (provider_has_ann) {
+                    continue;
+                }
+            }
+
+            // Announcements from monitors are never replaced
+            auto search = recving_as->all_anns->find(ann.prefix);
+            if (search != recving_as->all_anns->end() && search->from_monitor) {
+                continue;
             }
+
+            // Set the priority of the announcement at the receiver
+            Priority priority;
+            priority.relationship = relationship;
+            priority.path_length = ann.priority.path_length + 1;
+
+            AnnouncementType temp = AnnouncementType(ann);
+            temp.priority = priority;
+            temp.from_monitor = false;
+            temp.received_from_asn = source_as->asn;
+            recving_as->process_announcement(temp, this->random_tiebraking);
+        }
+    }
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::propagate_ranks(std::vector<std::vector<ASType*>> &ranks, 
+                                                                                                int relationship) {
+    for (auto &rank : ranks) {
+        for (ASType *source_as : rank) {
+            source_as->process_announcements(this->random_tiebraking);
+            if (source_as->all_anns->empty()) {
+                continue;
+            }
+            // Multihomed ASes don't send to customers in automatic mode
+            if (mh_mode == 1 && relationship == AS_REL_CUSTOMER && source_as->customer_indices.empty()) {
+                continue;
+            }
+            send_announcements(source_as, relationship);
+        }
+    }
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::propagate_ranks_parallel(std::vector<std::vector<ASType*>> &ranks, 
+                                                                                                            int relationship) {
+    int num_threads = this->max_workers > 1 ? this->max_workers : 1;
+
+    // Announcements assembled by each AS of the current rank
+    size_t widest = 0;
+    for (auto &rank : ranks) {
+        widest = std::max(widest, rank.size());
+    }
+    std::vector<std::vector<AnnouncementType>> outgoing(widest);
+
+    // Next unclaimed AS in each rank
+    std::unique_ptr<std::atomic<size_t>[]> next(new std::atomic<size_t>[ranks.size()]);
+    for (size_t level = 0; level < ranks.size(); level++) {
+        next[level] = 0;
+    }
+    boost::barrier rank_done(num_threads);
+
+    auto worker = [&](int thread_num) {
+        for (size_t level = 0; level < ranks.size(); level++) {
+            std::vector<ASType*> &rank = ranks[level];
+            
+            // Process and assemble, ASes are claimed one at a time to balance the load
+            for (size_t i = next[level]++; i < rank.size(); i = next[level]++) {
+                ASType *source_as = rank[i];
+                source_as->process_announcements(this->random_tiebraking);
+                outgoing[i].clear();
+                if (!source_as->all_anns->empty()) {
+                    assemble_announcements(source_as, relationship, outgoing[i]);
+                }
+            }
+            rank_done.wait();
+
+            // Deliver in the serial order, each thread only writes to the receivers it owns
+            for (size_t i = 0; i < rank.size(); i++) {
+                if (outgoing[i].empty()) {
+                    continue;
+                }
+                for (uint32_t neighbor_index : rank[i]->neighbor_indices(relationship)) {
+                    if (neighbor_index % num_threads == (uint32_t) thread_num) {
+                        this->graph->as_at(neighbor_index)->receive_announcements(outgoing[i]);
+                    }
+                }
+            }
+            rank_done.wait();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (int i = 1; i < num_threads; i++) {
+        threads.push_back(std::thread(worker, i));
+    }
+    worker(0);
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::assemble_announcements(ASType *source_as, 
+                                                                                                        int relationship, 
+                                                                                                        std::vector<AnnouncementType> &anns) {
+    // Check if AS is multihomed
+    bool multihomed = source_as->customer_indices.empty();
+
+    // Multihomed ASes don't propagate to customers for efficiency
+    if (mh_mode == 1 && multihomed && relationship == AS_REL_CUSTOMER) {
+        return;
+    }
+
+    // Don't propagate from multihomed
+    if (mh_mode == 2 && multihomed) {
+        return;
+    }
+
+    // Only propagate to peers from multihomed
+    if (mh_mode == 3 && multihomed && relationship != AS_REL_PEER) {
+        return;
     }
 
     // If we are sending to providers
-    if (to_providers) {
-        // Assemble the list of announcements to send to providers
-        std::vector<AnnouncementType> anns_to_providers;
+    if (relationship == AS_REL_PROVIDER) {
         for (auto &ann : *source_as->all_anns) {
             if(!source_as->all_anns->filled(ann))
                 continue;
@@ -646,10 +1552,10 @@ void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, Pr
             uint32_t providers_with_ann = 0;
             if (mh_mode == 1) {
                 // Check if AS is multihomed
-                if (source_as->customers->empty()) {
+                if (multihomed) {
                     // Check if all providers have the announcement
-                    for (uint32_t provider_asn : *source_as->providers) {
-                        auto *recving_as = this->graph->ases->find(provider_asn)->second;
+                    for (uint32_t provider_index : source_as->provider_indices) {
+                        auto *recving_as = this->graph->as_at(provider_index);
                         auto search = recving_as->all_anns->find(ann.prefix);
                         if (search != recving_as->all_anns->end() && search->origin == ann.origin) {
                             providers_with_ann++;
@@ -669,31 +1575,15 @@ void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, Pr
                 AnnouncementType temp = AnnouncementType(ann);
                 temp.priority = priority;
                 temp.from_monitor = false;
-                temp.received_from_asn = asn;
+                temp.received_from_asn = source_as->asn;
 
-                // Push announcement with new priority to ann vector
-                // anns_to_providers.push_back(AnnouncementType(ann.second.origin,
-                //                                          ann.second.prefix.addr,
-                //                                          ann.second.prefix.netmask,
-                //                                          priority,
-                //                                          asn,
-                //                                          ann.second.tstamp));
-
-                anns_to_providers.push_back(temp);
+                anns.push_back(temp);
             }
         }
-        // Send the vector of assembled announcements
-        for (uint32_t provider_asn : *source_as->providers) {
-            // For each provider, give the vector of announcements
-            auto *recving_as = this->graph->ases->find(provider_asn)->second;
-            recving_as->receive_announcements(anns_to_providers);
-        }
     }
 
     // If we are sending to peers
-    if (to_peers) {
-        // Assemble vector of announcement to send to peers
-        std::vector<AnnouncementType> anns_to_peers;
+    if (relationship == AS_REL_PEER) {
         for (auto &ann : *source_as->all_anns) {
             if(!source_as->all_anns->filled(ann))
                 continue;
@@ -710,33 +1600,18 @@ void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, Pr
             Priority priority;
             priority.relationship = 1;
             priority.path_length = ann.priority.path_length + 1;
-            
-            // anns_to_peers.push_back(AnnouncementType(ann.second.origin,
-            //                                             ann.second.prefix.addr,
-            //                                             ann.second.prefix.netmask,
-            //                                             priority,
-            //                                             asn,
-            //                                             ann.second.tstamp));
 
             AnnouncementType temp = AnnouncementType(ann);
             temp.priority = priority;
             temp.from_monitor = false;
-            temp.received_from_asn = asn;
+            temp.received_from_asn = source_as->asn;
 
-            anns_to_peers.push_back(temp);
-        }
-        // Send the vector of assembled announcements
-        for (uint32_t peer_asn : *source_as->peers) {
-            // For each provider, give the vector of announcements
-            auto *recving_as = this->graph->ases->find(peer_asn)->second;
-            recving_as->receive_announcements(anns_to_peers);
+            anns.push_back(temp);
         }
     }
 
     // If we are sending to customers
-    if (to_customers) {
-        // Assemble the vector of announcement for customers
-        std::vector<AnnouncementType> anns_to_customers;
+    if (relationship == AS_REL_CUSTOMER) {
         for (auto &ann : *source_as->all_anns) {
             if(!source_as->all_anns->filled(ann))
                 continue;
@@ -749,30 +1624,58 @@ void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, Pr
             Priority priority;
             priority.path_length = ann.priority.path_length + 1;
 
-            // anns_to_customers.push_back(AnnouncementType(ann.second.origin,
-            //                                                 ann.second.prefix.addr,
-            //                                                 ann.second.prefix.netmask,
-            //                                                 priority,
-            //                                                 asn,
-            //                                                 ann.second.tstamp));
-
             //Use the copy constructor so that the inherited copy constructor will be called as well
             AnnouncementType temp = AnnouncementType(ann);
             temp.priority = priority;
             temp.from_monitor = false;
-            temp.received_from_asn = asn;
+            temp.received_from_asn = source_as->asn;
 
-            anns_to_customers.push_back(temp);
-        }
-        // Send the vector of assembled announcements
-        for (uint32_t customer_asn : *source_as->customers) {
-            // For each customer, give the vector of announcements
-            auto *recving_as = this->graph->ases->find(customer_asn)->second;
-            recving_as->receive_announcements(anns_to_customers);
+            anns.push_back(temp);
         }
     }
 }
 
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::send_all_announcements(uint32_t asn, 
+                                                                                                        bool to_providers, 
+                                                                                                        bool to_peers, 
+                                                                                                        bool to_customers) {
+    // Get the AS that is sending it's announcements
+    auto *source_as = this->graph->find_as(asn);
+
+    // If to_customers = true and the AS is multihomed, return now for efficiency
+    if (mh_mode == 1 && source_as->customer_indices.empty() && to_customers) {
+        return;
+    }
+
+    // If we are sending to providers
+    if (to_providers) {
+        send_announcements(source_as, AS_REL_PROVIDER);
+    }
+
+    // If we are sending to peers
+    if (to_peers) {
+        send_announcements(source_as, AS_REL_PEER);
+    }
+
+    // If we are sending to customers
+    if (to_customers) {
+        send_announcements(source_as, AS_REL_CUSTOMER);
+    }
+}
+
+template <class SQLQuerierType, class GraphType, class AnnouncementType, class ASType, typename PrefixType>
+void BlockedExtrapolator<SQLQuerierType, GraphType, AnnouncementType, ASType, PrefixType>::send_announcements(ASType *source_as, 
+                                                                                                    int relationship) {
+    // Assemble the list of announcements to send
+    std::vector<AnnouncementType> anns;
+    assemble_announcements(source_as, relationship, anns);
+    // Give the vector of assembled announcements to each neighbor
+    for (uint32_t neighbor_index : source_as->neighbor_indices(relationship)) {
+        this->graph->as_at(neighbor_index)->receive_announcements(anns);
+    }
+}
+
 template class BlockedExtrapolator<SQLQuerier<>, ASGraph<>, Announcement<>, AS<>, uint32_t>;
 template class BlockedExtrapolator<SQLQuerier<uint128_t>, ASGraph<uint128_t>, Announcement<uint128_t>, AS<uint128_t>, uint128_t>;
 template class BlockedExtrapolator<EZSQLQuerier, EZASGraph, EZAnnouncement, EZAS, uint32_t>;
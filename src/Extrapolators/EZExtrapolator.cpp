@@ -95,13 +95,6 @@ void EZExtrapolator::perform_propagation() {
                 element.second->lowlink = 0;
                 element.second->visited = false;
                 element.second->member_ases->clear();
-
-                if(element.second->inverse_results != NULL) {
-                    for(auto i : *element.second->inverse_results)
-                        delete i.second;
-
-                    element.second->inverse_results->clear();
-                }
             }
 
             for(auto element : *graph->ases_by_rank)
@@ -138,8 +131,8 @@ void EZExtrapolator::perform_propagation() {
  * In addition, seeded announcement such as these don't need path propagation since they should not (very unlikely) have an attacker in the path...
  * Attackers are the only announcements that we need paths from, thus we don't need to build up the path as we seed the path
  */
-void EZExtrapolator::give_ann_to_as_path(std::vector<uint32_t>* as_path, Prefix<> prefix, int64_t timestamp /* = 0 */) {
-    BlockedExtrapolator::give_ann_to_as_path(as_path, prefix, timestamp);
+void EZExtrapolator::give_ann_to_as_path(std::vector<uint32_t>* as_path, Prefix<> prefix, int64_t timestamp /* = 0 */, const std::vector<uint32_t> *path_indices /* = NULL */) {
+    BlockedExtrapolator::give_ann_to_as_path(as_path, prefix, timestamp, path_indices);
     
     uint32_t path_origin_asn = as_path->at(as_path->size() - 1);
 
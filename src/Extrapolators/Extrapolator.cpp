@@ -40,11 +40,47 @@ Extrapolator<PrefixType>::Extrapolator(bool random_tiebraking,
                     bool origin_only,
                     std::vector<uint32_t> *full_path_asns,
                     int max_threads,
-                    bool select_block_id) : BlockedExtrapolator<SQLQuerier<PrefixType>, ASGraph<PrefixType>, Announcement<PrefixType>, AS<PrefixType>, PrefixType>
-                    (random_tiebraking, store_results, store_invert_results, store_depref_results, iteration_size, mh_mode, origin_only, full_path_asns, max_threads, select_block_id) {
+                    bool select_block_id,
+                    bool parallel_propagation,
+                    bool pull_propagation,
+                    uint32_t concurrent_blocks,
+                    bool bfs_rank_order,
+                    std::string snapshot_dir,
+                    uint32_t prefetch_blocks,
+                    std::string block_plan_dir,
+                    bool stream_results,
+                    std::string relationships_file,
+                    std::string announcements_file,
+                    std::string results_dir,
+                    std::string results_format,
+                    bool compress_results,
+                    std::string announcement_store,
+                    bool double_buffer_ribs) : BlockedExtrapolator<SQLQuerier<PrefixType>, ASGraph<PrefixType>, Announcement<PrefixType>, AS<PrefixType>, PrefixType>
+                    (random_tiebraking, store_results, store_invert_results, store_depref_results, iteration_size, mh_mode, origin_only, full_path_asns, max_threads, select_block_id, parallel_propagation, pull_propagation, concurrent_blocks, prefetch_blocks, block_plan_dir, double_buffer_ribs) {
 
     this->graph = new ASGraph<PrefixType>(store_invert_results, store_depref_results);
-    this->querier = new SQLQuerier<PrefixType>(announcement_table, results_table, inverse_results_table, depref_results_table, full_path_results_table, exclude_as_number, config_section);
+    this->graph->bfs_rank_order = bfs_rank_order;
+    this->graph->snapshot_dir = snapshot_dir;
+    // Reading from files and keeping the results in files needs no database
+    bool use_database = relationships_file.empty() || (announcements_file.empty() && announcement_store.empty()) || results_dir.empty();
+    this->querier = new SQLQuerier<PrefixType>(announcement_table, results_table, inverse_results_table, depref_results_table, full_path_results_table, exclude_as_number, config_section, 
+                                                DEFAULT_QUERIER_CONFIG_PATH, use_database);
+    this->querier->copy_from_stdin = stream_results;
+    if (!relationships_file.empty()) {
+        this->input = new FileInputSource<PrefixType>(relationships_file, announcements_file);
+    }
+    if (!announcement_store.empty()) {
+        this->announcement_store = new AnnouncementStore<PrefixType>(announcement_store);
+    }
+    this->results_dir = results_dir;
+    this->graph->results_dir = results_dir;
+    this->results_format = results_format;
+    this->compress_results = compress_results;
+    if (!results_dir.empty()) {
+        this->result_sink = new FileResultSink<PrefixType>(results_dir, results_format == "binary", compress_results);
+    } else if (stream_results) {
+        this->result_sink = new CopyResultSink<PrefixType>(this->querier, &this->writer_queriers);
+    }
 }
 
 template <typename PrefixType>
@@ -55,5 +91,29 @@ Extrapolator<PrefixType>::Extrapolator() : Extrapolator<PrefixType>(DEFAULT_RAND
 template <typename PrefixType>
 Extrapolator<PrefixType>::~Extrapolator() { }
 
+template <typename PrefixType>
+BlockedExtrapolator<SQLQuerier<PrefixType>, ASGraph<PrefixType>, Announcement<PrefixType>, AS<PrefixType>, PrefixType>* Extrapolator<PrefixType>::create_block_worker() {
+    // Split the threads saving results between the concurrent blocks
+    int max_threads = std::max(1, this->max_workers / (int) this->concurrent_blocks);
+
+    Extrapolator<PrefixType> *worker = new Extrapolator<PrefixType>(this->random_tiebraking, this->store_results, this->store_invert_results, this->store_depref_results, 
+                                            this->querier->announcements_table, this->querier->results_table, this->querier->inverse_results_table, 
+                                            this->querier->depref_table, this->querier->full_path_results_table, this->querier->config_section, 
+                                            this->iteration_size, this->querier->exclude_as_number, this->mh_mode, this->origin_only, this->full_path_asns, 
+                                            max_threads, this->select_block_id, this->parallel_propagation, this->pull_propagation, 
+                                            DEFAULT_CONCURRENT_BLOCKS, this->graph->bfs_rank_order, this->graph->snapshot_dir, 
+                                            DEFAULT_PREFETCH_BLOCKS, this->block_plan_dir, this->querier->copy_from_stdin, "", "", this->results_dir, 
+                                            this->results_format, this->compress_results, "", this->double_buffer_ribs);
+    worker->graph->share_topology(this->graph);
+    return worker;
+}
+
+template <typename PrefixType>
+SQLQuerier<PrefixType>* Extrapolator<PrefixType>::create_prefetch_querier() {
+    return new SQLQuerier<PrefixType>(this->querier->announcements_table, this->querier->results_table, this->querier->inverse_results_table, 
+                                        this->querier->depref_table, this->querier->full_path_results_table, this->querier->exclude_as_number, 
+                                        this->querier->config_section);
+}
+
 template class Extrapolator<>;
 template class Extrapolator<uint128_t>;
\ No newline at end of file
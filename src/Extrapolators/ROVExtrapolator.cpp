@@ -49,6 +49,11 @@ void ROVExtrapolator::extrapolate_blocks(uint32_t &announcement_count, int &iter
         announcement_count += bsize;
         
         BOOST_LOG_TRIVIAL(info) << "Seeding announcements...";
+        // Slot in the RIBs of each prefix_id in this block
+        std::unordered_map<uint32_t, uint32_t> prefix_slots;
+        static thread_local PathDecoder decoder;
+        size_t dropped = 0;
+
         // For all announcements in this block
         for (pqxx::result::size_type i = 0; i < bsize; i++) {
             // Get row origin
@@ -60,44 +65,38 @@ void ROVExtrapolator::extrapolate_blocks(uint32_t &announcement_count, int &iter
 
             uint32_t prefix_id;
             ann_block[i]["prefix_id"].to(prefix_id);
-            Prefix<> cur_prefix(ip, mask, prefix_id);
-            // Get row AS path
-            std::string path_as_string(ann_block[i]["as_path"].as<std::string>());
-            std::vector<uint32_t> *as_path = this->parse_path(path_as_string);
-            
-            // Check for loops in the path and drop announcement if they exist
-            bool loop = this->find_loop(as_path);
-            if (loop) {
+            // Number the prefixes of the block in the order they are seeded
+            uint32_t prefix_block_id;
+            if (!this->assign_slot(prefix_id, prefix_slots, prefix_block_id)) {
+                dropped++;
+                continue;
+            }
+            Prefix<> cur_prefix(ip, mask, prefix_id, prefix_block_id);
+            // Decode the AS path, dropping the announcement if it has a loop
+            if (!decoder.decode_path(ann_block[i]["as_path"].c_str(), *this->graph->asn_to_index)) {
                 continue;
             }
 
             // Get timestamp
-            int64_t timestamp = std::stol(ann_block[i]["time"].as<std::string>());
+            int64_t timestamp;
+            if (!PathDecoder::parse_int64(ann_block[i]["time"].c_str(), timestamp)) {
+                timestamp = std::stol(ann_block[i]["time"].as<std::string>());
+            }
 
             // Get validity of an announcement
             int32_t roa_validity = std::stol(ann_block[i]["roa_validity"].as<std::string>());
 
+            // The inverse results of the pair are computed from the RIBs when they are saved
             if(this->graph->inverse_results != NULL) {
-                // Assemble pair
-                auto prefix_origin = std::pair<Prefix<>, uint32_t>(cur_prefix, origin);
-                
-                // Insert the inverse results for this prefix
-                if (this->graph->inverse_results->find(prefix_origin) == this->graph->inverse_results->end()) {
-                    // This is horrifying
-                    this->graph->inverse_results->insert(std::pair<std::pair<Prefix<>, uint32_t>, 
-                                                            std::set<uint32_t>*>
-                                                            (prefix_origin, new std::set<uint32_t>()));
-                    
-                    // Put all non-stub ASNs in the set
-                    for (uint32_t asn : *this->graph->non_stubs) {
-                        this->graph->inverse_results->find(prefix_origin)->second->insert(asn);
-                    }
-                }
+                this->graph->inverse_results->add_seed(cur_prefix, origin);
             }
 
             // Seed announcements along AS path
-            this->give_ann_to_as_path(as_path, cur_prefix, timestamp, roa_validity);
-            delete as_path;
+            this->give_ann_to_as_path(&decoder.path, cur_prefix, timestamp, roa_validity);
+        }
+        if (dropped > 0) {
+            BOOST_LOG_TRIVIAL(error) << prefix->to_cidr() << " holds more prefixes than the " << this->graph->max_block_prefix_id 
+                                     << " slots of the RIBs, dropped " << dropped << " announcements";
         }
         // Propagate for this subnet
         BOOST_LOG_TRIVIAL(info) << "Propagating...";
@@ -122,6 +121,8 @@ void ROVExtrapolator::give_ann_to_as_path(std::vector<uint32_t>* as_path, Prefix
     uint32_t i = 0;
     uint32_t path_l = as_path->size();
     
+    // AS of the previous hop on the path, NULL if it is not in the graph
+    ROVAS *previous_as = NULL;
     // Iterate through path starting at the origin
     for (auto it = as_path->rbegin(); it != as_path->rend(); ++it) {
         // Only seed at origin AS if origin only mode is enabled
@@ -131,14 +132,15 @@ void ROVExtrapolator::give_ann_to_as_path(std::vector<uint32_t>* as_path, Prefix
 
         // Increments path length, including prepending
         i++;
+        // Find the current AS on the path. ASNs in the graph are never translated to a 
+        // supernode, members are removed from it and the supernode keeps the lowest ASN.
+        ROVAS *as_on_path = this->graph->find_as(*it);
+        ROVAS *from_as = previous_as;
+        previous_as = as_on_path;
         // If ASN not in graph, continue
-        if (this->graph->ases->find(*it) == this->graph->ases->end()) {
+        if (as_on_path == NULL) {
             continue;
         }
-        // Translate ASN to it's supernode
-        uint32_t asn_on_path = this->graph->translate_asn(*it);
-        // Find the current AS on the path
-        ROVAS *as_on_path = this->graph->ases->find(asn_on_path)->second;
 
         auto announcement_search = as_on_path->all_anns->find(prefix);
 
@@ -150,11 +152,13 @@ void ROVExtrapolator::give_ann_to_as_path(std::vector<uint32_t>* as_path, Prefix
         // If this is not the origin AS
         if (i > 1) {
             // Get the previous ASes relationship to current AS
-            if (as_on_path->providers->find(*(it - 1)) != as_on_path->providers->end()) {
+            if (from_as == NULL) {
+                broken_path = true;
+            } else if (as_on_path->provider_indices.contains(from_as->graph_index)) {
                 received_from = AS_REL_PROVIDER;
-            } else if (as_on_path->peers->find(*(it - 1)) != as_on_path->peers->end()) {
+            } else if (as_on_path->peer_indices.contains(from_as->graph_index)) {
                 received_from = AS_REL_PEER;
-            } else if (as_on_path->customers->find(*(it - 1)) != as_on_path->customers->end()) {
+            } else if (as_on_path->customer_indices.contains(from_as->graph_index)) {
                 received_from = AS_REL_CUSTOMER;
             } else {
                 broken_path = true;
@@ -178,9 +182,6 @@ void ROVExtrapolator::give_ann_to_as_path(std::vector<uint32_t>* as_path, Prefix
                 // Position of previous AS on path
                 uint32_t prevPos = path_l - i + 1;
 
-                // Position of the current AS on path
-                uint32_t currPos = path_l - i;
-
                 // Tie breaker for equal timestamp
                 bool keep_first = true;
                 // Random tiebreak if enabled
@@ -189,11 +190,10 @@ void ROVExtrapolator::give_ann_to_as_path(std::vector<uint32_t>* as_path, Prefix
                 }
 
                 // Skip announcement if there exists one with a higher priority
-                ROVAS *current_as = this->graph->ases->find(as_path->at(currPos))->second;
-                if (current_as->all_anns->find(prefix)->priority > priority) {
+                if (as_on_path->all_anns->find(prefix)->priority > priority) {
                     continue;
                 // If the new announcement has a higher priority, change keep_first to false to make sure we save it
-                } else if (current_as->all_anns->find(prefix)->priority < priority) {
+                } else if (as_on_path->all_anns->find(prefix)->priority < priority) {
                     keep_first = false;
                 }
 
@@ -225,7 +225,7 @@ void ROVExtrapolator::give_ann_to_as_path(std::vector<uint32_t>* as_path, Prefix
             if (roa_validity != 0 && roa_validity != 1) {
                 received_from_asn = HIJACKED_ASN;
                 // Mark this AS as an attacker
-                this->graph->add_attacker(asn_on_path);
+                this->graph->add_attacker(as_on_path->asn);
             } else {
                 received_from_asn = NOTHIJACKED_ASN;
             }
@@ -245,14 +245,6 @@ void ROVExtrapolator::give_ann_to_as_path(std::vector<uint32_t>* as_path, Prefix
 
             // Send the announcement to the current AS
             as_on_path->process_announcement(ann, this->random_tiebraking);
-            if (this->graph->inverse_results != NULL) {
-                auto set = this->graph->inverse_results->find(
-                        std::pair<Prefix<>,uint32_t>(ann.prefix, ann.origin));
-                // Remove the AS from the prefix's inverse results
-                if (set != this->graph->inverse_results->end()) {
-                    set->second->erase(as_on_path->asn);
-                }
-            }
         }
     }
 }
\ No newline at end of file
@@ -265,14 +265,6 @@ void ROVppExtrapolator::give_ann_to_as_path(std::vector<uint32_t>* as_path,
                                                         true);
             // Send the announcement to the current AS
             as_on_path->process_announcement(ann, false);
-            if (graph->inverse_results != NULL) {
-                auto set = graph->inverse_results->find(
-                        std::pair<Prefix<>,uint32_t>(ann.prefix, ann.origin));
-                // Remove the AS from the prefix's inverse results
-                if (set != graph->inverse_results->end()) {
-                    set->second->erase(as_on_path->asn);
-                }
-            }
         } else {
             // Report the broken path if desired
         }
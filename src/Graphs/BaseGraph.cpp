@@ -26,17 +26,42 @@
 #include <set>
 #include <vector>
 #include <stack>
+#include <queue>
+#include <unordered_set>
 #include <algorithm>
+#include <cstring>
+#include <stdexcept>
 #include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "Graphs/ASGraph.h"
 #include "ASes/AS.h"
 
 template <class ASType, typename PrefixType>
 BaseGraph<ASType, PrefixType>::~BaseGraph() {
-    for (auto const& as : *ases)
+    for (auto const& as : *ases) {
+        // Neighbor sets are deleted by the graph that owns them
+        if (shared_topology) {
+            as.second->providers = NULL;
+            as.second->peers = NULL;
+            as.second->customers = NULL;
+            as.second->member_ases = NULL;
+        }
         delete as.second;
+    }
     delete ases;
+    delete block_prefixes;
+    delete saved_block_prefixes;
+    delete ases_by_index;
+
+    if(saved_inverse_results != inverse_results)
+        delete saved_inverse_results;
+    delete inverse_results;
+
+    if (shared_topology) {
+        return;
+    }
     
     for (auto const& as : *ases_by_rank)
         delete as;
@@ -46,15 +71,76 @@ BaseGraph<ASType, PrefixType>::~BaseGraph() {
         delete c;
     delete components;
 
-    if(inverse_results != NULL) {
-        for (auto const& i : *inverse_results)
-            delete i.second;
-        delete inverse_results;
-    }
+    delete component_translation;
+    delete stubs_to_parents;
+    delete non_stubs;
+    delete asn_to_index;
+    delete ranks_by_index;
+    delete adjacency;
+
+    if (snapshot != NULL)
+        munmap(snapshot, snapshot_size);
+}
 
+template <class ASType, typename PrefixType>
+void BaseGraph<ASType, PrefixType>::share_topology(BaseGraph<ASType, PrefixType> *source) {
+    // Replace the empty structures from the constructor with the source's
+    for (auto const& as : *ases_by_rank)
+        delete as;
+    delete ases_by_rank;
+    for (auto const& c : *components)
+        delete c;
+    delete components;
     delete component_translation;
     delete stubs_to_parents;
     delete non_stubs;
+    delete asn_to_index;
+    delete ranks_by_index;
+    delete adjacency;
+
+    ases_by_rank = source->ases_by_rank;
+    components = source->components;
+    component_translation = source->component_translation;
+    stubs_to_parents = source->stubs_to_parents;
+    non_stubs = source->non_stubs;
+    asn_to_index = source->asn_to_index;
+    ranks_by_index = source->ranks_by_index;
+    adjacency = source->adjacency;
+    shared_topology = true;
+
+    // RIBs of the new ASes are sized from this
+    max_block_prefix_id = source->max_block_prefix_id;
+
+    ases->reserve(source->ases->size());
+    ases_by_index->assign(source->ases_by_index->size(), NULL);
+    for (auto const& as : *source->ases) {
+        ASType *shared_as = create_as(as.first);
+        delete shared_as->providers;
+        delete shared_as->peers;
+        delete shared_as->customers;
+        delete shared_as->member_ases;
+        shared_as->providers = as.second->providers;
+        shared_as->peers = as.second->peers;
+        shared_as->customers = as.second->customers;
+        shared_as->provider_indices = as.second->provider_indices;
+        shared_as->peer_indices = as.second->peer_indices;
+        shared_as->customer_indices = as.second->customer_indices;
+        shared_as->member_ases = as.second->member_ases;
+        shared_as->rank = as.second->rank;
+        shared_as->graph_index = as.second->graph_index;
+        if (as.second->graph_index < ases_by_index->size())
+            (*ases_by_index)[as.second->graph_index] = shared_as;
+        ases->insert(std::pair<uint32_t, ASType*>(as.first, shared_as));
+    }
+}
+
+template <class ASType, typename PrefixType>
+ASType* BaseGraph<ASType, PrefixType>::create_as(uint32_t asn) {
+    ASType *as = createNew(asn);
+    as->all_anns->share_prefixes(block_prefixes);
+    if (as->depref_anns != NULL)
+        as->depref_anns->share_prefixes(block_prefixes);
+    return as;
 }
 
 template <class ASType, typename PrefixType>
@@ -62,10 +148,63 @@ void BaseGraph<ASType, PrefixType>::clear_announcements() {
     for (auto const& as : *ases)
         as.second->clear_announcements();
 
-    if(inverse_results != NULL) {
-        for (auto const& i : *inverse_results)
-            delete i.second;
+    if(inverse_results != NULL)
         inverse_results->clear();
+}
+
+template <class ASType, typename PrefixType>
+void BaseGraph<ASType, PrefixType>::add_rib_generation() {
+    if (has_rib_generations())
+        return;
+    saved_block_prefixes = new std::vector<Prefix<PrefixType>>;
+    for (auto const& as : *ases)
+        as.second->add_generation(saved_block_prefixes);
+    if (inverse_results != NULL)
+        saved_inverse_results = new InverseResults<PrefixType>;
+}
+
+template <class ASType, typename PrefixType>
+void BaseGraph<ASType, PrefixType>::swap_rib_generations() {
+    if (!has_rib_generations()) {
+        clear_announcements();
+        return;
+    }
+    std::swap(block_prefixes, saved_block_prefixes);
+    for (auto const& as : *ases)
+        as.second->swap_generations();
+
+    if (inverse_results != NULL) {
+        std::swap(inverse_results, saved_inverse_results);
+        inverse_results->clear();
+    }
+}
+
+template <class ASType, typename PrefixType>
+void BaseGraph<ASType, PrefixType>::prepare_inverse_results() {
+    // Supernode members other than the supernode's own ASN stay in every pair, as no AS holds for them
+    inverse_ases.clear();
+    for (uint32_t position = 0; position < non_stubs->size(); position++) {
+        auto search = ases->find((*non_stubs)[position]);
+        if (search != ases->end())
+            inverse_ases.push_back(std::pair<uint32_t, ASType*>(position, search->second));
+    }
+    saved_inverse_results->prepare(non_stubs);
+}
+
+template <class ASType, typename PrefixType>
+void BaseGraph<ASType, PrefixType>::compute_inverse_results(int part, int num_parts) {
+    // This part owns the bits of positions from first up to last
+    size_t words = saved_inverse_results->num_words();
+    uint32_t first = (uint32_t) (words * part / num_parts * 64);
+    uint32_t last = (uint32_t) (words * (part + 1) / num_parts * 64);
+    auto it = std::lower_bound(inverse_ases.begin(), inverse_ases.end(), 
+                               std::pair<uint32_t, ASType*>(first, NULL));
+    for (; it != inverse_ases.end() && it->first < last; ++it) {
+        for (auto const& ann : *it->second->saved_anns) {
+            size_t pair = saved_inverse_results->find(ann.prefix, ann.origin);
+            if (pair != InverseResults<PrefixType>::npos)
+                saved_inverse_results->erase(pair, it->first);
+        }
     }
 }
 
@@ -77,7 +216,7 @@ void BaseGraph<ASType, PrefixType>::add_relationship(uint32_t asn,
     if (search == ases->end()) {
         // if AS not yet in graph, create it
         // ases->insert(std::pair<uint32_t, ASType*>(asn, new ASType(asn, inverse_results)));
-        ases->insert(std::pair<uint32_t, ASType*>(asn, createNew(asn)));
+        ases->insert(std::pair<uint32_t, ASType*>(asn, create_as(asn)));
         search = ases->find(asn);
     }
     search->second->add_neighbor(neighbor_asn, relation);
@@ -102,25 +241,311 @@ void BaseGraph<ASType, PrefixType>::process(SQLQuerier<PrefixType> *querier) {
 
 template <class ASType, typename PrefixType>
 void BaseGraph<ASType, PrefixType>::create_graph_from_db(SQLQuerier<PrefixType> *querier) {
-    // Assemble Peers
-    pqxx::result R = querier->select_from_table(PEERS_TABLE);
-    for (pqxx::result::const_iterator c = R.begin(); c!=R.end(); ++c){
-        add_relationship(c["peer_as_1"].as<uint32_t>(),
-                         c["peer_as_2"].as<uint32_t>(),AS_REL_PEER);
-        add_relationship(c["peer_as_2"].as<uint32_t>(),
-                         c["peer_as_1"].as<uint32_t>(),AS_REL_PEER);
+    std::string snapshot_key, snapshot_file;
+    if (!snapshot_dir.empty()) {
+        // Snapshots are laid out for one rank order, keep them apart
+        pqxx::result r = querier->select_relationships_hash();
+        snapshot_key = r[0][0].as<std::string>() + (bfs_rank_order ? "-bfs" : "");
+        snapshot_file = snapshot_dir + "/topology-" + snapshot_key + ".bin";
+        if (load_snapshot(snapshot_file, snapshot_key)) {
+            BOOST_LOG_TRIVIAL(info) << "Loaded topology snapshot " << snapshot_file;
+            save_stubs_to_db(querier);
+            save_non_stubs_to_db(querier);
+            save_supernodes_to_db(querier);
+            return;
+        }
     }
 
+    // Assemble Peers, a chunk at a time as they are streamed in
+    size_t streamed = 0;
+    size_t rows = querier->stream_from_table(PEERS_TABLE, "peer_as_1, peer_as_2", [this, &streamed](pqxx::result &R) {
+        streamed += R.size();
+        for (pqxx::result::const_iterator c = R.begin(); c!=R.end(); ++c){
+            add_relationship(c["peer_as_1"].as<uint32_t>(),
+                             c["peer_as_2"].as<uint32_t>(),AS_REL_PEER);
+            add_relationship(c["peer_as_2"].as<uint32_t>(),
+                             c["peer_as_1"].as<uint32_t>(),AS_REL_PEER);
+        }
+    });
+
     // Assemble Customer-Providers
-    R = querier->select_from_table(CUSTOMER_PROVIDER_TABLE);
-    for (pqxx::result::const_iterator c = R.begin(); c!=R.end(); ++c){
-        add_relationship(c["customer_as"].as<uint32_t>(),
-                         c["provider_as"].as<uint32_t>(),AS_REL_PROVIDER);
-        add_relationship(c["provider_as"].as<uint32_t>(),
-                         c["customer_as"].as<uint32_t>(),AS_REL_CUSTOMER);
+    rows += querier->stream_from_table(CUSTOMER_PROVIDER_TABLE, "customer_as, provider_as", [this, &streamed](pqxx::result &R) {
+        streamed += R.size();
+        for (pqxx::result::const_iterator c = R.begin(); c!=R.end(); ++c){
+            add_relationship(c["customer_as"].as<uint32_t>(),
+                             c["provider_as"].as<uint32_t>(),AS_REL_PROVIDER);
+            add_relationship(c["provider_as"].as<uint32_t>(),
+                             c["customer_as"].as<uint32_t>(),AS_REL_CUSTOMER);
+        }
+    });
+
+    // A query that failed part way left some relationships out, every block would be propagated wrong
+    if (rows != streamed) {
+        throw std::runtime_error("Failed to read the relationships from the database");
     }
 
     process(querier);
+
+    if (!snapshot_file.empty()) {
+        BOOST_LOG_TRIVIAL(info) << "Saving topology snapshot " << snapshot_file;
+        save_snapshot(snapshot_file, snapshot_key);
+    }
+}
+
+template <class ASType, typename PrefixType>
+void BaseGraph<ASType, PrefixType>::create_graph_from_input(InputSource<PrefixType> *input, SQLQuerier<PrefixType> *querier) {
+    std::string snapshot_key, snapshot_file;
+    if (!snapshot_dir.empty()) {
+        snapshot_key = input->relationships_version() + (bfs_rank_order ? "-bfs" : "");
+        snapshot_file = snapshot_dir + "/topology-" + snapshot_key + ".bin";
+        if (load_snapshot(snapshot_file, snapshot_key)) {
+            BOOST_LOG_TRIVIAL(info) << "Loaded topology snapshot " << snapshot_file;
+            save_stubs_to_db(querier);
+            save_non_stubs_to_db(querier);
+            save_supernodes_to_db(querier);
+            return;
+        }
+    }
+
+    input->read_relationships([this](uint32_t as_1, uint32_t as_2, bool peers) {
+        if (peers) {
+            add_relationship(as_1, as_2, AS_REL_PEER);
+            add_relationship(as_2, as_1, AS_REL_PEER);
+        } else {
+            // as_1 is the provider of as_2
+            add_relationship(as_2, as_1, AS_REL_PROVIDER);
+            add_relationship(as_1, as_2, AS_REL_CUSTOMER);
+        }
+    });
+
+    process(querier);
+
+    if (!snapshot_file.empty()) {
+        BOOST_LOG_TRIVIAL(info) << "Saving topology snapshot " << snapshot_file;
+        save_snapshot(snapshot_file, snapshot_key);
+    }
+}
+
+template <class ASType, typename PrefixType>
+bool BaseGraph<ASType, PrefixType>::save_snapshot(std::string file_name, std::string key) {
+    TopologySnapshotHeader header;
+    std::memset(&header, 0, sizeof(header));
+    std::strncpy(header.magic, TOPOLOGY_SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = TOPOLOGY_SNAPSHOT_VERSION;
+    std::strncpy(header.key, key.c_str(), sizeof(header.key) - 1);
+
+    std::vector<uint32_t> asns;
+    for (ASType *as : *ases_by_index)
+        asns.push_back(as->asn);
+    header.num_ases = asns.size();
+
+    // Ranks are consecutive runs of indices
+    std::vector<uint32_t> rank_offsets(1, 0);
+    for (auto &rank : *ranks_by_index)
+        rank_offsets.push_back(rank_offsets.back() + rank.size());
+    header.num_ranks = ranks_by_index->size();
+
+    std::vector<uint32_t> offsets[3], indices[3];
+    for (int relationship : {AS_REL_PROVIDER, AS_REL_PEER, AS_REL_CUSTOMER}) {
+        offsets[relationship].push_back(0);
+        for (ASType *as : *ases_by_index) {
+            IndexRange row = as->neighbor_indices(relationship);
+            indices[relationship].insert(indices[relationship].end(), row.begin(), row.end());
+            offsets[relationship].push_back(indices[relationship].size());
+        }
+        header.num_edges[relationship] = indices[relationship].size();
+    }
+
+    // Only supernodes are kept, single AS components have nothing to restore
+    std::vector<uint32_t> component_offsets(1, 0), component_members;
+    for (auto const& component : *components) {
+        if (component->size() <= 1)
+            continue;
+        component_members.insert(component_members.end(), component->begin(), component->end());
+        component_offsets.push_back(component_members.size());
+    }
+    header.num_components = component_offsets.size() - 1;
+    header.num_members = component_members.size();
+
+    std::vector<uint32_t> stubs;
+    for (auto &stub : *stubs_to_parents) {
+        stubs.push_back(stub.first);
+        stubs.push_back(stub.second);
+    }
+    header.num_stubs = stubs_to_parents->size();
+    header.num_non_stubs = non_stubs->size();
+
+    std::string tmp_name = file_name + ".tmp." + std::to_string(getpid());
+    std::ofstream outfile(tmp_name, std::ios::binary);
+    auto write = [&outfile](const std::vector<uint32_t> &v) {
+        outfile.write(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(uint32_t));
+    };
+    outfile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    write(asns);
+    write(rank_offsets);
+    for (int relationship : {AS_REL_PROVIDER, AS_REL_PEER, AS_REL_CUSTOMER}) {
+        write(offsets[relationship]);
+        write(indices[relationship]);
+    }
+    write(component_offsets);
+    write(component_members);
+    write(stubs);
+    write(*non_stubs);
+    outfile.close();
+
+    if (!outfile || std::rename(tmp_name.c_str(), file_name.c_str()) != 0) {
+        BOOST_LOG_TRIVIAL(warning) << "Could not write topology snapshot " << file_name;
+        std::remove(tmp_name.c_str());
+        return false;
+    }
+    return true;
+}
+
+template <class ASType, typename PrefixType>
+bool BaseGraph<ASType, PrefixType>::load_snapshot(std::string file_name, std::string key) {
+    if (!ases->empty() || shared_topology)
+        return false;
+
+    int fd = open(file_name.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t) st.st_size < sizeof(TopologySnapshotHeader)) {
+        close(fd);
+        return false;
+    }
+    size_t size = st.st_size;
+    void *mapping = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapping == MAP_FAILED)
+        return false;
+
+    const TopologySnapshotHeader &header = *static_cast<const TopologySnapshotHeader*>(mapping);
+    size_t words = (size_t) header.num_ases + 
+                   header.num_ranks + 1 + 
+                   3 * ((size_t) header.num_ases + 1) + header.num_edges[0] + header.num_edges[1] + header.num_edges[2] +
+                   header.num_components + 1 + header.num_members + 
+                   2 * (size_t) header.num_stubs + 
+                   header.num_non_stubs;
+    if (std::strncmp(header.magic, TOPOLOGY_SNAPSHOT_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != TOPOLOGY_SNAPSHOT_VERSION ||
+        std::strncmp(header.key, key.c_str(), sizeof(header.key)) != 0 ||
+        size != sizeof(header) + words * sizeof(uint32_t)) {
+        BOOST_LOG_TRIVIAL(warning) << "Ignoring mismatched topology snapshot " << file_name;
+        munmap(mapping, size);
+        return false;
+    }
+
+    const uint32_t *next = reinterpret_cast<const uint32_t*>(static_cast<const char*>(mapping) + sizeof(header));
+    auto take = [&next](size_t n) {
+        const uint32_t *array = next;
+        next += n;
+        return array;
+    };
+    const uint32_t *asns = take(header.num_ases);
+    const uint32_t *rank_offsets = take(header.num_ranks + 1);
+    const uint32_t *offsets[3], *indices[3];
+    for (int relationship : {AS_REL_PROVIDER, AS_REL_PEER, AS_REL_CUSTOMER}) {
+        offsets[relationship] = take(header.num_ases + 1);
+        indices[relationship] = take(header.num_edges[relationship]);
+    }
+    const uint32_t *component_offsets = take(header.num_components + 1);
+    const uint32_t *component_members = take(header.num_members);
+    const uint32_t *stubs = take(2 * (size_t) header.num_stubs);
+    const uint32_t *non_stub_asns = take(header.num_non_stubs);
+
+    // Offsets must run from 0 to the length of what they index without going back, 
+    // and indices must be below num_ases, or a corrupt snapshot reads out of bounds
+    auto valid_offsets = [](const uint32_t *offsets, size_t n, size_t end) {
+        if (offsets[0] != 0 || offsets[n] != end)
+            return false;
+        for (size_t i = 0; i < n; i++)
+            if (offsets[i] > offsets[i + 1])
+                return false;
+        return true;
+    };
+    bool valid = valid_offsets(rank_offsets, header.num_ranks, header.num_ases) &&
+                 valid_offsets(component_offsets, header.num_components, header.num_members);
+    for (int relationship : {AS_REL_PROVIDER, AS_REL_PEER, AS_REL_CUSTOMER}) {
+        valid = valid && valid_offsets(offsets[relationship], header.num_ases, header.num_edges[relationship]);
+        for (uint32_t e = 0; valid && e < header.num_edges[relationship]; e++)
+            valid = indices[relationship][e] < header.num_ases;
+    }
+    // Only supernodes are saved, none is empty
+    for (uint32_t c = 0; valid && c < header.num_components; c++)
+        valid = component_offsets[c] < component_offsets[c + 1];
+    if (!valid) {
+        BOOST_LOG_TRIVIAL(warning) << "Ignoring corrupt topology snapshot " << file_name;
+        munmap(mapping, size);
+        return false;
+    }
+
+    snapshot = mapping;
+    snapshot_size = size;
+
+    ases->reserve(header.num_ases);
+    ases_by_index->reserve(header.num_ases);
+    asn_to_index->reserve(header.num_ases);
+    for (uint32_t i = 0; i < header.num_ases; i++) {
+        ASType *as = create_as(asns[i]);
+        as->graph_index = i;
+        ases->insert(std::pair<uint32_t, ASType*>(asns[i], as));
+        ases_by_index->push_back(as);
+        asn_to_index->insert(std::pair<uint32_t, uint32_t>(asns[i], i));
+    }
+
+    for (auto const& rank : *ases_by_rank)
+        delete rank;
+    ases_by_rank->clear();
+    for (uint32_t rank = 0; rank < header.num_ranks; rank++) {
+        ases_by_rank->push_back(new std::set<uint32_t>());
+        ranks_by_index->push_back(std::vector<uint32_t>());
+        for (uint32_t i = rank_offsets[rank]; i < rank_offsets[rank + 1]; i++) {
+            (*ases_by_index)[i]->rank = rank;
+            ases_by_rank->back()->insert(asns[i]);
+            ranks_by_index->back().push_back(i);
+        }
+    }
+
+    // The rows stay in the mapping
+    for (ASType *as : *ases_by_index) {
+        uint32_t i = as->graph_index;
+        as->provider_indices = IndexRange(indices[AS_REL_PROVIDER] + offsets[AS_REL_PROVIDER][i], 
+                                          indices[AS_REL_PROVIDER] + offsets[AS_REL_PROVIDER][i + 1]);
+        as->peer_indices = IndexRange(indices[AS_REL_PEER] + offsets[AS_REL_PEER][i], 
+                                      indices[AS_REL_PEER] + offsets[AS_REL_PEER][i + 1]);
+        as->customer_indices = IndexRange(indices[AS_REL_CUSTOMER] + offsets[AS_REL_CUSTOMER][i], 
+                                          indices[AS_REL_CUSTOMER] + offsets[AS_REL_CUSTOMER][i + 1]);
+    }
+
+    // Supernodes are identified by their lowest ASN, as in combine_components
+    for (uint32_t c = 0; c < header.num_components; c++) {
+        std::vector<uint32_t> *component = new std::vector<uint32_t>(component_members + component_offsets[c], 
+                                                                     component_members + component_offsets[c + 1]);
+        components->push_back(component);
+        uint32_t combined_asn = *std::min_element(component->begin(), component->end());
+        ASType *combined_as = find_as(combined_asn);
+        for (uint32_t member_asn : *component) {
+            if (combined_as != NULL)
+                combined_as->member_ases->push_back(member_asn);
+            component_translation->insert(std::pair<uint32_t, uint32_t>(member_asn, combined_asn));
+        }
+    }
+
+    for (uint32_t i = 0; i < header.num_stubs; i++)
+        stubs_to_parents->insert(std::pair<uint32_t, uint32_t>(stubs[2 * i], stubs[2 * i + 1]));
+    non_stubs->assign(non_stub_asns, non_stub_asns + header.num_non_stubs);
+    return true;
+}
+
+template <class ASType, typename PrefixType>
+void BaseGraph<ASType, PrefixType>::fill_neighbor_sets() {
+    if (snapshot == NULL)
+        return;
+    for (ASType *as : *ases_by_index)
+        for (int relationship : {AS_REL_PROVIDER, AS_REL_PEER, AS_REL_CUSTOMER})
+            for (uint32_t index : as->neighbor_indices(relationship))
+                as->add_neighbor((*ases_by_index)[index]->asn, relationship);
 }
 
 template <class ASType, typename PrefixType>
@@ -171,15 +596,17 @@ void BaseGraph<ASType, PrefixType>::save_stubs_to_db(SQLQuerier<PrefixType> *que
 
     std::ofstream outfile;
     BOOST_LOG_TRIVIAL(info) << "Saving Stubs...";
-    std::string file_name = "/dev/shm/bgp/stubs.csv";
+    std::string file_name = results_dir.empty() ? "/dev/shm/bgp/stubs.csv" : results_dir + "/" + STUBS_TABLE + ".csv";
     outfile.open(file_name);
 
     for (auto &stub : *stubs_to_parents)
         outfile << stub.first << "," << stub.second << "\n";
     
     outfile.close();
-    querier->copy_stubs_to_db(file_name);
-    std::remove(file_name.c_str());
+    if (results_dir.empty()) {
+        querier->copy_stubs_to_db(file_name);
+        std::remove(file_name.c_str());
+    }
 }
 
 template <class ASType, typename PrefixType>
@@ -192,15 +619,17 @@ void BaseGraph<ASType, PrefixType>::save_non_stubs_to_db(SQLQuerier<PrefixType>
 
     std::ofstream outfile;
     BOOST_LOG_TRIVIAL(info) << "Saving Non-Stubs...";
-    std::string file_name = "/dev/shm/bgp/non-stubs.csv";
+    std::string file_name = results_dir.empty() ? "/dev/shm/bgp/non-stubs.csv" : results_dir + "/" + NON_STUBS_TABLE + ".csv";
     outfile.open(file_name);
 
     for (auto non_stub : *non_stubs)
         outfile << non_stub << "\n";
 
     outfile.close();
-    querier->copy_non_stubs_to_db(file_name);
-    std::remove(file_name.c_str());
+    if (results_dir.empty()) {
+        querier->copy_non_stubs_to_db(file_name);
+        std::remove(file_name.c_str());
+    }
 }
 
 template <class ASType, typename PrefixType>
@@ -213,7 +642,7 @@ void BaseGraph<ASType, PrefixType>::save_supernodes_to_db(SQLQuerier<PrefixType>
 
     std::ofstream outfile;
     BOOST_LOG_TRIVIAL(info) << "Saving Supernodes...";
-    std::string file_name = "/dev/shm/bgp/supernodes.csv";
+    std::string file_name = results_dir.empty() ? "/dev/shm/bgp/supernodes.csv" : results_dir + "/" + SUPERNODES_TABLE + ".csv";
     outfile.open(file_name); 
     
     // Iterate over each strongly connected components
@@ -233,47 +662,162 @@ void BaseGraph<ASType, PrefixType>::save_supernodes_to_db(SQLQuerier<PrefixType>
     }
 
     outfile.close();
-    querier->copy_supernodes_to_db(file_name);
-    std::remove(file_name.c_str());
+    if (results_dir.empty()) {
+        querier->copy_supernodes_to_db(file_name);
+        std::remove(file_name.c_str());
+    }
 }
 
 template <class ASType, typename PrefixType>
 void BaseGraph<ASType, PrefixType>::decide_ranks() {
+    for (auto const& rank : *ases_by_rank)
+        delete rank;
     ases_by_rank->clear();
 
-    // Initial set of customer ASes at the bottom of the DAG
-    ases_by_rank->push_back(new std::set<uint32_t>());
-    // For ASes with no customers
+    // Longest path from the bottom of the DAG, ranking each AS once all its customers are ranked
+    std::unordered_map<uint32_t, uint32_t> unranked_customers;
+    unranked_customers.reserve(ases->size());
+    std::vector<ASType*> ready;
     for (auto &as : *ases) {
+        as.second->rank = -1;
         // If AS is a leaf node
         if (as.second->customers->empty()) {
-            (*ases_by_rank)[0]->insert(as.first);
             as.second->rank = 0;
+            ready.push_back(as.second);
+            continue;
         }
+        uint32_t count = 0;
+        for (uint32_t customer_asn : *as.second->customers)
+            if (ases->find(translate_asn(customer_asn)) != ases->end())
+                count++;
+        unranked_customers[as.first] = count;
     }
-    
-    int i = 0;
-    // While there are elements to process current rank
-    while (!(*ases_by_rank)[i]->empty()) {
+
+    int max_rank = -1;
+    // ready grows as providers run out of unranked customers
+    for (size_t i = 0; i < ready.size(); i++) {
+        ASType *as = ready[i];
+        max_rank = std::max(max_rank, as->rank);
+        for (uint32_t provider_asn : *as->providers) {
+            auto search = ases->find(translate_asn(provider_asn));
+            if (search == ases->end())
+                continue;
+            ASType *prov_AS = search->second;
+            prov_AS->rank = std::max(prov_AS->rank, as->rank + 1);
+            if (--unranked_customers[prov_AS->asn] == 0)
+                ready.push_back(prov_AS);
+        }
+    }
+
+    // One set per rank, and an empty one above the top rank
+    for (int rank = 0; rank <= max_rank + 1; rank++)
         ases_by_rank->push_back(new std::set<uint32_t>());
-        for (uint32_t asn : *(*ases_by_rank)[i]) {
-            //For all providers of this AS
-            for (const uint32_t &provider_asn : *ases->find(asn)->second->providers) {
-                ASType* prov_AS = ases->find(translate_asn(provider_asn))->second;
-                int oldrank = prov_AS->rank;
-                // Move provider up to next rank
-                if (oldrank < i + 1) {
-                    prov_AS->rank = i + 1;
-                    (*ases_by_rank)[i+1]->insert(provider_asn);
-                    if (oldrank != -1) {
-                        (*ases_by_rank)[oldrank]->erase(provider_asn);
-                    }
+    for (ASType *as : ready)
+        (*ases_by_rank)[as->rank]->insert(as->asn);
+
+    index_ases();
+    return;
+}
+
+template <class ASType, typename PrefixType>
+void BaseGraph<ASType, PrefixType>::index_ases() {
+    ases_by_index->clear();
+    asn_to_index->clear();
+    ranks_by_index->clear();
+    ases_by_index->reserve(ases->size());
+    asn_to_index->reserve(ases->size());
+
+    auto add = [this](uint32_t asn, ASType *as) {
+        as->graph_index = ases_by_index->size();
+        ases_by_index->push_back(as);
+        asn_to_index->insert(std::pair<uint32_t, uint32_t>(asn, as->graph_index));
+    };
+
+    // Order in which the ASes of each rank are swept
+    std::vector<std::vector<uint32_t>> order(ases_by_rank->size());
+    if (bfs_rank_order) {
+        std::unordered_map<uint32_t, uint32_t> rank_of;
+        for (uint32_t rank = 0; rank < ases_by_rank->size(); rank++)
+            for (uint32_t asn : *(*ases_by_rank)[rank])
+                rank_of.insert(std::pair<uint32_t, uint32_t>(asn, rank));
+
+        // Search down from the ASes without providers, highest rank first
+        std::queue<uint32_t> queue;
+        std::unordered_set<uint32_t> discovered;
+        for (uint32_t rank = ases_by_rank->size(); rank-- > 0;) {
+            for (uint32_t asn : *(*ases_by_rank)[rank]) {
+                auto search = ases->find(asn);
+                if (search != ases->end() && search->second->providers->empty()) {
+                    discovered.insert(asn);
+                    queue.push(asn);
                 }
             }
         }
-        i++;
+        while (!queue.empty()) {
+            uint32_t asn = queue.front();
+            queue.pop();
+            order[rank_of[asn]].push_back(asn);
+            for (uint32_t customer_asn : *ases->find(asn)->second->customers) {
+                if (rank_of.count(customer_asn) && discovered.insert(customer_asn).second)
+                    queue.push(customer_asn);
+            }
+        }
+        // ASes the search did not reach follow in ASN order
+        for (uint32_t rank = 0; rank < ases_by_rank->size(); rank++)
+            for (uint32_t asn : *(*ases_by_rank)[rank])
+                if (discovered.insert(asn).second)
+                    order[rank].push_back(asn);
+    } else {
+        for (uint32_t rank = 0; rank < ases_by_rank->size(); rank++)
+            order[rank].assign((*ases_by_rank)[rank]->begin(), (*ases_by_rank)[rank]->end());
+    }
+
+    // ASes of a rank are consecutive, in the order the rank is swept
+    for (auto &rank : order) {
+        ranks_by_index->push_back(std::vector<uint32_t>());
+        for (uint32_t asn : rank) {
+            auto search = ases->find(asn);
+            if (search == ases->end() || asn_to_index->find(asn) != asn_to_index->end())
+                continue;
+            add(asn, search->second);
+            ranks_by_index->back().push_back(search->second->graph_index);
+        }
+    }
+    // ASes left without a rank are not propagated, but still need an index
+    for (auto const& as : *ases) {
+        if (asn_to_index->find(as.first) == asn_to_index->end())
+            add(as.first, as.second);
+    }
+
+    // Freeze the neighbor sets into one compressed sparse row table per relationship
+    for (int relationship : {AS_REL_PROVIDER, AS_REL_PEER, AS_REL_CUSTOMER}) {
+        std::vector<uint32_t> &offsets = adjacency->at(relationship).offsets;
+        std::vector<uint32_t> &indices = adjacency->at(relationship).indices;
+        offsets.assign(1, 0);
+        indices.clear();
+        for (ASType *as : *ases_by_index) {
+            std::set<uint32_t> *neighbors = as->providers;
+            if (relationship == AS_REL_PEER)
+                neighbors = as->peers;
+            else if (relationship == AS_REL_CUSTOMER)
+                neighbors = as->customers;
+            for (uint32_t neighbor_asn : *neighbors) {
+                auto search = asn_to_index->find(neighbor_asn);
+                if (search != asn_to_index->end())
+                    indices.push_back(search->second);
+            }
+            std::sort(indices.begin() + offsets.back(), indices.end());
+            offsets.push_back(indices.size());
+        }
+    }
+
+    // Point the ASes at their rows, now that the tables are no longer growing
+    for (ASType *as : *ases_by_index) {
+        uint32_t i = as->graph_index;
+        as->provider_indices = adjacency->at(AS_REL_PROVIDER).row(i);
+        as->peer_indices = adjacency->at(AS_REL_PEER).row(i);
+        as->customer_indices = adjacency->at(AS_REL_CUSTOMER).row(i);
     }
-    return;
 }
 
 template <class ASType, typename PrefixType>
@@ -289,44 +833,68 @@ void BaseGraph<ASType, PrefixType>::tarjan() {
 
 template <class ASType, typename PrefixType>
 void BaseGraph<ASType, PrefixType>::tarjan_helper(ASType *as, int &index, std::stack<ASType*> &s) {
-    as->index = index;
-    as->lowlink = index;
-    index++;
-    s.push(as);
-    as->onStack = true;
-    
-    for (auto &neighbor : *(as->providers)) {
-        ASType *n = ases->find(neighbor)->second;
-        if (n->index == -1) {
-            tarjan_helper(n, index, s);
-            as->lowlink = std::min(as->lowlink, n->lowlink);
-        } else if (n->onStack) {
-            as->lowlink = std::min(as->lowlink, n->index);
+    // Explicit call stack, provider chains can be deeper than the thread's stack
+    std::vector<std::pair<ASType*, std::set<uint32_t>::iterator>> calls;
+    auto visit = [&](ASType *v) {
+        v->index = index;
+        v->lowlink = index;
+        index++;
+        s.push(v);
+        v->onStack = true;
+        calls.push_back(std::make_pair(v, v->providers->begin()));
+    };
+    visit(as);
+
+    while (!calls.empty()) {
+        ASType *v = calls.back().first;
+        auto &next = calls.back().second;
+        if (next != v->providers->end()) {
+            ASType *n = ases->find(*next)->second;
+            ++next;
+            if (n->index == -1) {
+                visit(n);
+            } else if (n->onStack) {
+                v->lowlink = std::min(v->lowlink, n->index);
+            }
+            continue;
+        }
+        calls.pop_back();
+
+        if (v->lowlink == v->index) {
+            std::vector<uint32_t> *component = new std::vector<uint32_t>;
+            ASType *as_from_stack;
+            do {
+                as_from_stack = s.top();
+                s.pop();
+                as_from_stack->onStack = false;
+                component->push_back(as_from_stack->asn);
+            } while (as_from_stack != v);
+            components->push_back(component);
+        }
+        // Return to the caller
+        if (!calls.empty()) {
+            ASType *caller = calls.back().first;
+            caller->lowlink = std::min(caller->lowlink, v->lowlink);
         }
-    }
-
-    if (as->lowlink == as->index) {
-        std::vector<uint32_t> *component = new std::vector<uint32_t>;
-        ASType *as_from_stack;
-        do {
-            as_from_stack = s.top();
-            s.pop();
-            as_from_stack->onStack = false;
-            component->push_back(as_from_stack->asn);
-        } while (as_from_stack != as);
-        /** TODO Add logging here
-        if (component->size() > 1)
-            std::cout << "Supernode found of size " << component->size() << std::endl;
-        */
-        components->push_back(component);
     }
 }
 
 template <class ASType, typename PrefixType>
 void BaseGraph<ASType, PrefixType>::combine_components() {
+    // Component of each AS in a supernode, so membership is one lookup
+    std::unordered_map<uint32_t, size_t> component_of;
+    for (size_t c = 0; c < components->size(); c++)
+        if ((*components)[c]->size() > 1)
+            for (uint32_t asn : *(*components)[c])
+                component_of[asn] = c;
+    auto in_component = [&component_of](uint32_t asn, size_t c) {
+        auto search = component_of.find(asn);
+        return search != component_of.end() && search->second == c;
+    };
     
     // For each strongly connected component
-    for (auto const& component : *components) {
+    for (size_t c = 0; c < components->size(); c++) {
+        std::vector<uint32_t> *component = (*components)[c];
         // Ignore single AS nodes
         if (component->size() <= 1)
             continue;
@@ -339,7 +907,7 @@ void BaseGraph<ASType, PrefixType>::combine_components() {
 
         // Combined Component will id as lowest ASN
         // AS *combined_AS = new AS(combined_asn, inverse_results);
-        ASType *combined_AS = createNew(combined_asn);
+        ASType *combined_AS = create_as(combined_asn);
         
         // For all members of a component, gather neighbors
         for (auto &cur_asn : *component) {
@@ -351,9 +919,7 @@ void BaseGraph<ASType, PrefixType>::combine_components() {
             // Handle providers
             for (auto &provider_asn : *cur_AS->providers) {
                 // Check if provider is in component
-                bool external = (std::find(component->begin(), 
-                                           component->end(), 
-                                           provider_asn) == component->end());
+                bool external = !in_component(provider_asn, c);
                 if (external) {
                     ASType *provider_AS = ases->find(provider_asn)->second;
                     // Add new relationship
@@ -371,9 +937,7 @@ void BaseGraph<ASType, PrefixType>::combine_components() {
             // Handle customers
             for (auto &customer_asn : *cur_AS->customers) {
                 // Check if customer is in component
-                bool external = (std::find(component->begin(), 
-                                           component->end(), 
-                                           customer_asn) == component->end());
+                bool external = !in_component(customer_asn, c);
                 if (external) {
                     ASType *customer_AS = ases->find(customer_asn)->second;
                     // Add new relationship
@@ -391,9 +955,7 @@ void BaseGraph<ASType, PrefixType>::combine_components() {
             // Handle peers
             for (auto &peer_asn: *cur_AS->peers) {
                 // Check if peer is in component
-                bool external = (std::find(component->begin(), 
-                                      component->end(), 
-                                      peer_asn) == component->end());
+                bool external = !in_component(peer_asn, c);
                 // Check if peer is already a provider in the combined AS
                 bool no_provider_rel = (combined_AS->providers->find(peer_asn) ==
                                         combined_AS->providers->end());
@@ -0,0 +1,214 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include <cstring>
+#include <algorithm>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <boost/log/trivial.hpp>
+
+#include "InputSources/AnnouncementStore.h"
+
+static_assert(sizeof(AnnouncementStoreHeader) <= ANNOUNCEMENT_STORE_HEADER_SIZE, "header does not fit");
+
+template <typename PrefixType>
+AnnouncementStore<PrefixType>::AnnouncementStore(std::string file_name) {
+    this->file_name = file_name;
+    header = NULL;
+    blocks = NULL;
+    anns = NULL;
+    asns = NULL;
+    mapping = NULL;
+    mapped_size = 0;
+}
+
+template <typename PrefixType>
+AnnouncementStore<PrefixType>::~AnnouncementStore() {
+    close();
+}
+
+template <typename PrefixType>
+bool AnnouncementStore<PrefixType>::open() {
+    close();
+    int fd = ::open(file_name.c_str(), O_RDONLY);
+    struct stat st;
+    if (fd == -1 || fstat(fd, &st) != 0 || (size_t) st.st_size < ANNOUNCEMENT_STORE_HEADER_SIZE) {
+        BOOST_LOG_TRIVIAL(error) << "Failed to open announcement store: " << file_name;
+        if (fd != -1) {
+            ::close(fd);
+        }
+        return false;
+    }
+    mapped_size = st.st_size;
+    mapping = mmap(NULL, mapped_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        BOOST_LOG_TRIVIAL(error) << "Failed to map announcement store: " << file_name;
+        mapping = NULL;
+        return false;
+    }
+    // Blocks are seeded in order
+    madvise(mapping, mapped_size, MADV_SEQUENTIAL);
+
+    const char *base = (const char*) mapping;
+    header = (const AnnouncementStoreHeader*) base;
+    bool valid = std::strncmp(header->magic, ANNOUNCEMENT_STORE_MAGIC, sizeof(header->magic)) == 0 &&
+                 header->version == ANNOUNCEMENT_STORE_VERSION && header->prefix_bytes == sizeof(PrefixType) &&
+                 header->anns_offset + header->num_anns * sizeof(StoredAnnouncement<PrefixType>) <= header->asns_offset &&
+                 header->asns_offset + header->num_asns * sizeof(uint32_t) <= header->blocks_offset &&
+                 header->blocks_offset + header->num_blocks * sizeof(StoredBlock) <= mapped_size;
+    if (!valid) {
+        BOOST_LOG_TRIVIAL(error) << "Ignoring mismatched or truncated announcement store " << file_name;
+        close();
+        return false;
+    }
+    blocks = (const StoredBlock*) (base + header->blocks_offset);
+    anns = (const StoredAnnouncement<PrefixType>*) (base + header->anns_offset);
+    asns = (const uint32_t*) (base + header->asns_offset);
+    for (uint64_t i = 0; i < header->num_blocks; i++) {
+        if (blocks[i].first_ann > header->num_anns || blocks[i].num_anns > header->num_anns - blocks[i].first_ann) {
+            BOOST_LOG_TRIVIAL(error) << "Ignoring announcement store " << file_name << ", block " << i << " is out of range";
+            close();
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename PrefixType>
+void AnnouncementStore<PrefixType>::close() {
+    if (mapping != NULL) {
+        munmap(mapping, mapped_size);
+    }
+    mapping = NULL;
+    mapped_size = 0;
+    header = NULL;
+    blocks = NULL;
+    anns = NULL;
+    asns = NULL;
+}
+
+template <typename PrefixType>
+AnnouncementStoreWriter<PrefixType>::AnnouncementStoreWriter(std::string file_name) {
+    this->file_name = file_name;
+    tmp_name = file_name + ".tmp." + std::to_string(getpid());
+    file = NULL;
+    asns_file = NULL;
+    std::memset(&header, 0, sizeof(header));
+    block_start = 0;
+}
+
+template <typename PrefixType>
+AnnouncementStoreWriter<PrefixType>::~AnnouncementStoreWriter() {
+    // Only left open if close was never called
+    if (file != NULL) {
+        std::fclose(file);
+        std::remove(tmp_name.c_str());
+    }
+    if (asns_file != NULL) {
+        std::fclose(asns_file);
+    }
+}
+
+template <typename PrefixType>
+bool AnnouncementStoreWriter<PrefixType>::open() {
+    file = std::fopen(tmp_name.c_str(), "wb");
+    asns_file = std::tmpfile();
+    if (file == NULL || asns_file == NULL) {
+        BOOST_LOG_TRIVIAL(error) << "Failed to create announcement store: " << file_name;
+        return false;
+    }
+    std::memcpy(header.magic, ANNOUNCEMENT_STORE_MAGIC, sizeof(header.magic));
+    header.version = ANNOUNCEMENT_STORE_VERSION;
+    header.prefix_bytes = sizeof(PrefixType);
+    header.anns_offset = ANNOUNCEMENT_STORE_HEADER_SIZE;
+    // The header is written last, once the counts are known
+    std::fseek(file, ANNOUNCEMENT_STORE_HEADER_SIZE, SEEK_SET);
+    return true;
+}
+
+template <typename PrefixType>
+void AnnouncementStoreWriter<PrefixType>::add(const Prefix<PrefixType> &prefix, uint32_t origin, int64_t timestamp, const uint32_t *path, uint32_t path_length) {
+    StoredAnnouncement<PrefixType> ann;
+    std::memset(&ann, 0, sizeof(ann));
+    ann.addr = prefix.addr;
+    ann.netmask = prefix.netmask;
+    ann.prefix_id = prefix.id;
+    ann.block_prefix_id = prefix.block_id;
+    ann.origin = origin;
+    ann.path_length = path_length;
+    ann.path_start = header.num_asns;
+    ann.timestamp = timestamp;
+    std::fwrite(&ann, sizeof(ann), 1, file);
+    std::fwrite(path, sizeof(uint32_t), path_length, asns_file);
+    header.num_anns++;
+    header.num_asns += path_length;
+    header.max_block_prefix_id = std::max(header.max_block_prefix_id, prefix.block_id + 1);
+}
+
+template <typename PrefixType>
+void AnnouncementStoreWriter<PrefixType>::end_block(uint64_t rows) {
+    blocks.push_back(StoredBlock{block_start, header.num_anns - block_start, rows});
+    block_start = header.num_anns;
+}
+
+template <typename PrefixType>
+bool AnnouncementStoreWriter<PrefixType>::close() {
+    // The announcements are a multiple of 8 bytes, so the ASN pool and blocks stay aligned
+    header.num_blocks = blocks.size();
+    header.asns_offset = header.anns_offset + header.num_anns * sizeof(StoredAnnouncement<PrefixType>);
+    header.blocks_offset = header.asns_offset + header.num_asns * sizeof(uint32_t);
+    header.blocks_offset += header.blocks_offset % 8;
+
+    std::vector<char> buffer(1 << 20);
+    size_t n;
+    std::rewind(asns_file);
+    while ((n = std::fread(buffer.data(), 1, buffer.size(), asns_file)) > 0) {
+        std::fwrite(buffer.data(), 1, n, file);
+    }
+    std::fclose(asns_file);
+    asns_file = NULL;
+
+    std::fseek(file, header.blocks_offset, SEEK_SET);
+    std::fwrite(blocks.data(), sizeof(StoredBlock), blocks.size(), file);
+    std::fseek(file, 0, SEEK_SET);
+    std::fwrite(&header, sizeof(header), 1, file);
+    bool failed = std::ferror(file) != 0;
+    failed |= std::fclose(file) != 0;
+    file = NULL;
+
+    if (failed || std::rename(tmp_name.c_str(), file_name.c_str()) != 0) {
+        BOOST_LOG_TRIVIAL(error) << "Could not write announcement store " << file_name;
+        std::remove(tmp_name.c_str());
+        return false;
+    }
+    BOOST_LOG_TRIVIAL(info) << "Compiled " << header.num_anns << " announcements in " << header.num_blocks << " blocks into " << file_name;
+    return true;
+}
+
+template class AnnouncementStore<>;
+template class AnnouncementStore<uint128_t>;
+template class AnnouncementStoreWriter<>;
+template class AnnouncementStoreWriter<uint128_t>;
@@ -0,0 +1,310 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include <cstring>
+#include <cstdlib>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <boost/log/trivial.hpp>
+
+#include "InputSources/FileInputSource.h"
+#include "PathDecoder.h"
+
+/** Splits the next field off of a line, NUL terminating it in place.
+ *
+ *  A field starting with a double quote runs to the closing quote, so quoted as_paths 
+ *  may hold the delimiter.
+ *
+ *  @param cursor Start of the field, moved past its delimiter
+ *  @param delimiter Field delimiter
+ *  @return The field, or NULL if the line has no more fields
+ */
+static char* next_field(char *&cursor, char delimiter) {
+    if (cursor == NULL) {
+        return NULL;
+    }
+    char *field = cursor;
+    char *end;
+    if (*field == '"') {
+        field++;
+        end = std::strchr(field, '"');
+        if (end == NULL) {
+            return NULL;
+        }
+        *end++ = '\0';
+        cursor = *end == delimiter ? end + 1 : NULL;
+        return field;
+    }
+    end = std::strchr(field, delimiter);
+    if (end == NULL) {
+        cursor = NULL;
+    } else {
+        *end = '\0';
+        cursor = end + 1;
+    }
+    return field;
+}
+
+/** Trims the line ending off of a line read by getline.
+ */
+static void trim_line(char *line, ssize_t length) {
+    while (length > 0 && (line[length - 1] == '\n' || line[length - 1] == '\r')) {
+        line[--length] = '\0';
+    }
+}
+
+template <typename PrefixType>
+FileInputSource<PrefixType>::FileInputSource(std::string relationships_file, std::string announcements_file) {
+    this->relationships_file = relationships_file;
+    this->announcements_file = announcements_file;
+    announcements = NULL;
+    line = NULL;
+    line_capacity = 0;
+    pending = false;
+    row_path = NULL;
+    row_origin = 0;
+    row_timestamp = 0;
+    next_prefix_id = 0;
+    skipped_rows = 0;
+}
+
+template <typename PrefixType>
+FileInputSource<PrefixType>::~FileInputSource() {
+    if (announcements != NULL) {
+        std::fclose(announcements);
+    }
+    std::free(line);
+}
+
+template <typename PrefixType>
+std::string FileInputSource<PrefixType>::relationships_version() {
+    struct stat st;
+    if (stat(relationships_file.c_str(), &st) != 0) {
+        return "";
+    }
+    // Changes whenever the file is replaced or modified
+    return "file-" + std::to_string(st.st_ino) + "-" + std::to_string(st.st_size) + "-" + std::to_string(st.st_mtime);
+}
+
+template <typename PrefixType>
+void FileInputSource<PrefixType>::read_relationships(const typename InputSource<PrefixType>::RelationshipCallback &add) {
+    FILE *file = std::fopen(relationships_file.c_str(), "r");
+    if (file == NULL) {
+        BOOST_LOG_TRIVIAL(error) << "Failed to open relationships file: " << relationships_file;
+        return;
+    }
+
+    char *rel_line = NULL;
+    size_t capacity = 0;
+    ssize_t length;
+    size_t relationships = 0, skipped = 0;
+    while ((length = getline(&rel_line, &capacity, file)) != -1) {
+        trim_line(rel_line, length);
+        if (rel_line[0] == '#' || rel_line[0] == '\0') {
+            continue;
+        }
+        uint32_t as_1, as_2;
+        int relationship;
+        if (!parse_relationship(rel_line, as_1, as_2, relationship)) {
+            skipped++;
+            continue;
+        }
+        add(as_1, as_2, relationship == 0);
+        relationships++;
+    }
+    std::free(rel_line);
+    std::fclose(file);
+
+    BOOST_LOG_TRIVIAL(info) << "Read " << relationships << " relationships from " << relationships_file;
+    if (skipped > 0) {
+        BOOST_LOG_TRIVIAL(error) << "Skipped " << skipped << " malformed relationships";
+    }
+}
+
+template <typename PrefixType>
+bool FileInputSource<PrefixType>::parse_relationship(char *line, uint32_t &as_1, uint32_t &as_2, int &relationship) {
+    if (line[0] == '#') {
+        return false;
+    }
+    char delimiter = std::strchr(line, '|') ? '|' : (std::strchr(line, '\t') ? '\t' : ',');
+    char *cursor = line;
+    char *fields[3];
+    for (int i = 0; i < 3; i++) {
+        fields[i] = next_field(cursor, delimiter);
+        if (fields[i] == NULL) {
+            return false;
+        }
+    }
+
+    int64_t values[3];
+    for (int i = 0; i < 3; i++) {
+        if (!PathDecoder::parse_int64(fields[i], values[i])) {
+            return false;
+        }
+    }
+    // Only provider to customer and peer relationships are modeled
+    if (values[0] < 0 || values[0] > UINT32_MAX || values[1] < 0 || values[1] > UINT32_MAX ||
+        (values[2] != -1 && values[2] != 0)) {
+        return false;
+    }
+    as_1 = (uint32_t) values[0];
+    as_2 = (uint32_t) values[1];
+    relationship = (int) values[2];
+    return true;
+}
+
+template <typename PrefixType>
+void FileInputSource<PrefixType>::rewind_announcements() {
+    if (announcements != NULL) {
+        std::fclose(announcements);
+    }
+    announcements = std::fopen(announcements_file.c_str(), "r");
+    if (announcements == NULL) {
+        BOOST_LOG_TRIVIAL(error) << "Failed to open announcements file: " << announcements_file;
+    } else {
+        setvbuf(announcements, NULL, _IOFBF, FILE_INPUT_BUFFER_SIZE);
+    }
+    pending = false;
+    next_prefix_id = 0;
+    skipped_rows = 0;
+    seen_prefixes.clear();
+}
+
+template <typename PrefixType>
+bool FileInputSource<PrefixType>::next_row() {
+    if (announcements == NULL) {
+        return false;
+    }
+    ssize_t length;
+    while ((length = getline(&line, &line_capacity, announcements)) != -1) {
+        trim_line(line, length);
+        if (line[0] == '\0') {
+            continue;
+        }
+        if (parse_announcement(line, row_prefix, row_path, row_origin, row_timestamp)) {
+            return true;
+        }
+        skipped_rows++;
+    }
+    if (skipped_rows > 0) {
+        // Includes any header line and the rows of the other address family
+        BOOST_LOG_TRIVIAL(info) << "Skipped " << skipped_rows << " rows of " << announcements_file;
+        skipped_rows = 0;
+    }
+    return false;
+}
+
+template <typename PrefixType>
+size_t FileInputSource<PrefixType>::read_announcements(size_t max_rows, const typename InputSource<PrefixType>::AnnouncementCallback &add) {
+    if (announcements == NULL && !pending) {
+        rewind_announcements();
+    }
+
+    size_t rows = 0;
+    uint32_t block_prefixes = 0;
+    Prefix<PrefixType> prefix;
+    while (pending || next_row()) {
+        bool new_prefix = rows == 0 || row_prefix.addr != prefix.addr || row_prefix.netmask != prefix.netmask;
+        if (new_prefix) {
+            if (rows >= max_rows) {
+                // Keep the row for the next block
+                pending = true;
+                break;
+            }
+            // A second prefix id would give the prefix a second set of results
+            if (!seen_prefixes.insert(row_prefix).second) {
+                throw std::runtime_error("Rows of " + row_prefix.to_cidr() + " are not together, is " + announcements_file + " sorted by prefix?");
+            }
+            prefix = Prefix<PrefixType>(row_prefix.addr, row_prefix.netmask, next_prefix_id++, block_prefixes++);
+        }
+        pending = false;
+        add(prefix, row_path, row_origin, row_timestamp);
+        rows++;
+    }
+    return rows;
+}
+
+template <typename PrefixType>
+bool FileInputSource<PrefixType>::parse_announcement(char *line, Prefix<PrefixType> &prefix, char *&as_path, uint32_t &origin, int64_t &timestamp) {
+    char delimiter = std::strchr(line, '\t') ? '\t' : ',';
+    char *cursor = line;
+    char *fields[4];
+    for (int i = 0; i < 4; i++) {
+        fields[i] = next_field(cursor, delimiter);
+        if (fields[i] == NULL) {
+            return false;
+        }
+    }
+
+    int64_t origin_value;
+    if (!parse_prefix(fields[0], prefix) ||
+        !PathDecoder::parse_int64(fields[2], origin_value) || origin_value < 0 || origin_value > UINT32_MAX ||
+        !PathDecoder::parse_int64(fields[3], timestamp)) {
+        return false;
+    }
+    origin = (uint32_t) origin_value;
+
+    // Paths separated by spaces are decoded like arrays
+    as_path = fields[1];
+    for (char *c = as_path; *c != '\0'; c++) {
+        if (*c == ' ') {
+            *c = ',';
+        }
+    }
+    return true;
+}
+
+template <typename PrefixType>
+bool FileInputSource<PrefixType>::parse_prefix(const char *field, Prefix<PrefixType> &prefix) {
+    const char *slash = std::strchr(field, '/');
+    if (slash == NULL) {
+        return false;
+    }
+    int64_t length;
+    if (!PathDecoder::parse_int64(slash + 1, length) || length < 0 || length > (int64_t) sizeof(PrefixType) * 8) {
+        return false;
+    }
+    std::string host(field, slash);
+    bool ipv6 = host.find(':') != std::string::npos;
+    if (ipv6 != (sizeof(PrefixType) == 16)) {
+        return false;
+    }
+
+    PrefixType addr;
+    if (ipv6) {
+        addr = prefix.ipv6_to_int(host);
+    } else {
+        uint32_t ipv4;
+        if (!PathDecoder::parse_ipv4(host.c_str(), ipv4)) {
+            return false;
+        }
+        addr = ipv4;
+    }
+    // Shifting by the full width is undefined, so /0 is handled apart
+    PrefixType netmask = length == 0 ? 0 : ~(PrefixType) 0 << (sizeof(PrefixType) * 8 - length);
+    prefix = Prefix<PrefixType>(addr, netmask, 0, 0);
+    return true;
+}
+
+template class FileInputSource<>;
+template class FileInputSource<uint128_t>;
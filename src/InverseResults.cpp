@@ -0,0 +1,92 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include <algorithm>
+
+#include "InverseResults.h"
+
+template <typename PrefixType>
+const size_t InverseResults<PrefixType>::npos;
+
+template <typename PrefixType>
+InverseResults<PrefixType>::InverseResults() : words(0), asns(NULL) { }
+
+template <typename PrefixType>
+void InverseResults<PrefixType>::clear() {
+    pairs.clear();
+    slot_start.clear();
+    bits.clear();
+}
+
+template <typename PrefixType>
+void InverseResults<PrefixType>::prepare(const std::vector<uint32_t> *asns) {
+    this->asns = asns;
+    std::sort(pairs.begin(), pairs.end(), [](const PrefixOrigin &a, const PrefixOrigin &b) {
+        if (a.first.block_id != b.first.block_id)
+            return a.first.block_id < b.first.block_id;
+        if (a.second != b.second)
+            return a.second < b.second;
+        return a.first < b.first;
+    });
+    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+
+    uint32_t num_slots = pairs.empty() ? 0 : pairs.back().first.block_id + 1;
+    slot_start.assign(num_slots + 1, 0);
+    for (auto &pair : pairs)
+        slot_start[pair.first.block_id + 1]++;
+    for (uint32_t slot = 0; slot < num_slots; slot++)
+        slot_start[slot + 1] += slot_start[slot];
+
+    // Every AS is in every pair until the RIBs say otherwise
+    size_t num_asns = asns->size();
+    words = (num_asns + 63) / 64;
+    bits.assign(pairs.size() * words, ~(uint64_t) 0);
+    if (num_asns % 64 != 0) {
+        uint64_t last = ((uint64_t) 1 << (num_asns % 64)) - 1;
+        for (size_t pair = 0; pair < pairs.size(); pair++)
+            bits[pair * words + words - 1] = last;
+    }
+}
+
+template <typename PrefixType>
+size_t InverseResults<PrefixType>::find(const Prefix<PrefixType> &prefix, uint32_t origin) const {
+    if ((size_t) prefix.block_id + 1 >= slot_start.size())
+        return npos;
+    // A slot rarely holds more than a couple of origins
+    for (size_t i = slot_start[prefix.block_id]; i < slot_start[prefix.block_id + 1]; i++) {
+        if (pairs[i].second == origin && pairs[i].first == prefix)
+            return i;
+    }
+    return npos;
+}
+
+template <typename PrefixType>
+size_t InverseResults<PrefixType>::count(size_t pair) const {
+    size_t total = 0;
+    for (size_t w = 0; w < words; w++)
+        total += __builtin_popcountll(bits[pair * words + w]);
+    return total;
+}
+
+template class InverseResults<>;
+template class InverseResults<uint128_t>;
@@ -0,0 +1,145 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include <string>
+#include <algorithm>
+#include <boost/log/trivial.hpp>
+
+#include "PathDecoder.h"
+
+bool PathDecoder::decode_path(const char *field, const std::unordered_map<uint32_t, uint32_t> &asn_to_index) {
+    path.clear();
+    indices.clear();
+    unknown.clear();
+    // Start a new path without clearing what was seen on the last one
+    if (++epoch == 0) {
+        std::fill(seen.begin(), seen.end(), 0);
+        epoch = 1;
+    }
+
+    bool loop = false;
+    uint64_t value = 0;
+    bool digits = false, malformed = false;
+    const char *token = field;
+    for (const char *c = field; ; c++) {
+        if (*c >= '0' && *c <= '9') {
+            value = value * 10 + (*c - '0');
+            digits = true;
+            malformed |= value > UINT32_MAX;
+        } else if (*c == ',' || *c == '}' || *c == '\0') {
+            if (digits && !malformed) {
+                uint32_t asn = (uint32_t) value;
+                // Prepending repeats the previous run, which was already translated
+                if (!path.empty() && path.back() == asn) {
+                    indices.push_back(indices.back());
+                } else {
+                    auto search = asn_to_index.find(asn);
+                    uint32_t index = search == asn_to_index.end() ? NO_INDEX : search->second;
+                    indices.push_back(index);
+                    loop |= !visit(asn, index);
+                }
+                path.push_back(asn);
+            } else if (c != token) {
+                BOOST_LOG_TRIVIAL(error) << "Parse path error, token was: " << std::string(token, c);
+            }
+            if (*c == '\0') {
+                break;
+            }
+            value = 0;
+            digits = malformed = false;
+            token = c + 1;
+        } else if (*c == '{') {
+            token = c + 1;
+        } else {
+            malformed = true;
+        }
+    }
+    return !loop;
+}
+
+bool PathDecoder::visit(uint32_t asn, uint32_t index) {
+    if (index == NO_INDEX) {
+        // ASNs outside the graph are rare, so a scan of them is cheap
+        for (uint32_t other : unknown) {
+            if (other == asn) {
+                return false;
+            }
+        }
+        unknown.push_back(asn);
+        return true;
+    }
+    if (index >= seen.size()) {
+        seen.resize(index + 1, 0);
+    }
+    if (seen[index] == epoch) {
+        return false;
+    }
+    seen[index] = epoch;
+    return true;
+}
+
+bool PathDecoder::parse_int64(const char *field, int64_t &value) {
+    bool negative = *field == '-';
+    if (negative) {
+        field++;
+    }
+    if (*field == '\0') {
+        return false;
+    }
+    uint64_t magnitude = 0;
+    for (; *field != '\0'; field++) {
+        if (*field < '0' || *field > '9' || magnitude > (uint64_t) INT64_MAX / 10) {
+            return false;
+        }
+        magnitude = magnitude * 10 + (*field - '0');
+    }
+    if (magnitude > (uint64_t) INT64_MAX) {
+        return false;
+    }
+    value = negative ? -(int64_t) magnitude : (int64_t) magnitude;
+    return true;
+}
+
+bool PathDecoder::parse_ipv4(const char *field, uint32_t &addr) {
+    addr = 0;
+    for (int octet = 0; octet < 4; octet++) {
+        uint32_t value = 0;
+        int digits = 0;
+        for (; *field >= '0' && *field <= '9'; field++) {
+            value = value * 10 + (*field - '0');
+            if (++digits > 3) {
+                return false;
+            }
+        }
+        if (digits == 0 || value > 255) {
+            return false;
+        }
+        addr = (addr << 8) | value;
+        // Octets are separated by dots, and the last one ends the field
+        if (*field != (octet < 3 ? '.' : '\0')) {
+            return false;
+        }
+        field++;
+    }
+    return true;
+}
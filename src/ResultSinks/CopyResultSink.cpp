@@ -0,0 +1,79 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include "ResultSinks/CopyResultSink.h"
+
+template <typename PrefixType>
+CopyResultShard<PrefixType>::CopyResultShard(SQLQuerier<PrefixType> *querier, std::string table_name, bool inverse) : rows(true) {
+    this->querier = querier;
+    this->table_name = table_name;
+    this->inverse = inverse;
+}
+
+template <typename PrefixType>
+void CopyResultShard<PrefixType>::add_result(uint32_t asn, const Prefix<PrefixType> &prefix, uint32_t origin, uint32_t received_from_asn, int64_t tstamp) {
+    rows.begin_row(6);
+    rows.add_bigint(asn);
+    rows.add_inet(prefix);
+    rows.add_bigint(origin);
+    rows.add_bigint(received_from_asn);
+    rows.add_bigint(tstamp);
+    rows.add_bigint(prefix.id);
+}
+
+template <typename PrefixType>
+void CopyResultShard<PrefixType>::add_inverse(uint32_t asn, const Prefix<PrefixType> &prefix, uint32_t origin) {
+    rows.begin_row(4);
+    rows.add_bigint(asn);
+    rows.add_inet(prefix);
+    rows.add_bigint(origin);
+    rows.add_bigint(prefix.id);
+}
+
+template <typename PrefixType>
+bool CopyResultShard<PrefixType>::close() {
+    rows.end();
+    if (inverse) {
+        return querier->copy_buffer_to_db(rows, table_name, "(asn, prefix, origin, prefix_id)");
+    }
+    return querier->copy_buffer_to_db(rows, table_name, "(asn, prefix, origin, received_from_asn, time, prefix_id)");
+}
+
+template <typename PrefixType>
+CopyResultSink<PrefixType>::CopyResultSink(SQLQuerier<PrefixType> *querier, std::vector<SQLQuerier<PrefixType>*> *writer_queriers) {
+    this->querier = querier;
+    this->writer_queriers = writer_queriers;
+}
+
+template <typename PrefixType>
+ResultShard<PrefixType>* CopyResultSink<PrefixType>::open_shard(std::string table_name, bool inverse, int iteration, int thread_num) {
+    if (writer_queriers == NULL || writer_queriers->empty()) {
+        return new CopyResultShard<PrefixType>(querier, table_name, inverse);
+    }
+    return new CopyResultShard<PrefixType>(writer_queriers->at(thread_num % writer_queriers->size()), table_name, inverse);
+}
+
+template class CopyResultShard<>;
+template class CopyResultShard<uint128_t>;
+template class CopyResultSink<>;
+template class CopyResultSink<uint128_t>;
@@ -0,0 +1,175 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include <cstring>
+
+#include "Logger.h"
+#include "ResultSinks/FileResultSink.h"
+
+template <typename PrefixType>
+FileResultShard<PrefixType>::FileResultShard(std::string file_name, bool binary, bool compress, bool inverse) {
+    this->file_name = file_name;
+    this->binary = binary;
+    this->inverse = inverse;
+    file = NULL;
+    gz_file = NULL;
+    if (compress) {
+        // Fastest level, the shards are written while the next block waits
+        gz_file = gzopen(file_name.c_str(), "wb1");
+    } else {
+        file = fopen(file_name.c_str(), "wb");
+    }
+    failed = file == NULL && gz_file == NULL;
+    if (failed) {
+        BOOST_LOG_TRIVIAL(error) << "Could not open " << file_name << ": " << strerror(errno);
+    }
+    if (binary) {
+        buffer.reserve(RESULT_FILE_BUFFER_SIZE + 256);
+        buffer.append(RESULT_FILE_MAGIC, 8);
+        buffer.push_back((char) sizeof(PrefixType));
+        buffer.push_back(inverse ? 1 : 0);
+        add_int(record_size(inverse), 2);
+        add_int(0, 4);
+    }
+}
+
+template <typename PrefixType>
+FileResultShard<PrefixType>::~FileResultShard() {
+    if (file != NULL || gz_file != NULL) {
+        close();
+    }
+}
+
+template <typename PrefixType>
+uint16_t FileResultShard<PrefixType>::record_size(bool inverse) {
+    // asn, address, prefix length, origin, then received_from_asn and time for results, then prefix_id
+    return 4 + sizeof(PrefixType) + 1 + 4 + (inverse ? 0 : 4 + 8) + 4;
+}
+
+template <typename PrefixType>
+void FileResultShard<PrefixType>::add_int(uint64_t value, int num_bytes) {
+    for (int i = 0; i < num_bytes; i++) {
+        buffer.push_back((char) (uint8_t) (value >> (i * 8)));
+    }
+}
+
+template <typename PrefixType>
+void FileResultShard<PrefixType>::add_prefix(const Prefix<PrefixType> &prefix) {
+    const int num_bytes = sizeof(PrefixType);
+    for (int shift = (num_bytes - 1) * 8; shift >= 0; shift -= 8) {
+        buffer.push_back((char) (uint8_t) (prefix.addr >> shift));
+    }
+    // Mask length is the number of set bits in the netmask
+    uint8_t bits = 0;
+    for (int shift = 0; shift < num_bytes * 8; shift += 64) {
+        bits += __builtin_popcountll((uint64_t) (prefix.netmask >> shift));
+    }
+    buffer.push_back((char) bits);
+}
+
+template <typename PrefixType>
+void FileResultShard<PrefixType>::add_result(uint32_t asn, const Prefix<PrefixType> &prefix, uint32_t origin, uint32_t received_from_asn, int64_t tstamp) {
+    if (binary) {
+        add_int(asn, 4);
+        add_prefix(prefix);
+        add_int(origin, 4);
+        add_int(received_from_asn, 4);
+        add_int(tstamp, 8);
+        add_int(prefix.id, 4);
+    } else {
+        csv.add_result(asn, prefix, origin, received_from_asn, tstamp);
+    }
+    if (buffer.size() >= RESULT_FILE_BUFFER_SIZE || csv.full()) {
+        flush();
+    }
+}
+
+template <typename PrefixType>
+void FileResultShard<PrefixType>::add_inverse(uint32_t asn, const Prefix<PrefixType> &prefix, uint32_t origin) {
+    if (binary) {
+        add_int(asn, 4);
+        add_prefix(prefix);
+        add_int(origin, 4);
+        add_int(prefix.id, 4);
+    } else {
+        csv.add_inverse(asn, prefix, origin);
+    }
+    if (buffer.size() >= RESULT_FILE_BUFFER_SIZE || csv.full()) {
+        flush();
+    }
+}
+
+template <typename PrefixType>
+void FileResultShard<PrefixType>::write(const char *data, size_t size) {
+    if (!failed && size > 0) {
+        if (gz_file != NULL) {
+            failed = gzwrite(gz_file, data, size) != (int) size;
+        } else {
+            failed = fwrite(data, 1, size, file) != size;
+        }
+        if (failed) {
+            BOOST_LOG_TRIVIAL(error) << "Could not write " << file_name;
+        }
+    }
+}
+
+template <typename PrefixType>
+void FileResultShard<PrefixType>::flush() {
+    write(buffer.data(), buffer.size());
+    buffer.clear();
+    write(csv.data(), csv.size());
+    csv.clear();
+}
+
+template <typename PrefixType>
+bool FileResultShard<PrefixType>::close() {
+    flush();
+    if (gz_file != NULL) {
+        failed |= gzclose(gz_file) != Z_OK;
+        gz_file = NULL;
+    }
+    if (file != NULL) {
+        failed |= fclose(file) != 0;
+        file = NULL;
+    }
+    return !failed;
+}
+
+template <typename PrefixType>
+FileResultSink<PrefixType>::FileResultSink(std::string dir, bool binary, bool compress) {
+    this->dir = dir;
+    this->binary = binary;
+    this->compress = compress;
+}
+
+template <typename PrefixType>
+ResultShard<PrefixType>* FileResultSink<PrefixType>::open_shard(std::string table_name, bool inverse, int iteration, int thread_num) {
+    std::string file_name = dir + "/" + table_name + "_" + std::to_string(iteration) + "_" + std::to_string(thread_num) + 
+                            (binary ? ".bin" : ".csv") + (compress ? ".gz" : "");
+    return new FileResultShard<PrefixType>(file_name, binary, compress, inverse);
+}
+
+template class FileResultShard<>;
+template class FileResultShard<uint128_t>;
+template class FileResultSink<>;
+template class FileResultSink<uint128_t>;
@@ -0,0 +1,133 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include "ResultSinks/ResultFormatter.h"
+
+// "00", "01", ... "99", so two digits are written per division
+static const char digit_pairs[] = 
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+template <typename PrefixType>
+ResultFormatter<PrefixType>::ResultFormatter() : length(0) { }
+
+template <typename PrefixType>
+char* ResultFormatter<PrefixType>::write_uint(char *out, uint64_t value) {
+    // Written backwards into a scratch buffer, then copied
+    char digits[20];
+    char *end = digits + sizeof(digits);
+    char *start = end;
+    while (value >= 100) {
+        const char *pair = digit_pairs + (value % 100) * 2;
+        value /= 100;
+        *--start = pair[1];
+        *--start = pair[0];
+    }
+    if (value >= 10) {
+        const char *pair = digit_pairs + value * 2;
+        *--start = pair[1];
+        *--start = pair[0];
+    } else {
+        *--start = (char) ('0' + value);
+    }
+    std::memcpy(out, start, end - start);
+    return out + (end - start);
+}
+
+template <typename PrefixType>
+char* ResultFormatter<PrefixType>::write_int(char *out, int64_t value) {
+    if (value < 0) {
+        *out++ = '-';
+        // Negate in unsigned arithmetic so INT64_MIN does not overflow
+        return write_uint(out, 0 - (uint64_t) value);
+    }
+    return write_uint(out, (uint64_t) value);
+}
+
+template <typename PrefixType>
+const typename ResultFormatter<PrefixType>::CachedPrefix& ResultFormatter<PrefixType>::cached(const Prefix<PrefixType> &prefix) {
+    if (prefix.block_id >= prefixes.size()) {
+        CachedPrefix empty;
+        empty.valid = false;
+        prefixes.resize((size_t) prefix.block_id + 1, empty);
+    }
+    CachedPrefix &entry = prefixes[prefix.block_id];
+    if (!entry.valid || entry.addr != prefix.addr || entry.netmask != prefix.netmask || entry.id != prefix.id) {
+        entry.addr = prefix.addr;
+        entry.netmask = prefix.netmask;
+        entry.id = prefix.id;
+        entry.valid = true;
+        size_t cidr_length = prefix.write_cidr(entry.cidr);
+        entry.cidr[cidr_length++] = ',';
+        entry.cidr_length = (uint8_t) cidr_length;
+        char *id_end = write_uint(entry.id_text, prefix.id);
+        *id_end++ = '\n';
+        entry.id_length = (uint8_t) (id_end - entry.id_text);
+    }
+    return entry;
+}
+
+template <typename PrefixType>
+void ResultFormatter<PrefixType>::add_result(uint32_t asn, const Prefix<PrefixType> &prefix, uint32_t origin, uint32_t received_from_asn, int64_t tstamp) {
+    const CachedPrefix &entry = cached(prefix);
+    char *start = row_start();
+    char *out = write_uint(start, asn);
+    *out++ = ',';
+    std::memcpy(out, entry.cidr, entry.cidr_length);
+    out += entry.cidr_length;
+    out = write_uint(out, origin);
+    *out++ = ',';
+    out = write_uint(out, received_from_asn);
+    *out++ = ',';
+    out = write_int(out, tstamp);
+    *out++ = ',';
+    std::memcpy(out, entry.id_text, entry.id_length);
+    out += entry.id_length;
+    length += out - start;
+}
+
+template <typename PrefixType>
+void ResultFormatter<PrefixType>::add_inverse(uint32_t asn, const Prefix<PrefixType> &prefix, uint32_t origin) {
+    const CachedPrefix &entry = cached(prefix);
+    char *start = row_start();
+    char *out = write_uint(start, asn);
+    *out++ = ',';
+    std::memcpy(out, entry.cidr, entry.cidr_length);
+    out += entry.cidr_length;
+    out = write_uint(out, origin);
+    *out++ = ',';
+    std::memcpy(out, entry.id_text, entry.id_length);
+    out += entry.id_length;
+    length += out - start;
+}
+
+template class ResultFormatter<>;
+template class ResultFormatter<uint128_t>;
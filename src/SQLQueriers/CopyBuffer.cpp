@@ -0,0 +1,80 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include "SQLQueriers/CopyBuffer.h"
+
+/** Starts an empty buffer, binary buffers begin with the PGCOPY signature.
+ *
+ *  @param binary Whether the rows are encoded in the binary COPY format or as csv
+ */
+CopyBuffer::CopyBuffer(bool binary) : binary(binary), rows(0) {
+    if (binary) {
+        data.append("PGCOPY\n\377\r\n\0", 11);
+        // Flags field and header extension length
+        add_int32(0);
+        add_int32(0);
+    }
+}
+
+/** Starts a new binary row.
+ *
+ *  @param num_fields Number of columns which will follow
+ */
+void CopyBuffer::begin_row(int16_t num_fields) {
+    add_int16(num_fields);
+    rows++;
+}
+
+/** Adds a bigint field to the current row.
+ */
+void CopyBuffer::add_bigint(int64_t value) {
+    add_int32(8);
+    for (int shift = 56; shift >= 0; shift -= 8) {
+        data.push_back((char) (uint8_t) ((uint64_t) value >> shift));
+    }
+}
+
+/** Adds a NULL field to the current row.
+ */
+void CopyBuffer::add_null() {
+    add_int32(-1);
+}
+
+/** Terminates a binary buffer with the file trailer.
+ */
+void CopyBuffer::end() {
+    if (binary) {
+        add_int16(-1);
+    }
+}
+
+void CopyBuffer::add_int16(int16_t value) {
+    data.push_back((char) (uint8_t) ((uint16_t) value >> 8));
+    data.push_back((char) (uint8_t) value);
+}
+
+void CopyBuffer::add_int32(int32_t value) {
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        data.push_back((char) (uint8_t) ((uint32_t) value >> shift));
+    }
+}
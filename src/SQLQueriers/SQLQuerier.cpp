@@ -21,6 +21,8 @@
  * along with this program.  If not, see <https://www.gnu.org/licenses/>.
  ************************************************************************/
 
+#include <libpq-fe.h>
+
 #include "SQLQueriers/SQLQuerier.h"
 
 template <typename PrefixType>
@@ -41,6 +43,9 @@ SQLQuerier<PrefixType>::SQLQuerier(std::string announcements_table /* = ANNOUNCE
     this->config_section = config_section;
     this->config_path = config_path;
     this->exclude_as_number = exclude_as_number;
+    this->copy_from_stdin = false;
+    C = NULL;
+    copy_conn = NULL;
     
     // Default host and port numbers
     // Strings for connection arg
@@ -54,10 +59,26 @@ SQLQuerier<PrefixType>::SQLQuerier(std::string announcements_table /* = ANNOUNCE
     }
 }
 
+/** Copies the settings of another querier. The copy has no connections until open_connection.
+ */
+template <typename PrefixType>
+SQLQuerier<PrefixType>::SQLQuerier(const SQLQuerier<PrefixType> &other) : 
+        results_table(other.results_table), depref_table(other.depref_table), inverse_results_table(other.inverse_results_table),
+        full_path_results_table(other.full_path_results_table), announcements_table(other.announcements_table), 
+        user(other.user), pass(other.pass), db_name(other.db_name), host(other.host), port(other.port),
+        config_section(other.config_section), config_path(other.config_path), exclude_as_number(other.exclude_as_number),
+        copy_from_stdin(other.copy_from_stdin), C(NULL), copy_conn(NULL) { }
+
 template <typename PrefixType>
 SQLQuerier<PrefixType>::~SQLQuerier() {
-    C->disconnect();
-    delete C;
+    // Queriers for file input and output are never connected
+    if (C != NULL) {
+        C->disconnect();
+        delete C;
+    }
+    if (copy_conn != NULL) {
+        PQfinish(copy_conn);
+    }
 }
 
 
@@ -117,21 +138,29 @@ void SQLQuerier<PrefixType>::read_config() {
 }
 
 
-/** Opens a connection to the SQL database.
+/** Returns the libpq connection string for the Querier object settings.
  */
 template <typename PrefixType>
-void SQLQuerier<PrefixType>::open_connection() {
+std::string SQLQuerier<PrefixType>::connection_string() {
     std::ostringstream stream;
     stream << "dbname = " << db_name;
     stream << " user = " << user;
     stream << " password = " << pass;
     stream << " hostaddr = " << host;
     stream << " port = " << port;
+    return stream.str();
+}
+
+/** Opens a connection to the SQL database.
+ */
+template <typename PrefixType>
+void SQLQuerier<PrefixType>::open_connection() {
     // Try connecting with Querier object settings
     try {
-        pqxx::connection *conn = new pqxx::connection(stream.str());
+        pqxx::connection *conn = new pqxx::connection(connection_string());
         if (conn->is_open()) {
             C = conn;
+            prepare_statements();
         } else {
             BOOST_LOG_TRIVIAL(error) << "Failed to connect to database : " << db_name;
             return;
@@ -146,7 +175,13 @@ void SQLQuerier<PrefixType>::open_connection() {
  */
 template <typename PrefixType>
 void SQLQuerier<PrefixType>::close_connection() {
-    C->disconnect();
+    if (C != NULL) {
+        C->disconnect();
+    }
+    if (copy_conn != NULL) {
+        PQfinish(copy_conn);
+        copy_conn = NULL;
+    }
 }
 
 
@@ -181,6 +216,75 @@ pqxx::result SQLQuerier<PrefixType>::execute(std::string sql, bool insert) {
     return R;
 }
 
+/** Prepares the statements selecting announcements on this connection.
+ *
+ *  Each announcement query has a variant declaring a cursor over it, for streaming.
+ *  A statement that fails to prepare is logged and does not keep the others from being prepared.
+ */
+template <typename PrefixType>
+void SQLQuerier<PrefixType>::prepare_statements() {
+    std::pair<std::string, std::string> conditions[] = {
+        {"prefix", "prefix = $1"},
+        {"subnet", "prefix <<= $1"},
+        {"block", "block_id = $1 AND family(prefix) = $2"}};
+    std::vector<std::pair<std::string, std::string>> statements = {
+        {"prefix_count", prepared_select_query_string("COUNT(*)", "prefix = $1")},
+        {"subnet_count", prepared_select_query_string("COUNT(*)", "prefix <<= $1")}};
+    for (auto &condition : conditions) {
+        std::string sql = prepared_select_query_string(ANNOUNCEMENT_COLUMNS, condition.second);
+        statements.push_back(std::make_pair(condition.first + "_ann", sql));
+        statements.push_back(std::make_pair(condition.first + "_ann_cursor", "DECLARE stream_cursor NO SCROLL CURSOR FOR " + sql));
+    }
+    for (auto &statement : statements) {
+        try {
+            C->prepare(statement.first, statement.second);
+        } catch(const std::exception &e) {
+            BOOST_LOG_TRIVIAL(error) << "Failed to prepare statement " << statement.first << ": " << e.what();
+        }
+    }
+}
+
+/** Executes a prepared statement with one parameter
+ *
+ *  @param statement Name of the statement
+ *  @param param Value of its $1
+ */
+template <typename PrefixType>
+pqxx::result SQLQuerier<PrefixType>::execute_prepared(std::string statement, std::string param) {
+    pqxx::result R;
+    try {
+        pqxx::nontransaction N(*C);
+        R = N.exec_prepared(statement, param);
+    } catch(const std::exception &e) {
+        BOOST_LOG_TRIVIAL(error) << e.what();
+    }
+    return R;
+}
+
+/** Fetches the rows of stream_cursor a chunk at a time, then closes it
+ *
+ *  Errors are thrown to the caller, which must discard the chunks already consumed.
+ *
+ *  @param txn Transaction the cursor was declared in
+ *  @param consume Called with each chunk of rows as it arrives
+ *  @return Number of rows fetched
+ */
+template <typename PrefixType>
+size_t SQLQuerier<PrefixType>::stream_rows(pqxx::work &txn, const std::function<void(pqxx::result&)> &consume) {
+    size_t rows = 0;
+    std::string fetch = "FETCH FORWARD " + std::to_string(STREAM_CHUNK_SIZE) + " FROM stream_cursor";
+    while (true) {
+        pqxx::result chunk = txn.exec(fetch);
+        if (chunk.empty()) {
+            break;
+        }
+        rows += chunk.size();
+        consume(chunk);
+    }
+    txn.exec("CLOSE stream_cursor");
+    return rows;
+}
+
 /** Returns a string with SQL COPY query
  *
  *  @param file_name The name of the file to COPY from
@@ -196,6 +300,83 @@ std::string SQLQuerier<PrefixType>::copy_to_db_query_string(std::string file_nam
     return sql;
 }
 
+/** Returns a string with the SQL COPY command for rows sent by the client.
+ *
+ *  @param table_name The name of the table to COPY to
+ *  @param column_names Comma separated list of column names to be copied,
+ *                      surrounded by parentheses, Ex: (stub_asn,parent_asn)
+ *  @param binary Whether the rows are in the binary COPY format rather than csv
+ */
+template <typename PrefixType>
+std::string SQLQuerier<PrefixType>::copy_from_stdin_query_string(std::string table_name, std::string column_names, bool binary) {
+    std::string sql = "COPY " + table_name + column_names + " FROM STDIN WITH (FORMAT " +
+                      (binary ? "binary" : "csv") + ")";
+
+    return sql;
+}
+
+/** Sends the rows in the buffer to a table with COPY FROM STDIN.
+ *
+ *  pqxx only speaks the text COPY format, so this uses libpq directly over its
+ *  own connection, copy_conn, which is kept open for the next copy. The rows never
+ *  touch the filesystem, so the database can be remote and the user does not need
+ *  the pg_read_server_files role. Only one thread may copy through a querier at once.
+ *
+ *  @param rows Encoded rows, binary buffers must have been ended
+ *  @param table_name The name of the table to COPY to
+ *  @param column_names Column names surrounded by parentheses
+ *  @return Whether the server accepted all of the rows
+ */
+template <typename PrefixType>
+bool SQLQuerier<PrefixType>::copy_buffer_to_db(const CopyBuffer &rows, std::string table_name, std::string column_names) {
+    if (rows.empty()) {
+        return true;
+    }
+    // The connection is kept for the next copy, and made again if it was lost
+    if (copy_conn != NULL && PQstatus(copy_conn) != CONNECTION_OK) {
+        PQfinish(copy_conn);
+        copy_conn = NULL;
+    }
+    if (copy_conn == NULL) {
+        copy_conn = PQconnectdb(connection_string().c_str());
+        if (PQstatus(copy_conn) != CONNECTION_OK) {
+            BOOST_LOG_TRIVIAL(error) << "Failed to connect to database : " << PQerrorMessage(copy_conn);
+            PQfinish(copy_conn);
+            copy_conn = NULL;
+            return false;
+        }
+    }
+    PGconn *conn = copy_conn;
+
+    std::string sql = copy_from_stdin_query_string(table_name, column_names, rows.binary);
+    PGresult *res = PQexec(conn, sql.c_str());
+    bool success = PQresultStatus(res) == PGRES_COPY_IN;
+    PQclear(res);
+    if (!success) {
+        BOOST_LOG_TRIVIAL(error) << "Failed to start COPY into " << table_name << " : " << PQerrorMessage(conn);
+        return false;
+    }
+
+    // Send the buffer in chunks, libpq queues each chunk for the server
+    for (size_t pos = 0; success && pos < rows.data.size(); pos += COPY_CHUNK_SIZE) {
+        size_t length = std::min((size_t) COPY_CHUNK_SIZE, rows.data.size() - pos);
+        success = PQputCopyData(conn, rows.data.data() + pos, (int) length) == 1;
+    }
+    success = PQputCopyEnd(conn, success ? NULL : "client failed to send rows") == 1 && success;
+
+    // The result of the COPY itself, then NULL once the command is complete
+    while ((res = PQgetResult(conn)) != NULL) {
+        if (PQresultStatus(res) != PGRES_COMMAND_OK) {
+            success = false;
+        }
+        PQclear(res);
+    }
+    if (!success) {
+        BOOST_LOG_TRIVIAL(error) << "Failed to COPY into " << table_name << " : " << PQerrorMessage(conn);
+    }
+    return success;
+}
+
 /** Returns a string with SQL SELECT query for announcements within prefix / subnet
  *
  *  @param p The prefix for which we SELECT
@@ -224,6 +405,20 @@ std::string SQLQuerier<PrefixType>::select_prefix_query_string(Prefix<PrefixType
     return sql;
 }
 
+/** Returns a string with an SQL SELECT query on the announcements table, for preparing
+ *
+ *  @param selection Comma separated list of column names to be selected
+ *  @param condition WHERE condition, with $1, $2... in place of the values
+ */
+template <typename PrefixType>
+std::string SQLQuerier<PrefixType>::prepared_select_query_string(std::string selection, std::string condition) {
+    std::string sql = "SELECT " + selection + " FROM " + announcements_table + " WHERE " + condition;
+    if (exclude_as_number > -1) {
+        sql += " AND monitor_asn != " + std::to_string(exclude_as_number);
+    }
+    return sql;
+}
+
 // Returns a string with a DROP TABLE query
 template <typename PrefixType>
 std::string SQLQuerier<PrefixType>::clear_table_query_string(std::string table_name) {
@@ -282,8 +477,7 @@ pqxx::result SQLQuerier<PrefixType>::select_from_table(std::string table_name, i
  */
 template <typename PrefixType>
 pqxx::result SQLQuerier<PrefixType>::select_prefix_count(Prefix<PrefixType>* p) {
-    std::string sql = select_prefix_query_string(p);
-    return execute(sql);
+    return execute_prepared("prefix_count", p->to_cidr());
 }
 
 
@@ -293,8 +487,7 @@ pqxx::result SQLQuerier<PrefixType>::select_prefix_count(Prefix<PrefixType>* p)
  */
 template <typename PrefixType>
 pqxx::result SQLQuerier<PrefixType>::select_prefix_ann(Prefix<PrefixType>* p) {
-    std::string sql = select_prefix_query_string(p, false, "host(prefix), netmask(prefix), as_path, origin, time, prefix_id, block_prefix_id");
-    return execute(sql);
+    return execute_prepared("prefix_ann", p->to_cidr());
 }
 
 
@@ -304,8 +497,7 @@ pqxx::result SQLQuerier<PrefixType>::select_prefix_ann(Prefix<PrefixType>* p) {
  */
 template <typename PrefixType>
 pqxx::result SQLQuerier<PrefixType>::select_subnet_count(Prefix<PrefixType>* p) {
-    std::string sql = select_prefix_query_string(p, true);
-    return execute(sql);
+    return execute_prepared("subnet_count", p->to_cidr());
 }
 
 
@@ -315,8 +507,53 @@ pqxx::result SQLQuerier<PrefixType>::select_subnet_count(Prefix<PrefixType>* p)
  */
 template <typename PrefixType>
 pqxx::result SQLQuerier<PrefixType>::select_subnet_ann(Prefix<PrefixType>* p) {
-    std::string sql = select_prefix_query_string(p, true, "host(prefix), netmask(prefix), as_path, origin, time, prefix_id, block_prefix_id");
-    return execute(sql);
+    return execute_prepared("subnet_ann", p->to_cidr());
+}
+
+
+/** Streams all announcements for the prefix, or for the prefixes within it, through a cursor.
+ *
+ * Rows are handed over in chunks as they arrive, so they need not all be held at once.
+ *
+ * @param p The prefix for which we SELECT
+ * @param subnet Select the prefixes contained within p rather than p
+ * @param consume Called with each chunk of rows
+ * @return Number of announcements streamed, 0 if the query failed, even after chunks were consumed
+ */
+template <typename PrefixType>
+size_t SQLQuerier<PrefixType>::stream_prefix_ann(Prefix<PrefixType>* p, bool subnet, const std::function<void(pqxx::result&)> &consume) {
+    size_t rows = 0;
+    try {
+        pqxx::work txn(*C);
+        txn.exec_prepared(subnet ? "subnet_ann_cursor" : "prefix_ann_cursor", p->to_cidr());
+        rows = stream_rows(txn, consume);
+        txn.commit();
+    } catch(const std::exception &e) {
+        BOOST_LOG_TRIVIAL(error) << e.what();
+    }
+    return rows;
+}
+
+
+/** Streams selected columns of a whole table through a cursor.
+ *
+ * @param table_name The name of the table to SELECT from
+ * @param column_names Comma separated list of column names to be selected
+ * @param consume Called with each chunk of rows
+ * @return Number of rows streamed, 0 if the query failed, even after chunks were consumed
+ */
+template <typename PrefixType>
+size_t SQLQuerier<PrefixType>::stream_from_table(std::string table_name, std::string column_names, const std::function<void(pqxx::result&)> &consume) {
+    size_t rows = 0;
+    try {
+        pqxx::work txn(*C);
+        txn.exec("DECLARE stream_cursor NO SCROLL CURSOR FOR SELECT " + column_names + " FROM " + table_name);
+        rows = stream_rows(txn, consume);
+        txn.commit();
+    } catch(const std::exception &e) {
+        BOOST_LOG_TRIVIAL(error) << e.what();
+    }
+    return rows;
 }
 
 
@@ -515,6 +752,34 @@ void SQLQuerier<PrefixType>::copy_inverse_results_to_db(std::string file_name) {
     execute(sql);
 }
 
+/** Streams binary rows to the results table.
+ */
+template <typename PrefixType>
+void SQLQuerier<PrefixType>::copy_results_to_db(const CopyBuffer &rows) {
+    copy_buffer_to_db(rows, results_table, "(asn, prefix, origin, received_from_asn, time, prefix_id)");
+}
+
+/** Streams csv rows, including the AS_PATH column, to the full path results table.
+ */
+template <typename PrefixType>
+void SQLQuerier<PrefixType>::copy_single_results_to_db(const CopyBuffer &rows) {
+    copy_buffer_to_db(rows, full_path_results_table, "(asn, prefix, origin, received_from_asn, time, prefix_id, as_path)");
+}
+
+/** Streams binary rows to the depref table.
+ */
+template <typename PrefixType>
+void SQLQuerier<PrefixType>::copy_depref_to_db(const CopyBuffer &rows) {
+    copy_buffer_to_db(rows, depref_table, "(asn, prefix, origin, received_from_asn, time, prefix_id)");
+}
+
+/** Streams binary rows to the inverse results table.
+ */
+template <typename PrefixType>
+void SQLQuerier<PrefixType>::copy_inverse_results_to_db(const CopyBuffer &rows) {
+    copy_buffer_to_db(rows, inverse_results_table, "(asn, prefix, origin, prefix_id)");
+}
+
 
 /** Generate an index on the results table.
  */
@@ -550,19 +815,95 @@ pqxx::result SQLQuerier<PrefixType>::select_max_block_prefix_id() {
     return execute(sql, false);
 }
 
+/** Returns an md5 hash of the contents of the peers and customer-provider tables
+ *
+ * The rows are hashed in sorted order, so it only changes when the relationships do.
+ */
+template <typename PrefixType>
+pqxx::result SQLQuerier<PrefixType>::select_relationships_hash() {
+    std::string sql = std::string("SELECT md5(") +
+        "COALESCE((SELECT string_agg(peer_as_1 || ',' || peer_as_2, ';' ORDER BY peer_as_1, peer_as_2) FROM " + PEERS_TABLE + "), '') || '|' || " +
+        "COALESCE((SELECT string_agg(customer_as || ',' || provider_as, ';' ORDER BY customer_as, provider_as) FROM " + CUSTOMER_PROVIDER_TABLE + "), ''))";
+    return execute(sql, false);
+}
+
 /** Returns all rows (announcements) that have the corresponding block_id
  */
 template <typename PrefixType>
 pqxx::result SQLQuerier<PrefixType>::select_prefix_block_id(int block_id, int family) {
-    std::string sql = std::string("SELECT host(prefix), netmask(prefix), as_path, origin, time, prefix_id, block_prefix_id FROM "
-     + announcements_table + " WHERE block_id = " + std::to_string(block_id)
-     + " AND family(prefix) = " + std::to_string(family));
+    pqxx::result R;
+    try {
+        pqxx::nontransaction N(*C);
+        R = N.exec_prepared("block_ann", block_id, family);
+    } catch(const std::exception &e) {
+        BOOST_LOG_TRIVIAL(error) << e.what();
+    }
+    return R;
+}
+
+/** Streams all announcements that have the corresponding block_id through a cursor
+ *
+ * @param consume Called with each chunk of rows
+ * @return Number of announcements streamed, 0 if the query failed, even after chunks were consumed
+ */
+template <typename PrefixType>
+size_t SQLQuerier<PrefixType>::stream_prefix_block_id(int block_id, int family, const std::function<void(pqxx::result&)> &consume) {
+    size_t rows = 0;
+    try {
+        pqxx::work txn(*C);
+        txn.exec_prepared("block_ann_cursor", block_id, family);
+        rows = stream_rows(txn, consume);
+        txn.commit();
+    } catch(const std::exception &e) {
+        BOOST_LOG_TRIVIAL(error) << e.what();
+    }
+    return rows;
+}
+
+/** Returns the number of announcements for each block_id
+ */
+template <typename PrefixType>
+pqxx::result SQLQuerier<PrefixType>::select_block_id_counts(int family) {
+    std::string sql = std::string("SELECT block_id, COUNT(*) FROM " + announcements_table 
+     + " WHERE family(prefix) = " + std::to_string(family));
 
     if (exclude_as_number > -1) {
-        sql += " and monitor_asn != " + std::to_string(exclude_as_number) + ";";
-    } else {
-        sql += ";";
+        sql += " and monitor_asn != " + std::to_string(exclude_as_number);
+    }
+    sql += " GROUP BY block_id;";
+
+    return execute(sql, false);
+}
+
+/** Returns the number of announcements for each prefix
+ */
+template <typename PrefixType>
+pqxx::result SQLQuerier<PrefixType>::select_prefix_counts(int family) {
+    std::string sql = std::string("SELECT host(prefix), masklen(prefix), COUNT(*) FROM " + announcements_table 
+     + " WHERE family(prefix) = " + std::to_string(family));
+
+    if (exclude_as_number > -1) {
+        sql += " and monitor_asn != " + std::to_string(exclude_as_number);
+    }
+    sql += " GROUP BY prefix;";
+
+    return execute(sql, false);
+}
+
+/** Returns an md5 hash of the number of announcements for each prefix, as select_prefix_counts
+ *
+ * Blocks are planned from these counts alone, so the hash changes whenever a plan made from 
+ * them would, including when the table is reloaded with other prefixes.
+ */
+template <typename PrefixType>
+pqxx::result SQLQuerier<PrefixType>::select_announcements_version(int family) {
+    std::string sql = std::string("SELECT md5(COALESCE(string_agg(prefix::text || ',' || num_anns, ';' ORDER BY prefix), ''))")
+     + " FROM (SELECT prefix, COUNT(*) AS num_anns FROM " + announcements_table + " WHERE family(prefix) = " + std::to_string(family);
+
+    if (exclude_as_number > -1) {
+        sql += " and monitor_asn != " + std::to_string(exclude_as_number);
     }
+    sql += " GROUP BY prefix) AS prefix_counts;";
 
     return execute(sql, false);
 }
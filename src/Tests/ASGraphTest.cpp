@@ -416,3 +416,309 @@ bool test_combine_components(){
     }
     return true;
 }
+
+/** Test the dense index and the adjacency frozen after deciding ranks, on a graph with a supernode.
+ *  Horizontal lines are peer relationships, vertical lines are customer-provider
+ * 
+ *    1--2 (cycle of 1, 2, 3)
+ *     \/
+ *     3--4
+ *    / \
+ *   5   6
+ *
+ * @return true if successful, otherwise false.
+ */
+bool test_index_ases(){
+    ASGraph<> graph = ASGraph<>(false, false);
+    graph.add_relationship(2, 1, AS_REL_PROVIDER);
+    graph.add_relationship(1, 2, AS_REL_CUSTOMER);
+    graph.add_relationship(1, 3, AS_REL_PROVIDER);
+    graph.add_relationship(3, 1, AS_REL_CUSTOMER);
+    graph.add_relationship(3, 2, AS_REL_PROVIDER);
+    graph.add_relationship(2, 3, AS_REL_CUSTOMER);
+    graph.add_relationship(5, 3, AS_REL_PROVIDER);
+    graph.add_relationship(3, 5, AS_REL_CUSTOMER);
+    graph.add_relationship(6, 3, AS_REL_PROVIDER);
+    graph.add_relationship(3, 6, AS_REL_CUSTOMER);
+    graph.add_relationship(4, 3, AS_REL_PEER);
+    graph.add_relationship(3, 4, AS_REL_PEER);
+    graph.tarjan();
+    graph.combine_components();
+    graph.decide_ranks();
+
+    // Every AS has an index, supernode members other than the supernode do not
+    if (graph.ases_by_index->size() != graph.ases->size() || graph.find_as(2) != NULL || graph.find_as(3) != NULL) {
+        std::cerr << "Dense index does not hold exactly the ASes of the graph." << std::endl;
+        return false;
+    }
+    for (auto const &as : *graph.ases) {
+        if (graph.find_as(as.first) != as.second || graph.as_at(as.second->graph_index) != as.second) {
+            std::cerr << "AS " << as.first << " is not at its index." << std::endl;
+            return false;
+        }
+    }
+
+    // Ranks are consecutive runs of indices, in the same order as ases_by_rank
+    uint32_t next = 0;
+    for (size_t level = 0; level < graph.ases_by_rank->size(); level++) {
+        std::set<uint32_t> *rank = graph.ases_by_rank->at(level);
+        std::vector<uint32_t> &indices = graph.ranks_by_index->at(level);
+        if (indices.size() != rank->size()) {
+            std::cerr << "Rank " << level << " has a different size by index." << std::endl;
+            return false;
+        }
+        auto asn = rank->begin();
+        for (uint32_t index : indices) {
+            if (index != next++ || graph.as_at(index)->asn != *asn++) {
+                std::cerr << "Rank " << level << " is not laid out in order." << std::endl;
+                return false;
+            }
+        }
+    }
+
+    // Rows of the frozen adjacency hold the neighbors, sorted by index
+    for (AS<> *as : *graph.ases_by_index) {
+        std::pair<std::set<uint32_t>*, IndexRange> neighbors[] = {
+            {as->providers, as->provider_indices}, 
+            {as->peers, as->peer_indices}, 
+            {as->customers, as->customer_indices}};
+        for (auto &n : neighbors) {
+            std::set<uint32_t> asns;
+            for (uint32_t index : n.second)
+                asns.insert(graph.as_at(index)->asn);
+            if (asns != *n.first || !std::is_sorted(n.second.begin(), n.second.end())) {
+                std::cerr << "Neighbor indices of AS " << as->asn << " do not match its neighbors." << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/** Test that with bfs_rank_order the ASes of a rank are numbered in breadth first order,
+ *  so that customers of the same provider get consecutive indices.
+ *  Vertical lines are customer-provider relationships
+ * 
+ *      1       2
+ *     / \     / \
+ *   10   30 20   40
+ *
+ * @return true if successful, otherwise false.
+ */
+bool test_index_ases_bfs(){
+    ASGraph<> graph = ASGraph<>(false, false);
+    graph.bfs_rank_order = true;
+    uint32_t customers[][2] = {{1, 10}, {1, 30}, {2, 20}, {2, 40}};
+    for (auto &pair : customers) {
+        graph.add_relationship(pair[1], pair[0], AS_REL_PROVIDER);
+        graph.add_relationship(pair[0], pair[1], AS_REL_CUSTOMER);
+    }
+    graph.decide_ranks();
+
+    std::vector<std::vector<uint32_t>> expected = {{10, 30, 20, 40}, {1, 2}};
+    uint32_t next = 0;
+    for (size_t level = 0; level < expected.size(); level++) {
+        std::vector<uint32_t> &indices = graph.ranks_by_index->at(level);
+        if (indices.size() != expected[level].size()) {
+            std::cerr << "Rank " << level << " has a different size by index." << std::endl;
+            return false;
+        }
+        for (size_t i = 0; i < indices.size(); i++) {
+            if (indices[i] != next++ || graph.as_at(indices[i])->asn != expected[level][i]) {
+                std::cerr << "Rank " << level << " is not laid out breadth first." << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/** Test that a graph loaded from a snapshot matches the processed graph it was saved from.
+ *  Uses the graph of test_index_ases, with a supernode, and a stub under AS 5.
+ *
+ * @return true if successful, otherwise false.
+ */
+bool test_topology_snapshot(){
+    ASGraph<> graph = ASGraph<>(false, false);
+    graph.add_relationship(2, 1, AS_REL_PROVIDER);
+    graph.add_relationship(1, 2, AS_REL_CUSTOMER);
+    graph.add_relationship(1, 3, AS_REL_PROVIDER);
+    graph.add_relationship(3, 1, AS_REL_CUSTOMER);
+    graph.add_relationship(3, 2, AS_REL_PROVIDER);
+    graph.add_relationship(2, 3, AS_REL_CUSTOMER);
+    graph.add_relationship(5, 3, AS_REL_PROVIDER);
+    graph.add_relationship(3, 5, AS_REL_CUSTOMER);
+    graph.add_relationship(6, 3, AS_REL_PROVIDER);
+    graph.add_relationship(3, 6, AS_REL_CUSTOMER);
+    graph.add_relationship(4, 3, AS_REL_PEER);
+    graph.add_relationship(3, 4, AS_REL_PEER);
+    graph.stubs_to_parents->insert(std::pair<uint32_t, uint32_t>(7, 5));
+    graph.non_stubs->assign({1, 2, 3, 4, 5, 6});
+    graph.tarjan();
+    graph.combine_components();
+    graph.decide_ranks();
+
+    std::string file_name = "/tmp/bgp-topology-snapshot-test.bin";
+    if (!graph.save_snapshot(file_name, "key")) {
+        std::cerr << "Could not save the snapshot." << std::endl;
+        return false;
+    }
+
+    ASGraph<> wrong_key = ASGraph<>(false, false);
+    if (wrong_key.load_snapshot(file_name, "other") || !wrong_key.ases->empty()) {
+        std::cerr << "Snapshot loaded with the wrong key." << std::endl;
+        std::remove(file_name.c_str());
+        return false;
+    }
+
+    // Offsets past the end of what they index are refused, the first word after the header 
+    // is the first ASN, followed by the rank offsets
+    std::string corrupt_name = "/tmp/bgp-topology-snapshot-corrupt.bin";
+    {
+        std::ifstream infile(file_name, std::ios::binary);
+        std::string contents((std::istreambuf_iterator<char>(infile)), std::istreambuf_iterator<char>());
+        uint32_t past_end = 1000;
+        size_t rank_offsets = sizeof(TopologySnapshotHeader) + graph.ases_by_index->size() * sizeof(uint32_t);
+        contents.replace(rank_offsets + sizeof(uint32_t), sizeof(uint32_t), reinterpret_cast<const char*>(&past_end), sizeof(uint32_t));
+        std::ofstream outfile(corrupt_name, std::ios::binary);
+        outfile << contents;
+    }
+    ASGraph<> corrupt = ASGraph<>(false, false);
+    bool corrupt_loaded = corrupt.load_snapshot(corrupt_name, "key");
+    std::remove(corrupt_name.c_str());
+    if (corrupt_loaded || !corrupt.ases->empty()) {
+        std::cerr << "Corrupt snapshot loaded." << std::endl;
+        std::remove(file_name.c_str());
+        return false;
+    }
+
+    ASGraph<> loaded = ASGraph<>(false, false);
+    bool ok = loaded.load_snapshot(file_name, "key");
+    std::remove(file_name.c_str());
+    if (!ok) {
+        std::cerr << "Could not load the snapshot." << std::endl;
+        return false;
+    }
+    // Neighbor sets are only filled when asked for
+    for (AS<> *as : *loaded.ases_by_index) {
+        if (!as->providers->empty() || !as->peers->empty() || !as->customers->empty()) {
+            std::cerr << "Neighbor sets were filled on load." << std::endl;
+            return false;
+        }
+    }
+    loaded.fill_neighbor_sets();
+
+    if (*loaded.ranks_by_index != *graph.ranks_by_index || loaded.ases_by_rank->size() != graph.ases_by_rank->size()) {
+        std::cerr << "Loaded ranks differ." << std::endl;
+        return false;
+    }
+    for (size_t level = 0; level < graph.ases_by_rank->size(); level++) {
+        if (*loaded.ases_by_rank->at(level) != *graph.ases_by_rank->at(level)) {
+            std::cerr << "Loaded rank " << level << " differs." << std::endl;
+            return false;
+        }
+    }
+    if (loaded.ases_by_index->size() != graph.ases_by_index->size()) {
+        std::cerr << "Loaded graph has a different number of ASes." << std::endl;
+        return false;
+    }
+    for (AS<> *as : *graph.ases_by_index) {
+        AS<> *other = loaded.as_at(as->graph_index);
+        if (other->asn != as->asn || other->rank != as->rank || loaded.find_as(as->asn) != other ||
+            *other->providers != *as->providers || *other->peers != *as->peers || *other->customers != *as->customers ||
+            *other->member_ases != *as->member_ases) {
+            std::cerr << "Loaded AS " << as->asn << " differs." << std::endl;
+            return false;
+        }
+        for (int relationship : {AS_REL_PROVIDER, AS_REL_PEER, AS_REL_CUSTOMER}) {
+            IndexRange a = as->neighbor_indices(relationship), b = other->neighbor_indices(relationship);
+            if (!std::equal(a.begin(), a.end(), b.begin(), b.end())) {
+                std::cerr << "Loaded neighbor indices of AS " << as->asn << " differ." << std::endl;
+                return false;
+            }
+        }
+    }
+    if (*loaded.component_translation != *graph.component_translation || loaded.translate_asn(3) != 1 ||
+        *loaded.stubs_to_parents != *graph.stubs_to_parents || *loaded.non_stubs != *graph.non_stubs) {
+        std::cerr << "Loaded supernodes or stubs differ." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/** Test tarjan, combine_components, and decide_ranks on a provider chain too deep to recurse 
+ *  through, topped by a cycle of three ASes.
+ *
+ * @return true if successful, otherwise false.
+ */
+bool test_preprocess_deep_chain(){
+    const uint32_t length = 200000;
+    ASGraph<> graph = ASGraph<>(false, false);
+    graph.max_block_prefix_id = 1;
+    for (uint32_t asn = length; asn > 1; asn--) {
+        graph.add_relationship(asn, asn - 1, AS_REL_PROVIDER);
+        graph.add_relationship(asn - 1, asn, AS_REL_CUSTOMER);
+    }
+    // ASes 1, 2, and 3 at the top form a cycle
+    graph.add_relationship(1, 3, AS_REL_PROVIDER);
+    graph.add_relationship(3, 1, AS_REL_CUSTOMER);
+    graph.tarjan();
+    if (graph.components->size() != length - 2) {
+        std::cerr << "Deep chain has " << graph.components->size() << " components." << std::endl;
+        return false;
+    }
+    graph.combine_components();
+    graph.decide_ranks();
+    if (graph.ases->size() != length - 2 || 
+        graph.translate_asn(3) != 1 ||
+        graph.ases->find(1)->second->rank != (int) length - 3 ||
+        graph.ases_by_rank->size() != length - 1) {
+        std::cerr << "Deep chain is ranked wrong." << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/** Test that swap_rib_generations hands the announcements and inverse results of a block 
+ *  to the saved generation, and clears the other for the next block.
+ *
+ * @return true if successful, otherwise false.
+ */
+bool test_rib_generations(){
+    ASGraph<> graph = ASGraph<>(true, true);
+    graph.max_block_prefix_id = 1;
+    graph.add_relationship(2, 1, AS_REL_PROVIDER);
+    graph.add_relationship(1, 2, AS_REL_CUSTOMER);
+    AS<> *as = graph.ases->find(1)->second;
+    Prefix<> p = Prefix<>(0x89630000, 0xFFFF0000, 0, 0);
+
+    // Without a second generation the saved RIBs are the current ones
+    if (graph.has_rib_generations() || as->saved_anns != as->all_anns || graph.saved_inverse_results != graph.inverse_results) {
+        std::cerr << "Saved generation is not the current one." << std::endl;
+        return false;
+    }
+
+    graph.add_rib_generation();
+    as->all_anns->insert(p, Announcement<>(13796, p, 22742));
+    graph.inverse_results->add_seed(p, 13796);
+    graph.swap_rib_generations();
+    if (!graph.has_rib_generations() || as->saved_anns == as->all_anns || 
+        !as->all_anns->empty() || as->saved_anns->find(p) == as->saved_anns->end() ||
+        as->saved_anns->find(p)->origin != 13796 || as->saved_anns->begin()->prefix != p) {
+        std::cerr << "Announcements were not handed to the saved generation." << std::endl;
+        return false;
+    }
+    if (graph.inverse_results->size() != 0 || graph.saved_inverse_results->size() != 1) {
+        std::cerr << "Inverse results were not handed to the saved generation." << std::endl;
+        return false;
+    }
+
+    // The next block is propagated into the cleared generation, and the saved one is cleared after it
+    as->all_anns->insert(p, Announcement<>(3356, p, 22742));
+    graph.swap_rib_generations();
+    if (as->saved_anns->find(p)->origin != 3356 || !as->all_anns->empty() || graph.saved_inverse_results->size() != 0) {
+        std::cerr << "Generations were not swapped back." << std::endl;
+        return false;
+    }
+    return true;
+}
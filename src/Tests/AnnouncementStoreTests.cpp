@@ -0,0 +1,220 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include <unistd.h>
+#include <dirent.h>
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+#include "InputSources/AnnouncementStore.h"
+#include "Extrapolators/Extrapolator.h"
+
+/** Unit tests for AnnouncementStore.h
+ */
+
+/** Tests writing a store and mapping it back, and refusing blocks and paths outside of it.
+ *
+ * @return true if successful, otherwise false.
+ */
+bool test_announcement_store() {
+    std::string file_name = "/tmp/bgp-test-store-" + std::to_string(getpid()) + ".bin";
+    uint32_t path_1[] = {3, 2, 2, 1};
+    uint32_t path_2[] = {5};
+
+    AnnouncementStoreWriter<> writer(file_name);
+    if (!writer.open()) {
+        std::cerr << "test_announcement_store failed to create the store" << std::endl;
+        return false;
+    }
+    writer.add(Prefix<>("1.2.0.0", "255.255.0.0", 7, 0), 1, 100, path_1, 4);
+    writer.end_block(2);
+    writer.add(Prefix<>("1.3.0.0", "255.255.0.0", 8, 0), 5, 200, path_2, 1);
+    writer.add(Prefix<>("1.4.0.0", "255.255.0.0", 9, 1), 5, 300, path_2, 1);
+    writer.end_block(2);
+    if (!writer.close()) {
+        std::cerr << "test_announcement_store failed to write the store" << std::endl;
+        return false;
+    }
+
+    bool passed = true;
+    AnnouncementStore<> store(file_name);
+    if (!store.open() || store.header->num_blocks != 2 || store.header->num_anns != 3 || 
+            store.header->num_asns != 6 || store.header->max_block_prefix_id != 2) {
+        std::cerr << "test_announcement_store failed. Wrong header" << std::endl;
+        passed = false;
+    } else {
+        const StoredBlock &block = store.blocks[1];
+        const StoredAnnouncement<> &ann = store.anns[0];
+        if (store.blocks[0].num_anns != 1 || store.blocks[0].rows != 2 || block.first_ann != 1 || block.num_anns != 2 ||
+                ann.addr != Prefix<>("1.2.0.0", "255.255.0.0", 0, 0).addr || ann.prefix_id != 7 || ann.origin != 1 ||
+                ann.timestamp != 100 || !std::equal(path_1, path_1 + 4, store.asns + ann.path_start) ||
+                store.anns[2].block_prefix_id != 1 || store.asns[store.anns[2].path_start] != 5) {
+            std::cerr << "test_announcement_store failed. Wrong contents" << std::endl;
+            passed = false;
+        }
+    }
+    store.close();
+
+    // A store of the other address family is refused
+    AnnouncementStore<uint128_t> ipv6_store(file_name);
+    if (ipv6_store.open()) {
+        std::cerr << "test_announcement_store failed. Opened an IPv4 store for IPv6" << std::endl;
+        passed = false;
+    }
+
+    // A block past the announcements is refused on open, a path past the ASN pool before use
+    std::ifstream infile(file_name, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(infile)), std::istreambuf_iterator<char>());
+    infile.close();
+    AnnouncementStoreHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    std::string corrupt_name = file_name + ".corrupt";
+    auto write_corrupt = [&bytes, &corrupt_name](size_t offset, uint64_t value) {
+        std::vector<char> corrupt = bytes;
+        std::memcpy(corrupt.data() + offset, &value, sizeof(value));
+        std::ofstream outfile(corrupt_name, std::ios::binary);
+        outfile.write(corrupt.data(), corrupt.size());
+    };
+    write_corrupt(header.blocks_offset + sizeof(StoredBlock) + offsetof(StoredBlock, num_anns), 3);
+    AnnouncementStore<> corrupt_store(corrupt_name);
+    if (corrupt_store.open()) {
+        std::cerr << "test_announcement_store failed. Opened a store with a block out of range" << std::endl;
+        passed = false;
+    }
+    write_corrupt(header.anns_offset + offsetof(StoredAnnouncement<>, path_start), 3);
+    if (!corrupt_store.open() || corrupt_store.valid_path(corrupt_store.anns[0]) || !corrupt_store.valid_path(corrupt_store.anns[1])) {
+        std::cerr << "test_announcement_store failed. Wrong check of a path out of range" << std::endl;
+        passed = false;
+    }
+    corrupt_store.close();
+    std::remove(corrupt_name.c_str());
+    std::remove(file_name.c_str());
+    return passed;
+}
+
+/** Compile announcement files into a store, then extrapolate from the store into csvs.
+ *  Uses the graph of test_extrapolate_input, and gives the same results.
+ * 
+ *    1
+ *    |
+ *    2--3
+ *   /|   
+ *  4 5--6 
+ *
+ *  The announcement with a loop is dropped when compiling.
+ *
+ * @return true if successful, otherwise false.
+ */
+bool test_extrapolate_store() {
+    std::string dir = "/tmp/bgp-test-store-" + std::to_string(getpid());
+    mkdir(dir.c_str(), 0777);
+    std::string relationships_file = dir + "/as-rel.txt";
+    std::string announcements_file = dir + "/announcements.tsv";
+    std::string store_file = dir + "/announcements.bin";
+    std::string results_dir = dir + "/results";
+
+    std::ofstream file(relationships_file);
+    file << "1|2|-1\n2|4|-1\n2|5|-1\n2|3|0\n5|6|0\n";
+    file.close();
+    file.open(announcements_file);
+    file << "137.99.0.0/16\t{1}\t1\t0\n137.98.0.0/16\t{5}\t5\t0\n137.97.0.0/16\t{1,2,1}\t1\t0\n";
+    file.close();
+
+    // One prefix in each block
+    Extrapolator<> *e = new Extrapolator<>(false, true, false, false, "unused", "results", "unused", "unused", "unused", "bgp", 1, -1, 1, false, NULL, 1, false,
+                                            DEFAULT_PARALLEL_PROPAGATION, DEFAULT_PULL_PROPAGATION, DEFAULT_CONCURRENT_BLOCKS, DEFAULT_BFS_RANK_ORDER, DEFAULT_TOPOLOGY_SNAPSHOT_DIR, 
+                                            DEFAULT_PREFETCH_BLOCKS, DEFAULT_BLOCK_PLAN_DIR, DEFAULT_STREAM_RESULTS, relationships_file, announcements_file, results_dir);
+    bool passed = e->compile_announcements(store_file);
+    delete e;
+    std::remove(announcements_file.c_str());
+
+    e = new Extrapolator<>(false, true, false, false, "unused", "results", "unused", "unused", "unused", "bgp", 1, -1, 1, false, NULL, 1, false,
+                            DEFAULT_PARALLEL_PROPAGATION, DEFAULT_PULL_PROPAGATION, DEFAULT_CONCURRENT_BLOCKS, DEFAULT_BFS_RANK_ORDER, DEFAULT_TOPOLOGY_SNAPSHOT_DIR, 
+                            DEFAULT_PREFETCH_BLOCKS, DEFAULT_BLOCK_PLAN_DIR, DEFAULT_STREAM_RESULTS, relationships_file, "", results_dir, 
+                            DEFAULT_RESULTS_FORMAT, DEFAULT_COMPRESS_RESULTS, store_file);
+    e->perform_propagation();
+    delete e;
+
+    // Format: asn,prefix,origin,received_from_asn,time,prefix_id
+    std::vector<std::string> true_results {
+        "1,137.99.0.0/16,1,1,0,0",
+        "2,137.99.0.0/16,1,1,0,0",
+        "5,137.99.0.0/16,1,2,0,0",
+        "1,137.98.0.0/16,5,2,0,1",
+        "2,137.98.0.0/16,5,5,0,1",
+        "3,137.98.0.0/16,5,2,0,1",
+        "5,137.98.0.0/16,5,5,0,1",
+        "6,137.98.0.0/16,5,5,0,1"
+    };
+
+    DIR *results = opendir(results_dir.c_str());
+    if (!passed || results == NULL) {
+        std::cerr << "Extrapolate store failed. No store or results directory" << std::endl;
+        return false;
+    }
+    std::vector<std::string> files;
+    for (struct dirent *entry = readdir(results); entry != NULL; entry = readdir(results)) {
+        if (entry->d_name[0] != '.') {
+            files.push_back(results_dir + "/" + entry->d_name);
+        }
+    }
+    closedir(results);
+
+    for (auto &file_name : files) {
+        std::ifstream results_file(file_name);
+        std::string line;
+        while (file_name.find(results_dir + "/results_") == 0 && std::getline(results_file, line)) {
+            auto it = std::find(true_results.begin(), true_results.end(), line);
+            if (it == true_results.end()) {
+                std::cerr << "Extrapolate store failed. Unexpected row " << line << std::endl;
+                passed = false;
+            } else {
+                true_results.erase(it);
+            }
+        }
+        std::remove(file_name.c_str());
+    }
+    if (!true_results.empty()) {
+        std::cerr << "Extrapolate store failed. Missing " << true_results.size() << " rows" << std::endl;
+        passed = false;
+    }
+
+    // A store that cannot be opened aborts the run
+    std::remove(store_file.c_str());
+    e = new Extrapolator<>(false, true, false, false, "unused", "results", "unused", "unused", "unused", "bgp", 1, -1, 1, false, NULL, 1, false,
+                            DEFAULT_PARALLEL_PROPAGATION, DEFAULT_PULL_PROPAGATION, DEFAULT_CONCURRENT_BLOCKS, DEFAULT_BFS_RANK_ORDER, DEFAULT_TOPOLOGY_SNAPSHOT_DIR, 
+                            DEFAULT_PREFETCH_BLOCKS, DEFAULT_BLOCK_PLAN_DIR, DEFAULT_STREAM_RESULTS, relationships_file, "", results_dir, 
+                            DEFAULT_RESULTS_FORMAT, DEFAULT_COMPRESS_RESULTS, store_file);
+    try {
+        e->perform_propagation();
+        std::cerr << "Extrapolate store failed. Ran without a store" << std::endl;
+        passed = false;
+    } catch (const std::runtime_error &error) { }
+    delete e;
+
+    rmdir(results_dir.c_str());
+    std::remove(relationships_file.c_str());
+    rmdir(dir.c_str());
+    return passed;
+}
@@ -25,10 +25,15 @@
 #define TEST_ANNOUNCEMENTS_TABLE "mrt_announcements_test"
 
 #include <iostream>
+#include <fstream>
 #include <cstdint>
 #include <vector>
+#include <algorithm>
+#include <unistd.h>
+#include <sys/stat.h>
 
 #include "Extrapolators/Extrapolator.h"
+#include "ResultSinks/FileResultSink.h"
 
 /** Unit tests for Extrapolator.h and Extrapolator.cpp
  */
@@ -265,6 +270,196 @@ bool test_give_ann_to_as_path_origin_only() {
     return true;
 }
 
+/** Test seeding a decoded block gives every AS the same announcements as seeding each path.
+ *
+ * Paths are decoded by PathDecoder, so ASes are found by their index, and paths with loops are dropped.
+ */
+bool test_seed_decoded_block() {
+    Extrapolator<> e[2];
+    for (Extrapolator<> &x : e) {
+        x.graph->add_relationship(2, 1, AS_REL_PROVIDER);
+        x.graph->add_relationship(1, 2, AS_REL_CUSTOMER);
+        x.graph->add_relationship(5, 2, AS_REL_PROVIDER);
+        x.graph->add_relationship(2, 5, AS_REL_CUSTOMER);
+        x.graph->add_relationship(4, 2, AS_REL_PROVIDER);
+        x.graph->add_relationship(2, 4, AS_REL_CUSTOMER);
+        x.graph->add_relationship(2, 3, AS_REL_PEER);
+        x.graph->add_relationship(3, 2, AS_REL_PEER);
+        x.graph->decide_ranks();
+    }
+
+    const char *paths[] = {"{3,2,5}", "{1,2,2,4}", "{7,2,5}", "{3,2,3}"};
+    Prefix<> p = Prefix<>("137.99.0.0", "255.255.0.0", 0, 0);
+    PathDecoder decoder;
+    DecodedBlock<> decoded;
+    for (int i = 0; i < 4; i++) {
+        if (decoder.decode_path(paths[i], *e[1].graph->asn_to_index)) {
+            e[0].give_ann_to_as_path(&decoder.path, p, i);
+            DecodedBlock<>::Row row = {p, decoder.path.back(), i, (uint32_t) decoded.asns.size(), (uint32_t) decoder.path.size()};
+            decoded.anns.push_back(row);
+            decoded.asns.insert(decoded.asns.end(), decoder.path.begin(), decoder.path.end());
+            decoded.indices.insert(decoded.indices.end(), decoder.indices.begin(), decoder.indices.end());
+        }
+    }
+    if (decoded.anns.size() != 3) {
+        std::cerr << "Loop not dropped." << std::endl;
+        return false;
+    }
+    e[1].seed_decoded_block(decoded);
+
+    for (uint32_t asn = 1; asn <= 5; asn++) {
+        auto *rib0 = e[0].graph->ases->find(asn)->second->all_anns;
+        auto *rib1 = e[1].graph->ases->find(asn)->second->all_anns;
+        auto ann0 = rib0->find(p);
+        auto ann1 = rib1->find(p);
+        if ((ann0 == rib0->end()) != (ann1 == rib1->end())) {
+            std::cerr << "Seeded ASes differ at " << asn << std::endl;
+            return false;
+        }
+        if (ann0 != rib0->end() && !((*ann0).origin == (*ann1).origin &&
+                                     (*ann0).priority == (*ann1).priority &&
+                                     (*ann0).received_from_asn == (*ann1).received_from_asn &&
+                                     (*ann0).tstamp == (*ann1).tstamp)) {
+            std::cerr << "Seeded announcements differ at " << asn << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+/** Test that the prefixes of a block get dense slots in RIBs smaller than their prefix_ids, 
+ *  and keep their prefix_id in the results.
+ *
+ *    1
+ *    |
+ *    2
+ *
+ * @return true if successful, otherwise false.
+ */
+bool test_prefix_slots() {
+    Extrapolator<> e = Extrapolator<>();
+    // Two slots, as init gives RIBs for a block of two prefixes
+    e.graph->max_block_prefix_id = 2;
+    e.graph->add_relationship(2, 1, AS_REL_PROVIDER);
+    e.graph->add_relationship(1, 2, AS_REL_CUSTOMER);
+    e.graph->decide_ranks();
+
+    std::unordered_map<uint32_t, uint32_t> prefix_slots;
+    uint32_t slot_p, slot_q, slot;
+    if (!e.assign_slot(5000, prefix_slots, slot_p) || !e.assign_slot(1000, prefix_slots, slot_q) ||
+        !e.assign_slot(5000, prefix_slots, slot) || slot_p != 0 || slot_q != 1 || slot != 0) {
+        std::cerr << "Prefixes were not given dense slots." << std::endl;
+        return false;
+    }
+    // No slot is left for a third prefix
+    if (e.assign_slot(7000, prefix_slots, slot) || prefix_slots.size() != 2) {
+        std::cerr << "A prefix was given a slot past the end of the RIBs." << std::endl;
+        return false;
+    }
+
+    Prefix<> p = Prefix<>("137.99.0.0", "255.255.0.0", 5000, slot_p);
+    Prefix<> q = Prefix<>("137.98.0.0", "255.255.0.0", 1000, slot_q);
+    DecodedBlock<> decoded;
+    e.decode_announcement(p, "{2}", 2, 0, decoded);
+    e.decode_announcement(q, "{1}", 1, 0, decoded);
+    e.seed_decoded_block(decoded);
+    e.propagate_up();
+    e.propagate_down();
+
+    auto *rib = e.graph->ases->find(1)->second->all_anns;
+    auto search = rib->find(p);
+    if (search == rib->end() || (*search).origin != 2 || (*search).prefix.id != 5000) {
+        std::cerr << "Announcement in slot " << slot_p << " is wrong." << std::endl;
+        return false;
+    }
+
+    // Format: asn,prefix,origin,received_from_asn,time,prefix_id
+    std::vector<std::string> true_results {
+        "1,137.99.0.0/16,2,2,0,5000",
+        "2,137.99.0.0/16,2,2,0,5000",
+        "1,137.98.0.0/16,1,1,0,1000",
+        "2,137.98.0.0/16,1,1,0,1000"
+    };
+    std::string dir = "/tmp/bgp-test-slots-" + std::to_string(getpid());
+    mkdir(dir.c_str(), 0777);
+    e.results_dir = dir;
+    e.result_sink = new FileResultSink<>(dir, false, false);
+    e.save_results(0);
+
+    bool passed = true;
+    for (int thread_num = 0; thread_num < e.writer_pool->size(); thread_num++) {
+        std::string file_name = dir + "/" + e.querier->results_table + "_0_" + std::to_string(thread_num) + ".csv";
+        std::ifstream results_file(file_name);
+        std::string line;
+        while (std::getline(results_file, line)) {
+            auto it = std::find(true_results.begin(), true_results.end(), line);
+            if (it == true_results.end()) {
+                std::cerr << "Unexpected row " << line << std::endl;
+                passed = false;
+            } else {
+                true_results.erase(it);
+            }
+        }
+        std::remove(file_name.c_str());
+    }
+    rmdir(dir.c_str());
+    if (!true_results.empty()) {
+        std::cerr << "Missing " << true_results.size() << " rows" << std::endl;
+        passed = false;
+    }
+    return passed;
+}
+
+/** Test that full path results kept in a directory get a file for each AS and block.
+ *
+ *    1
+ *    |
+ *    2
+ *
+ * @return true if successful, otherwise false.
+ */
+bool test_save_results_at_asn_dir() {
+    Extrapolator<> e = Extrapolator<>();
+    e.graph->add_relationship(2, 1, AS_REL_PROVIDER);
+    e.graph->add_relationship(1, 2, AS_REL_CUSTOMER);
+    e.graph->decide_ranks();
+
+    Prefix<> p = Prefix<>("137.99.0.0", "255.255.0.0", 7, 0);
+    DecodedBlock<> decoded;
+    e.decode_announcement(p, "{1}", 1, 0, decoded);
+    e.seed_decoded_block(decoded);
+    e.propagate_up();
+    e.propagate_down();
+
+    std::string dir = "/tmp/bgp-test-full-path-" + std::to_string(getpid());
+    mkdir(dir.c_str(), 0777);
+    e.results_dir = dir;
+    // Saving the same AS for two blocks must not add to one file
+    e.save_results_at_asn(2, NULL, 0);
+    e.save_results_at_asn(2, NULL, 1);
+
+    bool passed = true;
+    for (int iteration = 0; iteration < 2; iteration++) {
+        std::string file_name = dir + "/" + e.querier->full_path_results_table + "_2_" + std::to_string(iteration) + ".csv";
+        std::ifstream results_file(file_name);
+        std::vector<std::string> rows;
+        std::string line;
+        while (std::getline(results_file, line)) {
+            rows.push_back(line);
+        }
+        if (rows != std::vector<std::string>{"2,137.99.0.0/16,1,1,0,7,\"{2,1}\""}) {
+            std::cerr << "Full path results of block " << iteration << " are wrong, " << rows.size() << " rows" << std::endl;
+            for (auto &row : rows) {
+                std::cerr << row << std::endl;
+            }
+            passed = false;
+        }
+        std::remove(file_name.c_str());
+    }
+    rmdir(dir.c_str());
+    return passed;
+}
+
 /** Test propagating up without multihomed support in the following test graph.
  *  Horizontal lines are peer relationships, vertical lines are customer-provider
  * 
@@ -2067,6 +2262,204 @@ bool test_prepending_priority_beginning_existing_ann2() {
     return true;
 }
 
+/** Build a pseudo random graph of 60 ASes and seed 12 prefixes with 1 to 3 origins each.
+ *
+ *  Customer-provider edges always point to a higher ASN, so the graph has no cycles.
+ *  Origins and timestamps are drawn so that plenty of ties have to be broken.
+ */
+static void seed_random_announcements(Extrapolator<> &e, std::mt19937 &gen, uint32_t num_ases) {
+    for (uint32_t prefix_id = 0; prefix_id < 12; prefix_id++) {
+        Prefix<> p = Prefix<>(0x0A000000 + (prefix_id << 8), 0xFFFFFF00, prefix_id);
+        uint32_t num_origins = gen() % 3 + 1;
+        for (uint32_t i = 0; i < num_origins; i++) {
+            std::vector<uint32_t> as_path = {(uint32_t) (gen() % num_ases + 1)};
+            e.give_ann_to_as_path(&as_path, p, gen() % 2);
+        }
+    }
+}
+
+static void build_random_graph(Extrapolator<> &e, uint32_t seed) {
+    std::mt19937 gen(seed);
+    const uint32_t num_ases = 60;
+    for (uint32_t asn = 1; asn < num_ases; asn++) {
+        uint32_t num_providers = gen() % 3 + 1;
+        for (uint32_t i = 0; i < num_providers; i++) {
+            uint32_t provider = asn + 1 + gen() % std::min<uint32_t>(8, num_ases - asn);
+            e.graph->add_relationship(asn, provider, AS_REL_PROVIDER);
+            e.graph->add_relationship(provider, asn, AS_REL_CUSTOMER);
+        }
+    }
+    for (uint32_t i = 0; i < num_ases; i++) {
+        uint32_t a = gen() % num_ases + 1;
+        uint32_t b = gen() % num_ases + 1;
+        auto *as_a = e.graph->ases->find(a)->second;
+        if (a == b || as_a->providers->count(b) || as_a->customers->count(b)) {
+            continue;
+        }
+        e.graph->add_relationship(a, b, AS_REL_PEER);
+        e.graph->add_relationship(b, a, AS_REL_PEER);
+    }
+    e.graph->decide_ranks();
+
+    seed_random_announcements(e, gen, num_ases);
+}
+
+/** Check that two extrapolators hold the same announcements at every AS.
+ */
+static bool same_ribs(Extrapolator<> &a, Extrapolator<> &b) {
+    for (auto &as : *a.graph->ases) {
+        auto *other = b.graph->ases->find(as.first)->second;
+        if (as.second->all_anns->size() != other->all_anns->size()) {
+            return false;
+        }
+        for (auto &ann : *as.second->all_anns) {
+            auto search = other->all_anns->find(ann.prefix);
+            if (search == other->all_anns->end() ||
+                search->origin != ann.origin ||
+                search->received_from_asn != ann.received_from_asn ||
+                search->priority != ann.priority ||
+                search->tstamp != ann.tstamp) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/** Test that the rank parallel propagation gives the same results as the serial one,
+ *  with and without random tiebraking, on a pseudo random graph.
+ */
+bool test_propagate_parallel() {
+    for (bool random : {false, true}) {
+        for (uint32_t seed = 1; seed <= 5; seed++) {
+            Extrapolator<> serial = Extrapolator<>(random, DEFAULT_STORE_RESULTS, DEFAULT_STORE_INVERT_RESULTS, DEFAULT_STORE_DEPREF_RESULTS, 
+                                                ANNOUNCEMENTS_TABLE, RESULTS_TABLE, INVERSE_RESULTS_TABLE, DEPREF_RESULTS_TABLE, FULL_PATH_RESULTS_TABLE, 
+                                                DEFAULT_QUERIER_CONFIG_SECTION, DEFAULT_ITERATION_SIZE, -1, DEFAULT_MH_MODE, DEFAULT_ORIGIN_ONLY, NULL, DEFAULT_MAX_THREADS, DEFAULT_SELECT_BLOCK_ID);
+            Extrapolator<> parallel = Extrapolator<>(random, DEFAULT_STORE_RESULTS, DEFAULT_STORE_INVERT_RESULTS, DEFAULT_STORE_DEPREF_RESULTS, 
+                                                ANNOUNCEMENTS_TABLE, RESULTS_TABLE, INVERSE_RESULTS_TABLE, DEPREF_RESULTS_TABLE, FULL_PATH_RESULTS_TABLE, 
+                                                DEFAULT_QUERIER_CONFIG_SECTION, DEFAULT_ITERATION_SIZE, -1, DEFAULT_MH_MODE, DEFAULT_ORIGIN_ONLY, NULL, DEFAULT_MAX_THREADS, DEFAULT_SELECT_BLOCK_ID, true);
+            // Force several workers even on small machines
+            parallel.max_workers = 4;
+
+            build_random_graph(serial, seed);
+            build_random_graph(parallel, seed);
+
+            serial.propagate_up();
+            serial.propagate_down();
+            parallel.propagate_up();
+            parallel.propagate_down();
+
+            if (!same_ribs(serial, parallel)) {
+                std::cerr << "Parallel propagation differs from serial propagation, seed " << seed << ", random " << random << std::endl;
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// Compare the pull engine against the push engine on random graphs, for every multihomed mode and rank order
+bool test_propagate_pull() {
+    for (bool bfs : {false, true}) {
+        for (uint32_t mh_mode = 0; mh_mode <= 3; mh_mode++) {
+            for (bool random : {false, true}) {
+                for (uint32_t seed = 1; seed <= 5; seed++) {
+                    Extrapolator<> push = Extrapolator<>(random, DEFAULT_STORE_RESULTS, DEFAULT_STORE_INVERT_RESULTS, DEFAULT_STORE_DEPREF_RESULTS, 
+                                                        ANNOUNCEMENTS_TABLE, RESULTS_TABLE, INVERSE_RESULTS_TABLE, DEPREF_RESULTS_TABLE, FULL_PATH_RESULTS_TABLE, 
+                                                        DEFAULT_QUERIER_CONFIG_SECTION, DEFAULT_ITERATION_SIZE, -1, mh_mode, DEFAULT_ORIGIN_ONLY, NULL, DEFAULT_MAX_THREADS, DEFAULT_SELECT_BLOCK_ID, 
+                                                        DEFAULT_PARALLEL_PROPAGATION, DEFAULT_PULL_PROPAGATION, DEFAULT_CONCURRENT_BLOCKS, bfs);
+                    Extrapolator<> pull = Extrapolator<>(random, DEFAULT_STORE_RESULTS, DEFAULT_STORE_INVERT_RESULTS, DEFAULT_STORE_DEPREF_RESULTS, 
+                                                        ANNOUNCEMENTS_TABLE, RESULTS_TABLE, INVERSE_RESULTS_TABLE, DEPREF_RESULTS_TABLE, FULL_PATH_RESULTS_TABLE, 
+                                                        DEFAULT_QUERIER_CONFIG_SECTION, DEFAULT_ITERATION_SIZE, -1, mh_mode, DEFAULT_ORIGIN_ONLY, NULL, DEFAULT_MAX_THREADS, DEFAULT_SELECT_BLOCK_ID, 
+                                                        DEFAULT_PARALLEL_PROPAGATION, true, DEFAULT_CONCURRENT_BLOCKS, bfs);
+
+                    build_random_graph(push, seed);
+                    build_random_graph(pull, seed);
+
+                    push.propagate_up();
+                    push.propagate_down();
+                    pull.propagate_up();
+                    pull.propagate_down();
+
+                    if (!same_ribs(push, pull)) {
+                        std::cerr << "Pull propagation differs from push propagation, seed " << seed << ", random " << random << ", mh_mode " << mh_mode << ", bfs " << bfs << std::endl;
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/** Test that block workers share the topology of the graph, and that two of them can 
+ *  propagate different announcements at the same time, as with two concurrent blocks.
+ */
+bool test_block_workers() {
+    Extrapolator<> e = Extrapolator<>(false, DEFAULT_STORE_RESULTS, DEFAULT_STORE_INVERT_RESULTS, DEFAULT_STORE_DEPREF_RESULTS, 
+                                        ANNOUNCEMENTS_TABLE, RESULTS_TABLE, INVERSE_RESULTS_TABLE, DEPREF_RESULTS_TABLE, FULL_PATH_RESULTS_TABLE, 
+                                        DEFAULT_QUERIER_CONFIG_SECTION, DEFAULT_ITERATION_SIZE, -1, DEFAULT_MH_MODE, DEFAULT_ORIGIN_ONLY, NULL, DEFAULT_MAX_THREADS, DEFAULT_SELECT_BLOCK_ID, 
+                                        DEFAULT_PARALLEL_PROPAGATION, DEFAULT_PULL_PROPAGATION, 2);
+    build_random_graph(e, 1);
+    e.graph->clear_announcements();
+
+    Extrapolator<> *workers[2];
+    for (int i = 0; i < 2; i++) {
+        workers[i] = dynamic_cast<Extrapolator<>*>(e.create_block_worker());
+        if (workers[i] == NULL || workers[i]->graph->ases->size() != e.graph->ases->size()) {
+            std::cerr << "Block worker was not created from the graph" << std::endl;
+            return false;
+        }
+        for (auto &as : *e.graph->ases) {
+            auto *worker_as = workers[i]->graph->ases->find(as.first)->second;
+            if (worker_as == as.second || worker_as->providers != as.second->providers || 
+                worker_as->customers != as.second->customers || worker_as->peers != as.second->peers ||
+                worker_as->rank != as.second->rank || worker_as->all_anns == as.second->all_anns) {
+                std::cerr << "Block worker does not share the topology of AS " << as.first << std::endl;
+                return false;
+            }
+        }
+
+        // Each worker gets different announcements
+        std::mt19937 gen(2 + i);
+        seed_random_announcements(*workers[i], gen, 60);
+    }
+
+    std::thread threads[2];
+    for (int i = 0; i < 2; i++) {
+        threads[i] = std::thread([&workers, i]() {
+            workers[i]->propagate_up();
+            workers[i]->propagate_down();
+        });
+    }
+    for (int i = 0; i < 2; i++) {
+        threads[i].join();
+    }
+
+    bool same = true;
+    for (int i = 0; i < 2; i++) {
+        Extrapolator<> reference = Extrapolator<>(false, DEFAULT_STORE_RESULTS, DEFAULT_STORE_INVERT_RESULTS, DEFAULT_STORE_DEPREF_RESULTS, 
+                                        ANNOUNCEMENTS_TABLE, RESULTS_TABLE, INVERSE_RESULTS_TABLE, DEPREF_RESULTS_TABLE, FULL_PATH_RESULTS_TABLE, 
+                                        DEFAULT_QUERIER_CONFIG_SECTION, DEFAULT_ITERATION_SIZE, -1, DEFAULT_MH_MODE, DEFAULT_ORIGIN_ONLY, NULL, DEFAULT_MAX_THREADS, DEFAULT_SELECT_BLOCK_ID);
+        build_random_graph(reference, 1);
+        reference.graph->clear_announcements();
+        std::mt19937 gen(2 + i);
+        seed_random_announcements(reference, gen, 60);
+        reference.propagate_up();
+        reference.propagate_down();
+
+        if (!same_ribs(reference, *workers[i])) {
+            std::cerr << "Block worker " << i << " differs from serial propagation" << std::endl;
+            same = false;
+        }
+    }
+
+    for (int i = 0; i < 2; i++) {
+        delete workers[i];
+    }
+    return same;
+}
+
 // Create an announcements table and insert two announcements with different prefixes and different block_id values
 bool test_extrapolation_buildup() {
     try {
@@ -2116,6 +2509,90 @@ bool test_extrapolation_teardown() {
     return true;
 }
 
+/** Test that blocks planned from the count of each prefix split the address space as populate_blocks does,
+ *  and are sized by the announcements in each prefix block and then each subnet block.
+ */
+template <typename PrefixType>
+static bool check_block_plan(std::vector<std::pair<std::string, uint32_t>> counts, uint32_t iteration_size,
+                                std::vector<std::string> prefixes, std::vector<std::string> subnets, uint32_t max_block_prefixes,
+                                std::vector<uint32_t> sizes) {
+    Extrapolator<PrefixType> e = Extrapolator<PrefixType>(false, false, false, false, "unused", "unused", "unused", "unused", "unused", "bgp", iteration_size, -1, 1, false, NULL, 0, false);
+    std::vector<std::pair<Prefix<PrefixType>, uint32_t>> prefix_counts;
+    for (auto &count : counts) {
+        size_t slash = count.first.find('/');
+        std::string host = count.first.substr(0, slash);
+        Prefix<PrefixType> prefix(host, host, 0, 0);
+        int length = std::stoi(count.first.substr(slash + 1));
+        prefix.netmask = length == 0 ? 0 : ~((PrefixType) 0) << (sizeof(PrefixType) * 8 - length);
+        prefix_counts.push_back(std::make_pair(prefix, count.second));
+    }
+
+    std::vector<Prefix<PrefixType>*> prefix_blocks, subnet_blocks;
+    std::vector<uint32_t> block_sizes;
+    if (e.plan_blocks_from_counts(prefix_counts, &prefix_blocks, &subnet_blocks, &block_sizes) != max_block_prefixes) {
+        std::cerr << "Wrong number of prefixes in the largest block." << std::endl;
+        return false;
+    }
+    if (block_sizes != sizes) {
+        std::cerr << "Wrong number of announcements in the planned blocks." << std::endl;
+        return false;
+    }
+
+    // A saved plan loads back the same, only with its own key and into RIBs its blocks fit in
+    std::string file_name = "/tmp/bgp-block-plan-test.bin";
+    std::vector<Prefix<PrefixType>*> loaded_prefix_blocks, loaded_subnet_blocks;
+    std::vector<uint32_t> loaded_sizes;
+    if (!e.save_block_plan(file_name, "key", max_block_prefixes, &prefix_blocks, &subnet_blocks, block_sizes) ||
+        e.load_block_plan(file_name, "other", max_block_prefixes, &loaded_prefix_blocks, &loaded_subnet_blocks, &loaded_sizes) ||
+        e.load_block_plan(file_name, "key", max_block_prefixes - 1, &loaded_prefix_blocks, &loaded_subnet_blocks, &loaded_sizes) ||
+        !e.load_block_plan(file_name, "key", max_block_prefixes, &loaded_prefix_blocks, &loaded_subnet_blocks, &loaded_sizes) ||
+        loaded_sizes != sizes) {
+        std::cerr << "Block plan was not saved and loaded." << std::endl;
+        return false;
+    }
+    std::remove(file_name.c_str());
+
+    std::vector<Prefix<PrefixType>*> *planned[] = {&prefix_blocks, &subnet_blocks, &loaded_prefix_blocks, &loaded_subnet_blocks};
+    std::vector<std::string> *expected[] = {&prefixes, &subnets, &prefixes, &subnets};
+    for (int i = 0; i < 4; i++) {
+        std::vector<std::string> cidrs;
+        for (Prefix<PrefixType> *prefix : *planned[i]) {
+            cidrs.push_back(prefix->to_cidr());
+            delete prefix;
+        }
+        if (cidrs != *expected[i]) {
+            std::cerr << "Planned blocks differ:";
+            for (auto &cidr : cidrs) {
+                std::cerr << " " << cidr;
+            }
+            std::cerr << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+/** Test planning blocks from the count of each prefix, for IPv4 and IPv6.
+ */
+bool test_plan_blocks_from_counts() {
+    // 10.0.0.0/8 is too large for a subnet block, so its announcements are a prefix block
+    // and the lower half of it is a subnet block
+    if (!check_block_plan<uint32_t>({{"10.0.0.0/8", 2}, {"10.1.0.0/16", 1}, {"10.2.0.0/16", 1}, {"192.168.0.0/16", 1}}, 3,
+                                    {"10.0.0.0/8"}, {"10.0.0.0/9", "128.0.0.0/1"}, 2, {2, 2, 1})) {
+        return false;
+    }
+    // Everything fits in one block
+    if (!check_block_plan<uint32_t>({{"10.0.0.0/8", 2}, {"192.168.0.0/16", 1}}, 10000, {}, {"0.0.0.0/0"}, 2, {3})) {
+        return false;
+    }
+    // A prefix larger than a block still ends the split
+    if (!check_block_plan<uint32_t>({{"1.2.3.4/32", 5}}, 3, {"1.2.3.4/32"}, {}, 1, {5})) {
+        return false;
+    }
+    return check_block_plan<uint128_t>({{"2001:db8::/32", 3}, {"2001:db8:1::/48", 1}}, 3,
+                                        {"2001:db8:0:0:0:0:0:0/32"}, {"2001:db8:0:0:0:0:0:0/33"}, 1, {3, 1});
+}
+
 /** Test extrapolate blocks in the following test graph (same as the propagate_down test graph).
  *  Horizontal lines are peer relationships, vertical lines are customer-provider
  * 
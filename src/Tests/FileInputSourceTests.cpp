@@ -0,0 +1,280 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include <unistd.h>
+#include <dirent.h>
+#include <algorithm>
+#include <stdexcept>
+
+#include "InputSources/FileInputSource.h"
+#include "Extrapolators/Extrapolator.h"
+
+/** Unit tests for FileInputSource.h
+ */
+
+/** Tests parsing as-rel lines in the CAIDA and csv formats.
+ *
+ * @return true if successful, otherwise false.
+ */
+bool test_parse_relationship() {
+    uint32_t as_1, as_2;
+    int relationship;
+
+    char serial_2[] = "174|13796|-1|bgp";
+    if (!FileInputSource<>::parse_relationship(serial_2, as_1, as_2, relationship) ||
+        as_1 != 174 || as_2 != 13796 || relationship != -1) {
+        std::cerr << "Failed to parse serial-2 relationship" << std::endl;
+        return false;
+    }
+    char csv[] = "3356,174,0";
+    if (!FileInputSource<>::parse_relationship(csv, as_1, as_2, relationship) ||
+        as_1 != 3356 || as_2 != 174 || relationship != 0) {
+        std::cerr << "Failed to parse csv relationship" << std::endl;
+        return false;
+    }
+
+    // Comments, siblings, and malformed lines are skipped
+    char comment[] = "# source:topology|BGP";
+    char sibling[] = "1|2|1";
+    char malformed[] = "1|x|0";
+    char truncated[] = "1|2";
+    if (FileInputSource<>::parse_relationship(comment, as_1, as_2, relationship) ||
+        FileInputSource<>::parse_relationship(sibling, as_1, as_2, relationship) ||
+        FileInputSource<>::parse_relationship(malformed, as_1, as_2, relationship) ||
+        FileInputSource<>::parse_relationship(truncated, as_1, as_2, relationship)) {
+        std::cerr << "Parsed an invalid relationship" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/** Tests parsing announcement rows and prefixes of both address families.
+ *
+ * @return true if successful, otherwise false.
+ */
+bool test_parse_announcement() {
+    Prefix<> p;
+    char *as_path;
+    uint32_t origin;
+    int64_t timestamp;
+
+    char csv[] = "137.99.0.0/16,\"{3,2,1}\",1,1600000000";
+    if (!FileInputSource<>::parse_announcement(csv, p, as_path, origin, timestamp) ||
+        p.addr != 0x89630000 || p.netmask != 0xffff0000 || std::string(as_path) != "{3,2,1}" ||
+        origin != 1 || timestamp != 1600000000) {
+        std::cerr << "Failed to parse csv announcement" << std::endl;
+        return false;
+    }
+
+    // Paths separated by spaces become arrays
+    char tsv[] = "10.0.0.0/8\t3 2 1\t1\t-5";
+    if (!FileInputSource<>::parse_announcement(tsv, p, as_path, origin, timestamp) ||
+        p.addr != 0x0a000000 || p.netmask != 0xff000000 || std::string(as_path) != "3,2,1" || timestamp != -5) {
+        std::cerr << "Failed to parse tsv announcement" << std::endl;
+        return false;
+    }
+
+    // Headers and the other address family are skipped
+    char header[] = "prefix,as_path,origin,time";
+    char ipv6[] = "2001:db8::/32,\"{3,2,1}\",1,0";
+    if (FileInputSource<>::parse_announcement(header, p, as_path, origin, timestamp) ||
+        FileInputSource<>::parse_announcement(ipv6, p, as_path, origin, timestamp)) {
+        std::cerr << "Parsed an invalid announcement" << std::endl;
+        return false;
+    }
+
+    Prefix<uint128_t> p6;
+    if (!FileInputSource<uint128_t>::parse_prefix("2001:db8::/32", p6) ||
+        p6.netmask != ((uint128_t) 0xffffffff << 96) || (p6.addr >> 96) != 0x20010db8) {
+        std::cerr << "Failed to parse IPv6 prefix" << std::endl;
+        return false;
+    }
+    Prefix<> p0;
+    if (!FileInputSource<>::parse_prefix("0.0.0.0/0", p0) || p0.netmask != 0 ||
+        FileInputSource<>::parse_prefix("10.0.0.0/33", p0) || FileInputSource<>::parse_prefix("10.0.0.0", p0)) {
+        std::cerr << "Failed to check prefix length" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/** Tests that blocks are cut at prefix boundaries and the prefixes are numbered, 
+ *  and that a file whose rows of a prefix are not together is refused.
+ *
+ * @return true if successful, otherwise false.
+ */
+bool test_read_announcements() {
+    std::string file_name = "/tmp/bgp-test-announcements-" + std::to_string(getpid()) + ".csv";
+    std::ofstream file(file_name);
+    file << "prefix,as_path,origin,time\n"
+         << "137.99.0.0/16,\"{2,1}\",1,0\n"
+         << "137.99.0.0/16,\"{3,1}\",1,0\n"
+         << "137.99.0.0/16,\"{4,1}\",1,0\n"
+         << "137.98.0.0/16,{5},5,0\n"
+         << "2001:db8::/32,{6},6,0\n"
+         << "137.97.0.0/16,{7},7,0\n";
+    file.close();
+
+    FileInputSource<> input("", file_name);
+    std::vector<std::string> rows;
+    auto add = [&rows](const Prefix<> &prefix, const char *as_path, uint32_t origin, int64_t timestamp) {
+        rows.push_back(prefix.to_cidr() + " " + std::to_string(prefix.id) + " " + std::to_string(prefix.block_id) + " " + as_path);
+    };
+
+    // The first prefix is read whole even though it is over max_rows
+    bool passed = input.read_announcements(2, add) == 3 && rows.size() == 3 &&
+                  rows[0] == "137.99.0.0/16 0 0 {2,1}" && rows[2] == "137.99.0.0/16 0 0 {4,1}";
+    rows.clear();
+    passed = passed && input.read_announcements(2, add) == 2 && rows.size() == 2 &&
+             rows[0] == "137.98.0.0/16 1 0 {5}" && rows[1] == "137.97.0.0/16 2 1 {7}";
+    rows.clear();
+    passed = passed && input.read_announcements(2, add) == 0;
+
+    // Rewinding starts over from the first block
+    input.rewind_announcements();
+    passed = passed && input.read_announcements(10, add) == 5 && rows.back() == "137.97.0.0/16 2 2 {7}";
+
+    file.open(file_name);
+    file << "137.99.0.0/16,{2},2,0\n"
+         << "137.98.0.0/16,{5},5,0\n"
+         << "137.99.0.0/16,{3},3,0\n";
+    file.close();
+    FileInputSource<> unsorted_input("", file_name);
+    try {
+        unsorted_input.read_announcements(1, add);
+        unsorted_input.read_announcements(1, add);
+        unsorted_input.read_announcements(1, add);
+        passed = false;
+    } catch (const std::runtime_error &error) { }
+
+    std::remove(file_name.c_str());
+    if (!passed) {
+        std::cerr << "Failed to read announcement blocks" << std::endl;
+    }
+    return passed;
+}
+
+/** Extrapolate from files into csvs in the following test graph, without a database.
+ *  Horizontal lines are peer relationships, vertical lines are customer-provider
+ * 
+ *    1
+ *    |
+ *    2--3
+ *   /|   
+ *  4 5--6 
+ *
+ *  AS 4 is a stub, so it is written to the stubs csv instead of the results and inverse results.
+ *
+ * @return true if successful, otherwise false.
+ */
+bool test_extrapolate_input() {
+    std::string dir = "/tmp/bgp-test-input-" + std::to_string(getpid());
+    mkdir(dir.c_str(), 0777);
+    std::string relationships_file = dir + "/as-rel.txt";
+    std::string announcements_file = dir + "/announcements.tsv";
+    std::string results_dir = dir + "/results";
+
+    std::ofstream file(relationships_file);
+    file << "# 1 is the provider of 2\n1|2|-1\n2|4|-1\n2|5|-1\n2|3|0\n5|6|0\n";
+    file.close();
+    file.open(announcements_file);
+    file << "137.99.0.0/16\t{1}\t1\t0\n137.98.0.0/16\t{5}\t5\t0\n";
+    file.close();
+
+    // One prefix in each block
+    Extrapolator<> *e = new Extrapolator<>(false, true, true, false, "unused", "results", "inverse", "unused", "unused", "bgp", 1, -1, 1, false, NULL, 1, false,
+                                            DEFAULT_PARALLEL_PROPAGATION, DEFAULT_PULL_PROPAGATION, DEFAULT_CONCURRENT_BLOCKS, DEFAULT_BFS_RANK_ORDER, DEFAULT_TOPOLOGY_SNAPSHOT_DIR, 
+                                            DEFAULT_PREFETCH_BLOCKS, DEFAULT_BLOCK_PLAN_DIR, DEFAULT_STREAM_RESULTS, relationships_file, announcements_file, results_dir);
+    e->perform_propagation();
+    delete e;
+
+    // Format: asn,prefix,origin,received_from_asn,time,prefix_id
+    std::vector<std::string> true_results {
+        "1,137.99.0.0/16,1,1,0,0",
+        "2,137.99.0.0/16,1,1,0,0",
+        "5,137.99.0.0/16,1,2,0,0",
+        "1,137.98.0.0/16,5,2,0,1",
+        "2,137.98.0.0/16,5,5,0,1",
+        "3,137.98.0.0/16,5,2,0,1",
+        "5,137.98.0.0/16,5,5,0,1",
+        "6,137.98.0.0/16,5,5,0,1"
+    };
+    // Format: asn,prefix,origin,prefix_id
+    // The non-stubs without a route to the prefix-origin, every non-stub has one for 137.98.0.0/16
+    std::vector<std::string> true_inverse_results {
+        "3,137.99.0.0/16,1,0",
+        "6,137.99.0.0/16,1,0"
+    };
+
+    // Gather the rows of every results csv, one per block
+    bool passed = true;
+    std::vector<std::string> files;
+    DIR *results = opendir(results_dir.c_str());
+    if (results == NULL) {
+        std::cerr << "Extrapolate input failed. No results directory" << std::endl;
+        return false;
+    }
+    for (struct dirent *entry = readdir(results); entry != NULL; entry = readdir(results)) {
+        if (entry->d_name[0] != '.') {
+            files.push_back(results_dir + "/" + entry->d_name);
+        }
+    }
+    closedir(results);
+
+    for (auto &file_name : files) {
+        std::ifstream results_file(file_name);
+        std::string line;
+        while (std::getline(results_file, line)) {
+            if (file_name == results_dir + "/" + STUBS_TABLE + ".csv") {
+                passed &= line == "4,2";
+                continue;
+            }
+            std::vector<std::string> *expected;
+            if (file_name.find(results_dir + "/results_") == 0) {
+                expected = &true_results;
+            } else if (file_name.find(results_dir + "/inverse_") == 0) {
+                expected = &true_inverse_results;
+            } else {
+                continue;
+            }
+            auto it = std::find(expected->begin(), expected->end(), line);
+            if (it == expected->end()) {
+                std::cerr << "Extrapolate input failed. Unexpected row " << line << std::endl;
+                passed = false;
+            } else {
+                expected->erase(it);
+            }
+        }
+        std::remove(file_name.c_str());
+    }
+    if (!true_results.empty() || !true_inverse_results.empty()) {
+        std::cerr << "Extrapolate input failed. Missing " << true_results.size() + true_inverse_results.size() << " rows" << std::endl;
+        passed = false;
+    }
+
+    rmdir(results_dir.c_str());
+    std::remove(relationships_file.c_str());
+    std::remove(announcements_file.c_str());
+    rmdir(dir.c_str());
+    return passed;
+}
@@ -0,0 +1,132 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include <iostream>
+#include <algorithm>
+
+#include "InverseResults.h"
+#include "Graphs/ASGraph.h"
+
+/** Unit tests for InverseResults.h
+ */
+
+/** Tests that seeds are deduplicated and start with every AS, including past the first word.
+ *
+ * @return true if successful, otherwise false.
+ */
+bool test_inverse_results() {
+    std::vector<uint32_t> asns;
+    for (uint32_t asn = 1; asn <= 70; asn++)
+        asns.push_back(asn);
+    Prefix<> p = Prefix<>("137.99.0.0", "255.255.0.0", 0, 0);
+    Prefix<> q = Prefix<>("137.98.0.0", "255.255.0.0", 1, 1);
+
+    InverseResults<> inverse;
+    inverse.add_seed(q, 5);
+    inverse.add_seed(p, 1);
+    inverse.add_seed(p, 2);
+    inverse.add_seed(p, 1);
+    inverse.prepare(&asns);
+    if (inverse.size() != 3 || inverse.num_words() != 2 || inverse.count(0) != 70) {
+        std::cerr << "Seeds were not prepared, " << inverse.size() << " pairs" << std::endl;
+        return false;
+    }
+
+    size_t pair = inverse.find(p, 2);
+    if (pair == InverseResults<>::npos || inverse.at(pair).second != 2 || 
+        inverse.find(q, 1) != InverseResults<>::npos || inverse.find(Prefix<>("10.0.0.0", "255.0.0.0", 9, 9), 1) != InverseResults<>::npos) {
+        std::cerr << "Pairs were not found by prefix and origin" << std::endl;
+        return false;
+    }
+
+    // Erase from both words
+    inverse.erase(pair, 0);
+    inverse.erase(pair, 69);
+    std::vector<uint32_t> left;
+    inverse.for_each_asn(pair, [&left](uint32_t asn) { left.push_back(asn); });
+    if (inverse.count(pair) != 68 || left.size() != 68 || left.front() != 2 || left.back() != 69 ||
+        inverse.count(inverse.find(p, 1)) != 70) {
+        std::cerr << "ASes were not erased from the pair" << std::endl;
+        return false;
+    }
+
+    inverse.clear();
+    if (inverse.size() != 0) {
+        std::cerr << "Inverse results were not cleared" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/** Tests that the saved RIBs take each AS out of the pair it holds, whatever the number of parts.
+ *  Horizontal lines are peer relationships, vertical lines are customer-provider
+ *
+ *    1
+ *    |
+ *    2--3
+ *
+ *  AS 4 is a non-stub merged into a supernode, so no AS holds a route for it.
+ *
+ * @return true if successful, otherwise false.
+ */
+bool test_compute_inverse_results() {
+    Prefix<> p = Prefix<>("137.99.0.0", "255.255.0.0", 0, 0);
+    Prefix<> q = Prefix<>("137.98.0.0", "255.255.0.0", 1, 1);
+
+    for (int num_parts = 1; num_parts <= 3; num_parts++) {
+        ASGraph<> graph = ASGraph<>(true, false);
+        graph.max_block_prefix_id = 2;
+        graph.add_relationship(2, 1, AS_REL_PROVIDER);
+        graph.add_relationship(1, 2, AS_REL_CUSTOMER);
+        graph.add_relationship(2, 3, AS_REL_PEER);
+        graph.add_relationship(3, 2, AS_REL_PEER);
+        graph.non_stubs->assign({1, 2, 3, 4});
+
+        graph.inverse_results->add_seed(p, 10);
+        graph.inverse_results->add_seed(p, 20);
+        graph.inverse_results->add_seed(q, 30);
+        graph.ases->find(1)->second->all_anns->insert(p, Announcement<>(10, p, 10));
+        graph.ases->find(2)->second->all_anns->insert(p, Announcement<>(20, p, 20));
+        graph.ases->find(3)->second->all_anns->insert(p, Announcement<>(10, p, 2));
+        // Not seeded for this origin
+        graph.ases->find(3)->second->all_anns->insert(q, Announcement<>(10, q, 2));
+
+        graph.prepare_inverse_results();
+        for (int part = 0; part < num_parts; part++)
+            graph.compute_inverse_results(part, num_parts);
+
+        InverseResults<> &inverse = *graph.saved_inverse_results;
+        auto asns = [&inverse](size_t pair) {
+            std::vector<uint32_t> left;
+            inverse.for_each_asn(pair, [&left](uint32_t asn) { left.push_back(asn); });
+            return left;
+        };
+        if (asns(inverse.find(p, 10)) != std::vector<uint32_t>({2, 4}) ||
+            asns(inverse.find(p, 20)) != std::vector<uint32_t>({1, 3, 4}) ||
+            asns(inverse.find(q, 30)) != std::vector<uint32_t>({1, 2, 3, 4})) {
+            std::cerr << "Inverse results are wrong with " << num_parts << " parts" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
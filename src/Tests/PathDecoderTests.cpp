@@ -0,0 +1,115 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include "PathDecoder.h"
+
+/** Unit tests for PathDecoder.h
+ */
+
+/** Tests decoding AS paths, with prepending, translation, and malformed tokens.
+ *
+ * @return true if successful, otherwise false.
+ */
+bool test_decode_path() {
+    PathDecoder decoder;
+    std::unordered_map<uint32_t, uint32_t> asn_to_index = {{1, 0}, {2, 1}, {3, 2}};
+
+    // Prepending is kept on the path
+    if (!decoder.decode_path("{3,2,2,1,1}", asn_to_index)) {
+        return false;
+    }
+    if (decoder.path != std::vector<uint32_t>({3, 2, 2, 1, 1}) ||
+        decoder.indices != std::vector<uint32_t>({2, 1, 1, 0, 0})) {
+        return false;
+    }
+
+    // ASNs outside the graph have no index
+    if (!decoder.decode_path("{7,1}", asn_to_index) || 
+        decoder.indices != std::vector<uint32_t>({NO_INDEX, 0})) {
+        return false;
+    }
+
+    // Malformed tokens are skipped
+    if (!decoder.decode_path("{3,x,4294967296,1}", asn_to_index) || 
+        decoder.path != std::vector<uint32_t>({3, 1})) {
+        return false;
+    }
+
+    // Empty paths decode to nothing
+    if (!decoder.decode_path("{}", asn_to_index) || !decoder.path.empty()) {
+        return false;
+    }
+    return true;
+}
+
+/** Tests that loops are found in the graph and outside it, across several paths.
+ *
+ * @return true if successful, otherwise false.
+ */
+bool test_decode_path_loops() {
+    PathDecoder decoder;
+    std::unordered_map<uint32_t, uint32_t> asn_to_index = {{1, 0}, {2, 1}, {3, 2}};
+
+    if (decoder.decode_path("{1,2,1}", asn_to_index) ||
+        decoder.decode_path("{7,8,7,1}", asn_to_index) ||
+        decoder.decode_path("{3,3,2,3}", asn_to_index)) {
+        return false;
+    }
+    // Nothing seen on an earlier path carries over
+    if (!decoder.decode_path("{1,2,3}", asn_to_index) ||
+        !decoder.decode_path("{3,2,1}", asn_to_index) ||
+        !decoder.decode_path("{7,8}", asn_to_index)) {
+        return false;
+    }
+    return true;
+}
+
+/** Tests parsing addresses and timestamps in place.
+ *
+ * @return true if successful, otherwise false.
+ */
+bool test_decode_fields() {
+    uint32_t addr;
+    if (!PathDecoder::parse_ipv4("1.2.3.4", addr) || addr != 0x01020304) {
+        return false;
+    }
+    if (!PathDecoder::parse_ipv4("255.255.255.0", addr) || addr != 0xffffff00) {
+        return false;
+    }
+    if (PathDecoder::parse_ipv4("256.1.1.0", addr) || PathDecoder::parse_ipv4("1.1.1", addr) ||
+        PathDecoder::parse_ipv4("1.1.1.1.1", addr) || PathDecoder::parse_ipv4("::1", addr)) {
+        return false;
+    }
+
+    int64_t timestamp;
+    if (!PathDecoder::parse_int64("1583020800", timestamp) || timestamp != 1583020800) {
+        return false;
+    }
+    if (!PathDecoder::parse_int64("-5", timestamp) || timestamp != -5) {
+        return false;
+    }
+    if (PathDecoder::parse_int64("", timestamp) || PathDecoder::parse_int64("12a", timestamp)) {
+        return false;
+    }
+    return true;
+}
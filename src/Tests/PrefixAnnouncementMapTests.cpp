@@ -46,4 +46,132 @@ bool prefixAnnouncementMap_test_insert() {
     }
 
     return true;
-}
\ No newline at end of file
+}
+
+bool prefixAnnouncementMap_test_iteration() {
+    PrefixAnnouncementMap<Announcement<>> map(200);
+
+    // Slots on both sides of the boundaries between bitmap words
+    std::vector<uint32_t> slots = {0, 1, 63, 64, 65, 127, 128, 199};
+    for(uint32_t slot : slots) {
+        Prefix<> p(slot << 8, 0xFFFFFF00, slot, slot);
+        map.insert(p, Announcement<>(slot + 1, p, 0));
+    }
+
+    std::vector<uint32_t> found;
+    for(auto &ann : map)
+        found.push_back(ann.prefix.block_id);
+
+    if(found != slots) {
+        std::cerr << "Iteration did not visit exactly the filled slots in order!" << std::endl;
+        return false;
+    }
+
+    if(map.size() != slots.size() || map.count_filled() != slots.size()) {
+        std::cerr << "Size does not match the number of filled slots!" << std::endl;
+        return false;
+    }
+
+    // Erasing leaves the other slots in place
+    Prefix<> p64(64 << 8, 0xFFFFFF00, 64, 64);
+    map.erase(p64);
+    if(map.find(p64) != map.end() || map.filled(p64) || map.size() != slots.size() - 1 || map.count_filled() != slots.size() - 1) {
+        std::cerr << "Erase did not empty the slot!" << std::endl;
+        return false;
+    }
+
+    Prefix<> p65(65 << 8, 0xFFFFFF00, 65, 65);
+    if(map.find(p65) == map.end() || map.find(p65)->origin != 66) {
+        std::cerr << "Erase removed the wrong slot!" << std::endl;
+        return false;
+    }
+
+    map.clear();
+    if(!map.empty() || map.count_filled() != 0 || map.begin() != map.end()) {
+        std::cerr << "Clear did not empty the map!" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool prefixAnnouncementMap_test_clear() {
+    PrefixAnnouncementMap<Announcement<>> map(1000);
+
+    // Empty a word of the bitmap with erase, then fill it again before clearing
+    Prefix<> p1(1 << 8, 0xFFFFFF00, 1, 1);
+    Prefix<> p2(2 << 8, 0xFFFFFF00, 2, 2);
+    Prefix<> p900(900 << 8, 0xFFFFFF00, 900, 900);
+    map.insert(p1, Announcement<>(1, p1, 0));
+    map.erase(p1);
+    map.insert(p2, Announcement<>(2, p2, 0));
+    map.insert(p900, Announcement<>(900, p900, 0));
+
+    map.clear();
+    if(!map.empty() || map.count_filled() != 0 || map.begin() != map.end() || map.find(p2) != map.end() || map.find(p900) != map.end()) {
+        std::cerr << "Clear did not empty every written slot!" << std::endl;
+        return false;
+    }
+
+    // The map is usable again after clearing
+    map.insert(p900, Announcement<>(901, p900, 0));
+    if(map.size() != 1 || map.count_filled() != 1 || map.begin()->origin != 901) {
+        std::cerr << "Map is not usable after clear!" << std::endl;
+        return false;
+    }
+    map.clear();
+    if(!map.empty() || map.begin() != map.end()) {
+        std::cerr << "Second clear did not empty the map!" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+bool prefixAnnouncementMap_test_compact() {
+    // Plain announcements must take at least three times less room in a RIB than whole ones
+    if(sizeof(RIBEntry<Announcement<>, uint32_t>::Record) * 3 > sizeof(Announcement<>) ||
+       sizeof(RIBEntry<Announcement<uint128_t>, uint128_t>::Record) * 3 > sizeof(Announcement<uint128_t>)) {
+        std::cerr << "RIB records of plain announcements are not compact!" << std::endl;
+        return false;
+    }
+
+    // Two maps sharing a prefix table, as the RIBs of a graph do
+    std::vector<Prefix<uint128_t>> table;
+    PrefixAnnouncementMap<Announcement<uint128_t>, uint128_t> map1(100);
+    PrefixAnnouncementMap<Announcement<uint128_t>, uint128_t> map2(100);
+    map1.share_prefixes(&table);
+    map2.share_prefixes(&table);
+
+    Prefix<uint128_t> p(uint128_t(0x20010DB8) << 96, ~uint128_t(0) << 96, 7, 42);
+    Priority pr;
+    pr.relationship = 2;
+    pr.path_length = 3;
+    // The timestamp does not fit in 32 bits
+    map1.insert(p, Announcement<uint128_t>(64500, p, pr, 64501, 5000000000, true));
+
+    auto search = map1.find(p);
+    if(search == map1.end() || search->prefix != p || search->prefix.id != 7 || search->origin != 64500 ||
+       search->received_from_asn != 64501 || search->tstamp != 5000000000 || !search->from_monitor ||
+       search->priority.relationship != 2 || search->priority.path_length != 3 || search->priority != pr) {
+        std::cerr << "Compact announcement does not read back as it was inserted!" << std::endl;
+        return false;
+    }
+
+    // The second map reads the prefix from the shared table
+    map2.insert(map1.find(p));
+    if(map2.find(p) == map2.end() || map2.find(p)->prefix != p || map2.find(p)->origin != 64500 || table.at(42) != p) {
+        std::cerr << "Prefix table is not shared between maps!" << std::endl;
+        return false;
+    }
+
+    // Negative timestamps are kept too
+    Prefix<uint128_t> q(uint128_t(0x20010DB9) << 96, ~uint128_t(0) << 96, 8, 43);
+    map1.insert(q, Announcement<uint128_t>(64500, q, pr, 64501, -5, true));
+    if(map1.find(q) == map1.end() || map1.find(q)->tstamp != -5) {
+        std::cerr << "Negative timestamp does not read back as it was inserted!" << std::endl;
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,94 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include <sstream>
+#include <iostream>
+#include <limits>
+
+#include "Announcements/Announcement.h"
+#include "ResultSinks/ResultFormatter.h"
+
+/** Unit tests for ResultFormatter.h
+ */
+
+/** Tests that the formatter writes the same rows as Announcement::to_csv.
+ *
+ * @return true if successful, otherwise false.
+ */
+bool test_result_formatter() {
+    std::vector<Announcement<>> anns;
+    anns.push_back(Announcement<>(13796, Prefix<>("137.99.0.0", "255.255.0.0", 22, 0), 22742, 1583020800));
+    anns.push_back(Announcement<>(0, Prefix<>("0.0.0.0", "0.0.0.0", 0, 1), 0, 0));
+    anns.push_back(Announcement<>(4294967295, Prefix<>("255.255.255.255", "255.255.255.255", 4294967295, 2), 99, -1583020800));
+    anns.push_back(Announcement<>(1, Prefix<>("10.0.0.0", "255.0.0.0", 9, 3), 1, std::numeric_limits<int64_t>::min()));
+    anns.push_back(Announcement<>(1, Prefix<>("10.0.0.0", "255.0.0.0", 9, 4), 1, std::numeric_limits<int64_t>::max()));
+
+    ResultFormatter<> formatter;
+    std::ostringstream expected;
+    for (auto &ann : anns) {
+        formatter.add_result(ann.origin + 1, ann.prefix, ann.origin, ann.received_from_asn, ann.tstamp);
+        expected << ann.origin + 1 << ',';
+        ann.to_csv(expected);
+    }
+    if (std::string(formatter.data(), formatter.size()) != expected.str()) {
+        std::cerr << "Rows differ from to_csv:" << std::endl << std::string(formatter.data(), formatter.size());
+        return false;
+    }
+
+    // Another prefix in a cached slot is formatted again
+    formatter.clear();
+    Prefix<> moved("192.168.1.0", "255.255.255.0", 7, 0);
+    formatter.add_inverse(5, moved, 6);
+    if (std::string(formatter.data(), formatter.size()) != "5,192.168.1.0/24,6,7\n") {
+        std::cerr << "Stale cached prefix " << std::string(formatter.data(), formatter.size());
+        return false;
+    }
+    return true;
+}
+
+/** Tests IPv6 rows against Announcement::to_csv.
+ *
+ * @return true if successful, otherwise false.
+ */
+bool test_result_formatter_ipv6() {
+    std::vector<Announcement<uint128_t>> anns;
+    anns.push_back(Announcement<uint128_t>(13796, Prefix<uint128_t>("2001:db8::", "ffff:ffff::", 22, 0), 22742, 1583020800));
+    anns.push_back(Announcement<uint128_t>(7, Prefix<uint128_t>("::", "::", 0, 1), 8, -5));
+    anns.push_back(Announcement<uint128_t>(7, Prefix<uint128_t>("ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff", 
+                                                                 "ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff", 3, 2), 8, 9));
+
+    ResultFormatter<uint128_t> formatter;
+    std::ostringstream expected;
+    for (auto &ann : anns) {
+        formatter.add_result(42, ann.prefix, ann.origin, ann.received_from_asn, ann.tstamp);
+        expected << 42 << ',';
+        ann.to_csv(expected);
+        formatter.add_inverse(43, ann.prefix, ann.origin);
+        expected << 43 << ',' << ann.prefix.to_cidr() << ',' << ann.origin << ',' << ann.prefix.id << '\n';
+    }
+    if (std::string(formatter.data(), formatter.size()) != expected.str()) {
+        std::cerr << "IPv6 rows differ from to_csv:" << std::endl << std::string(formatter.data(), formatter.size());
+        return false;
+    }
+    return true;
+}
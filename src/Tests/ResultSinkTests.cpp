@@ -0,0 +1,96 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "ResultSinks/FileResultSink.h"
+
+/** Unit tests for FileResultSink.h
+ */
+
+/** Read a whole file, gunzipping it when compressed.
+ */
+static std::string read_result_file(std::string file_name) {
+    std::string contents;
+    gzFile file = gzopen(file_name.c_str(), "rb");
+    if (file == NULL) {
+        return contents;
+    }
+    char buffer[4096];
+    int n;
+    while ((n = gzread(file, buffer, sizeof(buffer))) > 0) {
+        contents.append(buffer, n);
+    }
+    gzclose(file);
+    return contents;
+}
+
+/** Tests writing results and inverse results shards as csv and as compressed binary.
+ *
+ * @return true if successful, otherwise false.
+ */
+bool test_file_result_sink() {
+    std::string dir = "/tmp/bgp-test-sink-" + std::to_string(getpid());
+    mkdir(dir.c_str(), 0777);
+    Prefix<> prefix("1.2.3.0", "255.255.255.0", 7, 0);
+    bool success = true;
+
+    // csv rows have the columns of the tables
+    FileResultSink<> csv_sink(dir, false, false);
+    ResultShard<> *shard = csv_sink.open_shard("results", false, 4, 1);
+    shard->add_result(3, prefix, 1, 2, 100);
+    shard->add_result(4, prefix, 1, 3, 100);
+    success &= shard->close();
+    delete shard;
+    shard = csv_sink.open_shard("inverse", true, 4, 1);
+    shard->add_inverse(5, prefix, 1);
+    success &= shard->close();
+    delete shard;
+    std::string results = read_result_file(dir + "/results_4_1.csv");
+    std::string inverse = read_result_file(dir + "/inverse_4_1.csv");
+    if (!success || results != "3,1.2.3.0/24,1,2,100,7\n4,1.2.3.0/24,1,3,100,7\n" || inverse != "5,1.2.3.0/24,1,7\n") {
+        std::cerr << "test_file_result_sink failed (csv): " << results << inverse << std::endl;
+        success = false;
+    }
+    std::remove((dir + "/results_4_1.csv").c_str());
+    std::remove((dir + "/inverse_4_1.csv").c_str());
+
+    // binary records are fixed width and little endian after the header
+    FileResultSink<> binary_sink(dir, true, true);
+    shard = binary_sink.open_shard("results", false, 4, 1);
+    shard->add_result(3, prefix, 1, 2, 100);
+    success &= shard->close();
+    delete shard;
+    std::string binary = read_result_file(dir + "/results_4_1.bin.gz");
+    std::string expected("BGPXRES1\x04\x00\x1D\x00\x00\x00\x00\x00"
+                         "\x03\x00\x00\x00" "\x01\x02\x03\x00" "\x18" "\x01\x00\x00\x00" "\x02\x00\x00\x00"
+                         "\x64\x00\x00\x00\x00\x00\x00\x00" "\x07\x00\x00\x00", 16 + 29);
+    if (!success || binary != expected || FileResultShard<uint128_t>::record_size(true) != 29) {
+        std::cerr << "test_file_result_sink failed (binary)" << std::endl;
+        success = false;
+    }
+    std::remove((dir + "/results_4_1.bin.gz").c_str());
+    rmdir(dir.c_str());
+    return success;
+}
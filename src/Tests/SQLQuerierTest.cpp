@@ -76,6 +76,88 @@ bool test_copy_to_db_string() {
     return true;
 }
 
+// Test for copy_from_stdin_query_string function
+bool test_copy_from_stdin_string() {
+    SQLQuerier<> *querier = new SQLQuerier<>("announcement_table", "results_table", "inverse_results_table", "depref_results_table", "full_path_results_table", -1, "test", "bgp-test.conf", false);
+
+    if (querier->copy_from_stdin_query_string("results", "(asn, prefix)", true) != 
+                                    "COPY results(asn, prefix) FROM STDIN WITH (FORMAT binary)") {
+        std::cerr << "test_copy_from_stdin_string failed (binary)" << std::endl;
+        return false;
+    }
+    if (querier->copy_from_stdin_query_string("results", "(asn, prefix)", false) != 
+                                    "COPY results(asn, prefix) FROM STDIN WITH (FORMAT csv)") {
+        std::cerr << "test_copy_from_stdin_string failed (csv)" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
+// Test that a copy of a querier keeps the settings but not the connections
+bool test_querier_copy() {
+    SQLQuerier<> querier("announcement_table", "results_table", "inverse_results_table", "depref_results_table", "full_path_results_table", 3356, "test", "bgp-test.conf", false);
+    querier.copy_from_stdin = true;
+    // Stands in for an open connection, never used
+    querier.C = reinterpret_cast<pqxx::connection*>(&querier);
+
+    SQLQuerier<> copy(querier);
+    querier.C = NULL;
+    if (copy.C != NULL || copy.copy_conn != NULL) {
+        std::cerr << "test_querier_copy failed (connection shared)" << std::endl;
+        return false;
+    }
+    if (copy.host != querier.host || copy.db_name != querier.db_name || copy.user != querier.user || 
+        copy.results_table != "results_table" || copy.full_path_results_table != "full_path_results_table" || 
+        copy.exclude_as_number != 3356 || !copy.copy_from_stdin) {
+        std::cerr << "test_querier_copy failed (settings)" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Test the binary COPY encoding of a CopyBuffer
+bool test_copy_buffer() {
+    CopyBuffer rows;
+    Prefix<> p("137.99.0.0", "255.255.0.0", 0);
+    rows.begin_row(2);
+    rows.add_bigint(13796);
+    rows.add_inet(p);
+    rows.end();
+
+    std::string expected("PGCOPY\n\377\r\n\0" "\0\0\0\0" "\0\0\0\0", 19);
+    // Field count, then a bigint and an inet field, each with its length
+    expected.append("\0\2", 2);
+    expected.append("\0\0\0\x08" "\0\0\0\0\0\0\x35\xe4", 12);
+    expected.append("\0\0\0\x08" "\2\x10\0\4" "\x89\x63\0\0", 12);
+    // Trailer
+    expected.append("\xff\xff", 2);
+    if (rows.data != expected || rows.rows != 1) {
+        std::cerr << "test_copy_buffer failed (IPv4)" << std::endl;
+        return false;
+    }
+
+    CopyBuffer rows6;
+    // 2001:db8::/32
+    Prefix<uint128_t> p6((uint128_t) 0x20010db8 << 96, (uint128_t) 0xffffffff << 96, 0);
+    rows6.begin_row(1);
+    rows6.add_inet(p6);
+    std::string inet6("\0\0\0\x14" "\3\x20\0\x10" "\x20\x01\x0d\xb8", 12);
+    inet6.append(12, '\0');
+    if (rows6.data.substr(21) != inet6) {
+        std::cerr << "test_copy_buffer failed (IPv6)" << std::endl;
+        return false;
+    }
+
+    CopyBuffer csv(false);
+    if (!csv.data.empty() || !csv.empty()) {
+        std::cerr << "test_copy_buffer failed (csv)" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
 // Test for select_prefix_string function
 bool test_select_prefix_string() {
     SQLQuerier<> *querier = new SQLQuerier<>("announcement_table", "results_table", "inverse_results_table", "depref_results_table", "full_path_results_table", -1, "test", "bgp-test.conf", false);
@@ -111,6 +193,26 @@ bool test_select_prefix_string() {
     return true;
 }
 
+// Test for prepared_select_query_string function
+bool test_prepared_select_query_string() {
+    SQLQuerier<> *querier = new SQLQuerier<>("announcement_table", "results_table", "inverse_results_table", "depref_results_table", "full_path_results_table", -1, "test", "bgp-test.conf", false);
+    SQLQuerier<> *excluding = new SQLQuerier<>("announcement_table", "results_table", "inverse_results_table", "depref_results_table", "full_path_results_table", 13796, "test", "bgp-test.conf", false);
+
+    if (querier->prepared_select_query_string("COUNT(*)", "prefix <<= $1") != 
+                                    "SELECT COUNT(*) FROM announcement_table WHERE prefix <<= $1") {
+        std::cerr << "test_prepared_select_query_string failed" << std::endl;
+        return false;
+    }
+
+    if (excluding->prepared_select_query_string("as_path, origin", "block_id = $1 AND family(prefix) = $2") != 
+                                    "SELECT as_path, origin FROM announcement_table WHERE block_id = $1 AND family(prefix) = $2 AND monitor_asn != 13796") {
+        std::cerr << "test_prepared_select_query_string failed (excluded monitor)" << std::endl;
+        return false;
+    }
+
+    return true;
+}
+
 // Test for clear_table_string
 bool test_clear_table_string() {
     SQLQuerier<> *querier = new SQLQuerier<>("announcement_table", "results_table", "inverse_results_table", "depref_results_table", "full_path_results_table", -1, "test", "bgp-test.conf", false);
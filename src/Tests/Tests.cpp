@@ -123,6 +123,21 @@ BOOST_AUTO_TEST_CASE( ASGraph_tarjan_test ) {
 BOOST_AUTO_TEST_CASE( ASGraph_combine_components_test ) {
         BOOST_CHECK( test_combine_components() );
 }
+BOOST_AUTO_TEST_CASE( ASGraph_index_ases ) {
+        BOOST_CHECK( test_index_ases() );
+}
+BOOST_AUTO_TEST_CASE( ASGraph_index_ases_bfs ) {
+        BOOST_CHECK( test_index_ases_bfs() );
+}
+BOOST_AUTO_TEST_CASE( ASGraph_topology_snapshot ) {
+        BOOST_CHECK( test_topology_snapshot() );
+}
+BOOST_AUTO_TEST_CASE( ASGraph_preprocess_deep_chain ) {
+        BOOST_CHECK( test_preprocess_deep_chain() );
+}
+BOOST_AUTO_TEST_CASE( ASGraph_rib_generations ) {
+        BOOST_CHECK( test_rib_generations() );
+}
 
 // Extrapolator.cpp
 BOOST_AUTO_TEST_CASE( Extrapolator_constructor ) {
@@ -140,6 +155,15 @@ BOOST_AUTO_TEST_CASE( Extrapolator_give_ann_to_as_path ) {
 BOOST_AUTO_TEST_CASE( Extrapolator_give_ann_to_as_path_origin_only ) {
         BOOST_CHECK( test_give_ann_to_as_path_origin_only() );
 }
+BOOST_AUTO_TEST_CASE( Extrapolator_seed_decoded_block ) {
+        BOOST_CHECK( test_seed_decoded_block() );
+}
+BOOST_AUTO_TEST_CASE( Extrapolator_prefix_slots ) {
+        BOOST_CHECK( test_prefix_slots() );
+}
+BOOST_AUTO_TEST_CASE( Extrapolator_save_results_at_asn_dir ) {
+        BOOST_CHECK( test_save_results_at_asn_dir() );
+}
 BOOST_AUTO_TEST_CASE( Extrapolator_propagate_up_no_multihomed ) {
         BOOST_CHECK( test_propagate_up_no_multihomed() );
 }
@@ -167,6 +191,15 @@ BOOST_AUTO_TEST_CASE( Extrapolator_propagate_down2 ) {
 BOOST_AUTO_TEST_CASE( Extrapolator_propagate_down_multihomed_standard ) {
         BOOST_CHECK( test_propagate_down_multihomed_standard() );
 }
+BOOST_AUTO_TEST_CASE( Extrapolator_propagate_parallel ) {
+        BOOST_CHECK( test_propagate_parallel() );
+}
+BOOST_AUTO_TEST_CASE( Extrapolator_propagate_pull ) {
+        BOOST_CHECK( test_propagate_pull() );
+}
+BOOST_AUTO_TEST_CASE( Extrapolator_block_workers ) {
+        BOOST_CHECK( test_block_workers() );
+}
 BOOST_AUTO_TEST_CASE( Extrapolator_save_results ) {
         BOOST_CHECK( test_save_results_parallel() );
         BOOST_CHECK( test_save_results_at_asn() );
@@ -216,6 +249,9 @@ BOOST_AUTO_TEST_CASE( Extrapolator_send_all_announcements_multihomed_peer_mode1
 BOOST_AUTO_TEST_CASE( Extrapolator_send_all_announcements_multihomed_peer_mode2 ) {
         BOOST_CHECK( test_send_all_announcements_multihomed_peer_mode2() );
 }
+BOOST_AUTO_TEST_CASE( Extrapolator_test_plan_blocks_from_counts ) {
+        BOOST_CHECK( test_plan_blocks_from_counts() );
+}
 BOOST_AUTO_TEST_CASE( Extrapolator_test_extrapolate_blocks ) {
         BOOST_CHECK( test_extrapolation_buildup() );
         BOOST_CHECK( test_extrapolate_blocks() );
@@ -386,22 +422,95 @@ BOOST_AUTO_TEST_CASE( EZBGPsec_test_path_propagation ) {
 BOOST_AUTO_TEST_CASE( PrefixAnnouncementMap_test_insert ) {
         BOOST_CHECK( prefixAnnouncementMap_test_insert() );
 }
+BOOST_AUTO_TEST_CASE( PrefixAnnouncementMap_test_iteration ) {
+        BOOST_CHECK( prefixAnnouncementMap_test_iteration() );
+}
+BOOST_AUTO_TEST_CASE( PrefixAnnouncementMap_test_clear ) {
+        BOOST_CHECK( prefixAnnouncementMap_test_clear() );
+}
+BOOST_AUTO_TEST_CASE( PrefixAnnouncementMap_test_compact ) {
+        BOOST_CHECK( prefixAnnouncementMap_test_compact() );
+}
+
+//PathDecoder Tests
+BOOST_AUTO_TEST_CASE( PathDecoder_test_decode_path ) {
+        BOOST_CHECK( test_decode_path() );
+        BOOST_CHECK( test_decode_path_loops() );
+}
+BOOST_AUTO_TEST_CASE( PathDecoder_test_decode_fields ) {
+        BOOST_CHECK( test_decode_fields() );
+}
+
+//FileInputSource Tests
+BOOST_AUTO_TEST_CASE( FileInputSource_test_parse ) {
+        BOOST_CHECK( test_parse_relationship() );
+        BOOST_CHECK( test_parse_announcement() );
+}
+BOOST_AUTO_TEST_CASE( FileInputSource_test_read_announcements ) {
+        BOOST_CHECK( test_read_announcements() );
+}
+BOOST_AUTO_TEST_CASE( FileInputSource_test_extrapolate_input ) {
+        BOOST_CHECK( test_extrapolate_input() );
+}
+
+//AnnouncementStore Tests
+BOOST_AUTO_TEST_CASE( AnnouncementStore_test_store ) {
+        BOOST_CHECK( test_announcement_store() );
+}
+BOOST_AUTO_TEST_CASE( AnnouncementStore_test_extrapolate_store ) {
+        BOOST_CHECK( test_extrapolate_store() );
+}
+
+//ResultSink Tests
+BOOST_AUTO_TEST_CASE( ResultSink_test_file_result_sink ) {
+        BOOST_CHECK( test_file_result_sink() );
+}
+
+//ResultFormatter Tests
+BOOST_AUTO_TEST_CASE( ResultFormatter_test_rows ) {
+        BOOST_CHECK( test_result_formatter() );
+}
+BOOST_AUTO_TEST_CASE( ResultFormatter_test_rows_ipv6 ) {
+        BOOST_CHECK( test_result_formatter_ipv6() );
+}
+
+//InverseResults Tests
+BOOST_AUTO_TEST_CASE( InverseResults_test_bitsets ) {
+        BOOST_CHECK( test_inverse_results() );
+}
+BOOST_AUTO_TEST_CASE( InverseResults_test_compute ) {
+        BOOST_CHECK( test_compute_inverse_results() );
+}
+
+//WriterPool Tests
+BOOST_AUTO_TEST_CASE( WriterPool_test_balance ) {
+        BOOST_CHECK( test_writer_pool_balance() );
+}
+BOOST_AUTO_TEST_CASE( WriterPool_test_run ) {
+        BOOST_CHECK( test_writer_pool_run() );
+}
 
 //SQLQuerier Tests
 BOOST_AUTO_TEST_CASE( SQLQuerier_test_parse_config ) {
         BOOST_CHECK ( test_querier_buildup() );
         BOOST_CHECK ( test_parse_config() );
+        BOOST_CHECK ( test_querier_copy() );
         BOOST_CHECK ( test_querier_teardown() );
 }
 BOOST_AUTO_TEST_CASE( SQLQuerier_test_string_methods ) {
         BOOST_CHECK ( test_querier_buildup() );
         BOOST_CHECK ( test_select_prefix_string() );
+        BOOST_CHECK ( test_prepared_select_query_string() );
         BOOST_CHECK ( test_copy_to_db_string() );
+        BOOST_CHECK ( test_copy_from_stdin_string() );
         BOOST_CHECK ( test_clear_table_string() );
         BOOST_CHECK ( test_create_table_string() );
         BOOST_CHECK ( test_create_table_string() );
         BOOST_CHECK ( test_querier_teardown() );
 }
+BOOST_AUTO_TEST_CASE( SQLQuerier_test_copy_buffer ) {
+        BOOST_CHECK ( test_copy_buffer() );
+}
 
 #endif // RUN_TESTS
 
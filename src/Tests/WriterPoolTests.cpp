@@ -0,0 +1,82 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include <atomic>
+#include <iostream>
+
+#include "WriterPool.h"
+
+/** Unit tests for WriterPool.h
+ */
+
+/** Tests that ranges are contiguous and split by weight rather than by count.
+ *
+ * @return true if successful, otherwise false.
+ */
+bool test_writer_pool_balance() {
+    // One heavy item takes a range of its own
+    std::vector<size_t> bounds = WriterPool::balance({1, 1, 1, 1, 12, 1, 1, 1, 1}, 3);
+    if (bounds != std::vector<size_t>({0, 4, 5, 9})) {
+        std::cerr << "Unbalanced ranges " << bounds[1] << ", " << bounds[2] << std::endl;
+        return false;
+    }
+    bounds = WriterPool::balance(std::vector<size_t>(9, 1), 3);
+    if (bounds != std::vector<size_t>({0, 3, 6, 9})) {
+        std::cerr << "Uneven ranges of equal weights" << std::endl;
+        return false;
+    }
+    // More ranges than items leaves some empty
+    bounds = WriterPool::balance({5}, 3);
+    if (bounds.size() != 4 || bounds.front() != 0 || bounds.back() != 1) {
+        std::cerr << "Ranges do not cover the items" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/** Tests that every job runs once on each thread and run waits for all of them.
+ *
+ * @return true if successful, otherwise false.
+ */
+bool test_writer_pool_run() {
+    WriterPool pool(4);
+    std::vector<std::atomic<int>> runs(pool.size());
+    for (auto &count : runs) {
+        count = 0;
+    }
+    for (int job = 1; job <= 100; job++) {
+        pool.run([&runs](int thread_num) { runs.at(thread_num)++; });
+        for (auto &count : runs) {
+            if (count != job) {
+                std::cerr << "Job " << job << " did not run once on every thread" << std::endl;
+                return false;
+            }
+        }
+    }
+
+    // A pool of one thread runs jobs on the caller
+    WriterPool single(0);
+    std::thread::id caller;
+    single.run([&caller](int) { caller = std::this_thread::get_id(); });
+    return single.size() == 1 && caller == std::this_thread::get_id();
+}
@@ -0,0 +1,106 @@
+/*************************************************************************
+ * This file is part of the BGP Extrapolator.
+ *
+ * Developed for the SIDR ROV Forecast.
+ * This package includes software developed by the SIDR Project
+ * (https://sidr.engr.uconn.edu/).
+ * See the COPYRIGHT file at the top-level directory of this distribution
+ * for details of code ownership.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ ************************************************************************/
+
+#include "WriterPool.h"
+
+WriterPool::WriterPool(int num_threads) : job(NULL), round(0), unfinished(0), stopping(false) {
+    this->num_threads = num_threads > 1 ? num_threads : 1;
+    for (int i = 1; i < this->num_threads; i++) {
+        threads.push_back(std::thread(&WriterPool::work, this, i));
+    }
+}
+
+WriterPool::~WriterPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    job_ready.notify_all();
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
+
+void WriterPool::run(const std::function<void(int)> &job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        this->job = &job;
+        unfinished = (int) threads.size();
+        round++;
+    }
+    job_ready.notify_all();
+
+    job(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    job_done.wait(lock, [this]() { return unfinished == 0; });
+    this->job = NULL;
+}
+
+void WriterPool::work(int thread_num) {
+    uint64_t done = 0;
+    while (true) {
+        const std::function<void(int)> *current;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            job_ready.wait(lock, [this, done]() { return stopping || round != done; });
+            if (stopping) {
+                return;
+            }
+            done = round;
+            current = job;
+        }
+
+        (*current)(thread_num);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--unfinished == 0) {
+            job_done.notify_all();
+        }
+    }
+}
+
+std::vector<size_t> WriterPool::balance(const std::vector<size_t> &weights, int parts) {
+    parts = parts > 1 ? parts : 1;
+    uint64_t total = 0;
+    for (size_t weight : weights) {
+        total += weight;
+    }
+
+    // Each range ends where the running total is nearest its share, compared times parts
+    std::vector<size_t> bounds(1, 0);
+    uint64_t sum = 0;
+    size_t i = 0;
+    for (int part = 1; part < parts; part++) {
+        uint64_t target = total * part;
+        while (i < weights.size() && (sum + weights[i]) * parts <= target) {
+            sum += weights[i++];
+        }
+        if (i < weights.size() && (sum + weights[i]) * parts - target < target - sum * parts) {
+            sum += weights[i++];
+        }
+        bounds.push_back(i);
+    }
+    bounds.push_back(weights.size());
+    return bounds;
+}